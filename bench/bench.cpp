@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include <thread>
+
+namespace bench {
+
+namespace {
+
+void writeString(std::ostream& out, std::string_view s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void writeNumber(std::ostream& out, double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    out << text;
+}
+
+} // namespace
+
+void Runner::summarize(std::vector<double>& samples, Result& result) {
+    std::sort(samples.begin(), samples.end());
+    result.Min = samples.front();
+    result.Max = samples.back();
+    result.Median = samples[samples.size() / 2];
+}
+
+void Runner::add(Result result) {
+    std::fprintf(stderr, "%-20s %-8s %12.4f %s", result.Name.c_str(), result.Variant.c_str(), result.Median, result.Unit.c_str());
+    for (const auto& [key, value] : result.Fields) {
+        if (key == "bodies" || key == "threads")
+            std::fprintf(stderr, "  %s=%g", key.c_str(), value);
+    }
+    std::fprintf(stderr, "\n");
+    Results.push_back(std::move(result));
+}
+
+void Runner::writeJson(std::ostream& out) const {
+    out << "{\n  \"schema\": 1,\n  \"build\": {";
+#if defined(__clang__)
+    out << "\"compiler\": \"clang " << __clang_major__ << '.' << __clang_minor__ << '"';
+#elif defined(__GNUC__)
+    out << "\"compiler\": \"gcc " << __GNUC__ << '.' << __GNUC_MINOR__ << '"';
+#elif defined(_MSC_VER)
+    out << "\"compiler\": \"msvc " << _MSC_VER << '"';
+#else
+    out << "\"compiler\": \"unknown\"";
+#endif
+#if defined(__AVX2__)
+    out << ", \"avx2\": true";
+#else
+    out << ", \"avx2\": false";
+#endif
+    // The kernels dispatched at run time, which may go past the build flags above
+    out << ", \"simd\": \"" << nyx::getSimdLevelName(nyx::getSimdLevel()) << '"';
+#if defined(USE_DOUBLE_PRECISION)
+    out << ", \"double_precision\": true";
+#else
+    out << ", \"double_precision\": false";
+#endif
+#if defined(NYX_PROFILE)
+    out << ", \"profile\": true";
+#else
+    out << ", \"profile\": false";
+#endif
+    out << "},\n  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [";
+
+    const char* separator = "\n";
+    for (const Result& result : Results) {
+        out << separator << "    {\"name\": ";
+        writeString(out, result.Name);
+        out << ", \"variant\": ";
+        writeString(out, result.Variant);
+        out << ", \"unit\": ";
+        writeString(out, result.Unit);
+        out << ", \"iterations\": " << result.Iterations << ", \"median\": ";
+        writeNumber(out, result.Median);
+        out << ", \"min\": ";
+        writeNumber(out, result.Min);
+        out << ", \"max\": ";
+        writeNumber(out, result.Max);
+        for (const auto& [key, value] : result.Fields) {
+            out << ", ";
+            writeString(out, key);
+            out << ": ";
+            writeNumber(out, value);
+        }
+        out << '}';
+        separator = ",\n";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace bench
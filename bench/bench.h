@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Kept free of nyx headers: the SSE4 math benchmarks include this before
+// renaming the nyx namespace, see math_sse4.cpp
+namespace bench {
+
+// Makes the optimizer treat value as used, so the work producing it stays
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string Name;    // e.g. "vec3/dot" or "world/pile"
+    std::string Variant; // "naive", "sse4" or the SIMD level the world ran at
+    std::string Unit;    // of Median, Min and Max
+    uint64_t Iterations = 0; // per sample
+    double Median = 0.0;
+    double Min = 0.0;
+    double Max = 0.0;
+    std::vector<std::pair<std::string, double>> Fields; // benchmark specific numbers
+};
+
+struct Settings {
+    std::string Filter;           // run only benchmarks whose name contains it
+    uint32_t Repetitions = 15;    // samples per micro benchmark, the median is reported
+    double MinSampleSeconds = 0.01;
+    size_t MaxBodies = 1'000'000; // largest world stepped
+    std::vector<uint32_t> Threads; // thread counts worlds are stepped with, empty for 1 and all
+    bool Quick = false;           // fewer steps and samples, for smoke testing
+    std::vector<std::string> Replays; // InputRecorder captures stepped as "world/replay"
+};
+
+class Runner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Runner(const Settings& settings) : Config(settings) {}
+
+    bool isEnabled(std::string_view name) const { return Config.Filter.empty() || name.find(Config.Filter) != std::string_view::npos; }
+    const Settings& getSettings() const { return Config; }
+
+    // fn(iterations) runs a kernel doing opsPerIteration operations per
+    // iteration. Iterations grow until a sample takes MinSampleSeconds, then
+    // Repetitions samples give nanoseconds per operation.
+    template <typename Fn>
+    void measure(std::string name, std::string variant, uint64_t opsPerIteration, Fn&& fn) {
+        if (!isEnabled(name))
+            return;
+
+        uint64_t iterations = 1;
+        for (;;) {
+            const double seconds = time(fn, iterations);
+            if (seconds >= Config.MinSampleSeconds || iterations >= (uint64_t(1) << 40))
+                break;
+            iterations *= seconds > 0.0 ? std::min<uint64_t>(100, uint64_t(Config.MinSampleSeconds * 1.5 / seconds) + 1) : 100;
+        }
+
+        std::vector<double> samples(Config.Quick ? 3 : Config.Repetitions);
+        for (double& sample : samples)
+            sample = time(fn, iterations) * 1e9 / static_cast<double>(iterations * opsPerIteration);
+
+        Result result;
+        result.Name = std::move(name);
+        result.Variant = std::move(variant);
+        result.Unit = "ns/op";
+        result.Iterations = iterations * opsPerIteration;
+        summarize(samples, result);
+        add(std::move(result));
+    }
+
+    // Median, minimum and maximum of samples, which gets reordered
+    static void summarize(std::vector<double>& samples, Result& result);
+
+    void add(Result result);
+    void writeJson(std::ostream& out) const;
+
+private:
+    template <typename Fn>
+    static double time(Fn& fn, uint64_t iterations) {
+        const Clock::time_point start = Clock::now();
+        fn(iterations);
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    Settings Config;
+    std::vector<Result> Results;
+};
+
+void runMathNaive(Runner& runner);
+void runMathSse4(Runner& runner);
+void runWorld(Runner& runner);
+void runReplays(Runner& runner);
+
+} // namespace bench
@@ -0,0 +1,87 @@
+// nyx_bench: math micro benchmarks and PhysicsWorld stepping, written as JSON
+//
+//   nyx_bench [--filter <text>] [--out <file>] [--max-bodies <n>]
+//             [--threads <n,n,...>] [--repetitions <n>] [--quick]
+//             [--replay <recording>]... [--simd scalar|sse4|avx2|avx512]
+//
+// Progress goes to stderr, the JSON to stdout unless --out names a file.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "bench.h"
+#include "nyx/core/cpu_features.h"
+
+namespace {
+
+bool parse(int argc, char** argv, bench::Settings& settings, std::string& out) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--quick") == 0) {
+            settings.Quick = true;
+            continue;
+        }
+        if (!value)
+            return false;
+        ++i;
+
+        if (std::strcmp(arg, "--filter") == 0) {
+            settings.Filter = value;
+        } else if (std::strcmp(arg, "--out") == 0) {
+            out = value;
+        } else if (std::strcmp(arg, "--max-bodies") == 0) {
+            settings.MaxBodies = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--replay") == 0) {
+            settings.Replays.push_back(value);
+        } else if (std::strcmp(arg, "--repetitions") == 0) {
+            settings.Repetitions = std::max(1u, static_cast<uint32_t>(std::strtoul(value, nullptr, 10)));
+        } else if (std::strcmp(arg, "--simd") == 0) {
+            // Capped at what the CPU runs; the JSON records the level used
+            nyx::SimdLevel level;
+            if (!nyx::parseSimdLevel(value, level))
+                return false;
+            nyx::setSimdLevel(level);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            for (char* p = const_cast<char*>(value); *p;) {
+                settings.Threads.push_back(static_cast<uint32_t>(std::strtoul(p, &p, 10)));
+                if (*p == ',')
+                    ++p;
+                else if (*p)
+                    return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Settings settings;
+    std::string out;
+    if (!parse(argc, argv, settings, out)) {
+        std::fprintf(stderr, "usage: %s [--filter <text>] [--out <file>] [--max-bodies <n>] [--threads <n,n,...>] [--repetitions <n>] [--quick] [--replay <recording>]... [--simd scalar|sse4|avx2|avx512]\n", argv[0]);
+        return 2;
+    }
+
+    bench::Runner runner(settings);
+    bench::runMathNaive(runner);
+    bench::runMathSse4(runner);
+    bench::runWorld(runner);
+    bench::runReplays(runner);
+
+    if (out.empty()) {
+        runner.writeJson(std::cout);
+        return 0;
+    }
+    std::ofstream file(out);
+    runner.writeJson(file);
+    return file ? 0 : 1;
+}
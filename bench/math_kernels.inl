@@ -0,0 +1,214 @@
+// Math micro benchmarks, included by math_naive.cpp and math_sse4.cpp, which
+// pick the Vec2/Vec3 implementation and name the entry point through
+// NYX_BENCH_MATH_ENTRY and NYX_BENCH_MATH_VARIANT.
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/math/mat3.h"
+#include "nyx/math/quaternion.h"
+#include "nyx/math/sym_mat3.h"
+#include "nyx/math/vec2.h"
+#include "nyx/math/vec3.h"
+
+#include "bench.h"
+
+namespace {
+
+using nyx::Mat3;
+using nyx::SymMat3;
+using nyx::Vec2;
+using nyx::Vec3;
+using nyx::real_t;
+
+// Operands per kernel call, small enough to stay in L1
+constexpr uint32_t kCount = 1024;
+
+// The naive and SSE4 types spell some operations differently
+#if defined(NYX_USE_SSE4)
+inline real_t dotOf(const Vec3& a, const Vec3& b) { return a.dot(b); }
+inline Vec3 crossOf(const Vec3& a, const Vec3& b) { return a.cross(b); }
+inline Vec3 unitOf(const Vec3& v) { return v.normalize(); }
+inline real_t dotOf(const Vec2& a, const Vec2& b) { return a.dot(b); }
+inline Vec2 unitOf(const Vec2& v) { return v.normalize(); }
+#else
+inline real_t dotOf(const Vec3& a, const Vec3& b) { return nyx::dot(a, b); }
+inline Vec3 crossOf(const Vec3& a, const Vec3& b) { return nyx::cross(a, b); }
+inline Vec3 unitOf(Vec3 v) { return v.normalize(); }
+inline real_t dotOf(const Vec2& a, const Vec2& b) { return nyx::dot(a, b); }
+inline Vec2 unitOf(const Vec2& v) { return v.normalized(); }
+#endif
+
+// Same operands on every run, so results compare across builds
+struct Random {
+    uint32_t State = 0x12345678u;
+    real_t next() {
+        State = State * 1664525u + 1013904223u;
+        return static_cast<real_t>(State >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+};
+
+struct Operands {
+    Operands() {
+        Random random;
+        for (uint32_t i = 0; i < kCount; ++i) {
+            A3.emplace_back(random.next(), random.next(), random.next());
+            B3.emplace_back(random.next(), random.next(), random.next());
+            A2.emplace_back(random.next(), random.next());
+            B2.emplace_back(random.next(), random.next());
+            M.emplace_back(2.0f + random.next(), random.next() * 0.5f, random.next() * 0.5f,
+                           random.next() * 0.5f, 2.0f + random.next(), random.next() * 0.5f,
+                           random.next() * 0.5f, random.next() * 0.5f, 2.0f + random.next());
+        }
+        Out3.resize(kCount);
+        Out2.resize(kCount);
+    }
+
+    std::vector<Vec3> A3, B3, Out3;
+    std::vector<Vec2> A2, B2, Out2;
+    std::vector<Mat3> M;
+};
+
+} // namespace
+
+namespace bench {
+
+void NYX_BENCH_MATH_ENTRY(Runner& runner) {
+    const char* variant = NYX_BENCH_MATH_VARIANT;
+    Operands o;
+
+    // Element-wise kernels write every result, reductions sum them
+    auto map3 = [&](auto op) {
+        return [&o, op](uint64_t iterations) {
+            for (uint64_t n = 0; n < iterations; ++n) {
+                for (uint32_t i = 0; i < kCount; ++i)
+                    o.Out3[i] = op(o.A3[i], o.B3[i], i);
+                doNotOptimize(o.Out3.data());
+            }
+        };
+    };
+    auto map2 = [&](auto op) {
+        return [&o, op](uint64_t iterations) {
+            for (uint64_t n = 0; n < iterations; ++n) {
+                for (uint32_t i = 0; i < kCount; ++i)
+                    o.Out2[i] = op(o.A2[i], o.B2[i]);
+                doNotOptimize(o.Out2.data());
+            }
+        };
+    };
+    auto reduce = [&](auto op) {
+        return [&o, op](uint64_t iterations) {
+            for (uint64_t n = 0; n < iterations; ++n) {
+                real_t sum = 0.0f;
+                for (uint32_t i = 0; i < kCount; ++i)
+                    sum += op(i);
+                doNotOptimize(sum);
+            }
+        };
+    };
+
+    runner.measure("vec3/add", variant, kCount, map3([](const Vec3& a, const Vec3& b, uint32_t) { return a + b; }));
+    runner.measure("vec3/mul_add", variant, kCount, map3([](const Vec3& a, const Vec3& b, uint32_t) { return a + b * 0.5f; }));
+    runner.measure("vec3/cross", variant, kCount, map3([](const Vec3& a, const Vec3& b, uint32_t) { return crossOf(a, b); }));
+    runner.measure("vec3/normalize", variant, kCount, map3([](const Vec3& a, const Vec3&, uint32_t) { return unitOf(a); }));
+    runner.measure("vec3/dot", variant, kCount, reduce([&o](uint32_t i) { return dotOf(o.A3[i], o.B3[i]); }));
+    runner.measure("vec3/length", variant, kCount, reduce([&o](uint32_t i) { return o.A3[i].length(); }));
+
+    runner.measure("vec2/add", variant, kCount, map2([](const Vec2& a, const Vec2& b) { return a + b; }));
+    runner.measure("vec2/normalize", variant, kCount, map2([](const Vec2& a, const Vec2&) { return unitOf(a); }));
+    runner.measure("vec2/dot", variant, kCount, reduce([&o](uint32_t i) { return dotOf(o.A2[i], o.B2[i]); }));
+    runner.measure("vec2/length", variant, kCount, reduce([&o](uint32_t i) { return o.A2[i].length(); }));
+
+    runner.measure("mat3/mul_vec3", variant, kCount, map3([&o](const Vec3& a, const Vec3&, uint32_t i) { return o.M[i] * a; }));
+    runner.measure("mat3/inverse", variant, kCount, reduce([&o](uint32_t i) { return o.M[i].inverse().m[1][1]; }));
+
+    std::vector<nyx::Quaternion> q;
+    Random random;
+    for (uint32_t i = 0; i < kCount; ++i) {
+        q.emplace_back(random.next(), random.next(), random.next(), random.next());
+        q.back().normalize();
+    }
+    std::vector<nyx::Quaternion> qOut(kCount);
+
+    runner.measure("quat/mul", variant, kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            for (uint32_t i = 0; i < kCount; ++i)
+                qOut[i] = q[i] * q[kCount - 1 - i];
+            doNotOptimize(qOut.data());
+        }
+    });
+    runner.measure("quat/normalize", variant, kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            for (uint32_t i = 0; i < kCount; ++i) {
+                qOut[i] = q[i] * 1.5f;
+                qOut[i].normalize();
+            }
+            doNotOptimize(qOut.data());
+        }
+    });
+    runner.measure("quat/rotate", variant, kCount, map3([&q](const Vec3& a, const Vec3&, uint32_t i) { return q[i] * a; }));
+
+    // One step of a spinning body, as RigidbodySystem::integrate takes it
+    std::vector<Vec3> omega(kCount);
+    for (uint32_t i = 0; i < kCount; ++i)
+        omega[i] = o.B3[i] * 10.0f;
+    runner.measure("quat/integrate", variant, kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            for (uint32_t i = 0; i < kCount; ++i) {
+                nyx::Quaternion w(0.0f, omega[i].X, omega[i].Y, omega[i].Z);
+                qOut[i] += 0.5f * w * qOut[i] * (1.0f / 60.0f);
+                qOut[i].normalize();
+            }
+            doNotOptimize(qOut.data());
+        }
+    });
+
+    // Inverse inertias taken to world space, as integrateVelocities does per awake body
+    std::vector<SymMat3> s;
+    for (uint32_t i = 0; i < kCount; ++i)
+        s.push_back(SymMat3(o.M[i].m[0][0], o.M[i].m[1][1], o.M[i].m[2][2], o.M[i].m[0][1], o.M[i].m[0][2], o.M[i].m[1][2]));
+    std::vector<SymMat3> sOut(kCount);
+    runner.measure("symmat3/mul_vec3", variant, kCount, map3([&s](const Vec3& a, const Vec3&, uint32_t i) { return s[i] * a; }));
+    runner.measure("symmat3/rotate", variant, kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            for (uint32_t i = 0; i < kCount; ++i)
+                sOut[i] = nyx::rotateTensor(q[i], s[i]);
+            doNotOptimize(sOut.data());
+        }
+    });
+
+#if !defined(NYX_USE_SSE4)
+    // The array kernels, at the level the CPU or --simd picked
+    runner.measure("quat/rotate_many", "batch", kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            nyx::rotateMany(q.data(), o.A3.data(), o.Out3.data(), kCount);
+            doNotOptimize(o.Out3.data());
+        }
+    });
+    runner.measure("quat/integrate_many", "batch", kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            nyx::integrateMany(qOut.data(), omega.data(), 1.0f / 60.0f, kCount);
+            doNotOptimize(qOut.data());
+        }
+    });
+    runner.measure("quat/normalize_many", "batch", kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            for (uint32_t i = 0; i < kCount; ++i)
+                qOut[i] = q[i] * 1.5f;
+            nyx::normalizeMany(qOut.data(), kCount);
+            doNotOptimize(qOut.data());
+        }
+    });
+    std::vector<uint32_t> indices(kCount);
+    for (uint32_t i = 0; i < kCount; ++i)
+        indices[i] = i;
+    runner.measure("symmat3/rotate_tensors", "batch", kCount, [&](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+            nyx::rotateTensors(q.data(), s.data(), sOut.data(), indices.data(), kCount);
+            doNotOptimize(sOut.data());
+        }
+    });
+#endif
+}
+
+} // namespace bench
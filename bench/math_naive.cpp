@@ -0,0 +1,4 @@
+#define NYX_BENCH_MATH_ENTRY runMathNaive
+#define NYX_BENCH_MATH_VARIANT "naive"
+
+#include "math_kernels.inl"
@@ -0,0 +1,17 @@
+// The SSE4 types share their names with the naive ones the rest of the
+// benchmark links against. Renaming the namespace in this translation unit
+// keeps the two definitions of nyx::Vec3 and friends from colliding.
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <smmintrin.h>
+
+#include "bench.h"
+
+#define NYX_USE_SSE4
+#define nyx nyx_sse4
+
+#define NYX_BENCH_MATH_ENTRY runMathSse4
+#define NYX_BENCH_MATH_VARIANT "sse4"
+
+#include "math_kernels.inl"
@@ -0,0 +1,272 @@
+// PhysicsWorld stepped at increasing body counts and thread counts, many
+// small worlds stepped as ParallelWorlds, and recorded sessions replayed
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nyx/core/cpu_features.h"
+#include "nyx/physics/scene/parallel_worlds.h"
+#include "nyx/physics/scene/physics_world.h"
+
+#include "bench.h"
+
+namespace bench {
+
+namespace {
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+
+enum class Scene {
+    Integrate, // no shapes and no broadphase, only the rigidbody stages
+    Pile,      // spheres and boxes falling onto the ground, every stage
+};
+
+struct Random {
+    uint32_t State = 0x9e3779b9u;
+    real_t next() { // [0, 1)
+        State = State * 1664525u + 1013904223u;
+        return static_cast<real_t>(State >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+void fill(PhysicsWorld& world, Scene scene, size_t count) {
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    world.reserve(count + 1);
+
+    Random random;
+    const Mat3 inertia(0.1f, 0.0f, 0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 0.1f);
+    // Square layers of one body per 1.5 m, as many as it takes
+    const size_t side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(count) / 4.0)));
+    const real_t extent = static_cast<real_t>(side) * 1.5f;
+
+    if (scene == Scene::Pile) {
+        world.setBroadphase(BroadphaseType::SweepAndPrune);
+        const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, inertia);
+        world.setBoxShape(ground, Vec3(extent, 0.5f, extent));
+        world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+    } else {
+        world.setBroadphase(BroadphaseType::None);
+    }
+
+    std::vector<RigidbodyDesc> bodies(count);
+    for (size_t i = 0; i < count; ++i) {
+        RigidbodyDesc& body = bodies[i];
+        const size_t layer = i / (side * side);
+        const size_t cell = i % (side * side);
+        body.Position = Vec3(static_cast<real_t>(cell % side) * 1.5f - extent * 0.5f, 0.6f + static_cast<real_t>(layer) * 1.5f,
+                             static_cast<real_t>(cell / side) * 1.5f - extent * 0.5f);
+        body.Velocity = Vec3(random.next() - 0.5f, random.next() - 0.5f, random.next() - 0.5f);
+        body.Inertia = inertia;
+    }
+
+    std::vector<RigidbodyHandle> handles(count);
+    world.addRigidbodies(bodies, handles.data());
+    RigidbodyData& data = world.accessRigidbodyData();
+    for (size_t i = 0; i < count; ++i)
+        data.accessAngularVelocities()[world.getIndex(handles[i])] = Vec3(random.next(), random.next(), random.next());
+
+    if (scene == Scene::Pile) {
+        for (size_t i = 0; i < count; ++i) {
+            if (i % 2)
+                world.setSphereShape(handles[i], 0.5f);
+            else
+                world.setBoxShape(handles[i], Vec3(0.4f, 0.4f, 0.4f));
+        }
+    }
+}
+
+// Fewer steps for bigger worlds, fixed per size so runs stay comparable
+uint32_t stepsFor(size_t bodies, bool quick) {
+    const uint32_t steps = bodies <= 1'000 ? 200 : bodies <= 10'000 ? 100 : bodies <= 100'000 ? 20 : 5;
+    return quick ? std::max(2u, steps / 10) : steps;
+}
+
+void step(Runner& runner, Scene scene, size_t bodies, uint32_t threads) {
+    const std::string name = scene == Scene::Pile ? "world/pile" : "world/integrate";
+    if (!runner.isEnabled(name))
+        return;
+
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = threads - 1});
+    fill(world, scene, bodies);
+
+    const bool quick = runner.getSettings().Quick;
+    const uint32_t steps = stepsFor(bodies, quick);
+    for (uint32_t i = 0; i < (quick ? 2u : 10u); ++i)
+        world.update(kDt);
+
+    std::vector<double> samples(steps);
+    double stages[kPhysicsStageCount] = {};
+    for (double& sample : samples) {
+        const Runner::Clock::time_point start = Runner::Clock::now();
+        world.update(kDt);
+        sample = std::chrono::duration<double, std::milli>(Runner::Clock::now() - start).count();
+
+        const PhysicsStats& stats = world.getStats();
+        for (uint32_t s = 0; s < kPhysicsStageCount; ++s)
+            stages[s] += stats.Stages[s].getMilliseconds() / steps;
+    }
+
+    Result result;
+    result.Name = name;
+    result.Variant = getSimdLevelName(getSimdLevel());
+    result.Unit = "ms/step";
+    result.Iterations = steps;
+    Runner::summarize(samples, result);
+
+    const PhysicsStats& stats = world.getStats();
+    result.Fields = {
+        {"bodies", static_cast<double>(bodies)},
+        {"threads", static_cast<double>(threads)},
+        {"bodies_per_second", static_cast<double>(bodies) * 1e3 / result.Median},
+        {"awake_bodies", static_cast<double>(stats.AwakeBodies)},
+        {"pairs", static_cast<double>(stats.Pairs)},
+        {"contacts", static_cast<double>(stats.Contacts)},
+    };
+#if defined(NYX_PROFILE)
+    for (uint32_t s = 0; s < kPhysicsStageCount; ++s)
+        result.Fields.emplace_back(std::string("ms_") + getStageName(static_cast<PhysicsStage>(s)), stages[s]);
+#endif
+    runner.add(std::move(result));
+}
+
+// Many small piles, once as ParallelWorlds spread over the threads and once as
+// separate default worlds stepped one after another on the calling thread
+void parallel(Runner& runner, size_t worlds, size_t bodiesPerWorld, uint32_t threads) {
+    const bool quick = runner.getSettings().Quick;
+    const uint32_t steps = quick ? 5 : 50;
+    ParallelWorlds parallelWorlds(JobSystemSettings{.WorkerCount = threads - 1});
+    std::vector<std::unique_ptr<PhysicsWorld>> separate;
+    for (size_t w = 0; w < worlds; ++w) {
+        fill(parallelWorlds.accessWorld(parallelWorlds.addWorld(bodiesPerWorld + 1)), Scene::Pile, bodiesPerWorld);
+        if (threads == 1) {
+            separate.push_back(std::make_unique<PhysicsWorld>());
+            fill(*separate.back(), Scene::Pile, bodiesPerWorld);
+        }
+    }
+
+    auto measure = [&](const char* variant, auto&& stepAll) {
+        for (uint32_t i = 0; i < (quick ? 1u : 5u); ++i)
+            stepAll();
+        std::vector<double> samples(steps);
+        for (double& sample : samples) {
+            const Runner::Clock::time_point start = Runner::Clock::now();
+            stepAll();
+            sample = std::chrono::duration<double, std::milli>(Runner::Clock::now() - start).count();
+        }
+        Result result;
+        result.Name = "world/parallel";
+        result.Variant = variant;
+        result.Unit = "ms/step";
+        result.Iterations = steps;
+        Runner::summarize(samples, result);
+        result.Fields = {
+            {"worlds", static_cast<double>(worlds)},
+            {"bodies_per_world", static_cast<double>(bodiesPerWorld)},
+            {"threads", static_cast<double>(threads)},
+            {"bodies_per_second", static_cast<double>(worlds * bodiesPerWorld) * 1e3 / result.Median},
+        };
+        runner.add(std::move(result));
+    };
+
+    measure("parallel", [&]() { parallelWorlds.update(kDt); });
+    // Threads do not change how separate worlds step
+    if (threads == 1) {
+        measure("separate", [&]() {
+            for (const std::unique_ptr<PhysicsWorld>& world : separate)
+                world->update(kDt);
+        });
+    }
+}
+
+// A captured session replayed headless, timing each of its steps
+void replay(Runner& runner, const std::string& path, uint32_t threads) {
+    InputReplay recording;
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = threads - 1});
+    if (!recording.open(path.c_str()) || !recording.start(world)) {
+        std::fprintf(stderr, "cannot replay %s\n", path.c_str());
+        return;
+    }
+
+    std::vector<double> samples;
+    size_t bodies = 0;
+    for (;;) {
+        const Runner::Clock::time_point start = Runner::Clock::now();
+        if (!recording.step(world))
+            break;
+        samples.push_back(std::chrono::duration<double, std::milli>(Runner::Clock::now() - start).count());
+        bodies = std::max(bodies, world.getRigidbodyData().size());
+    }
+    if (samples.empty())
+        return;
+
+    const size_t slash = path.find_last_of("/\\");
+    Result result;
+    result.Name = "world/replay";
+    result.Variant = slash == std::string::npos ? path : path.substr(slash + 1);
+    result.Unit = "ms/step";
+    result.Iterations = samples.size();
+    const double total = std::accumulate(samples.begin(), samples.end(), 0.0);
+    Runner::summarize(samples, result);
+    result.Fields = {
+        {"max_bodies", static_cast<double>(bodies)},
+        {"threads", static_cast<double>(threads)},
+        {"total_ms", total},
+        {"failed", recording.hasFailed() ? 1.0 : 0.0},
+        {"first_mismatch", recording.getFirstMismatch() == InputReplay::kNoMismatch ? -1.0 : static_cast<double>(recording.getFirstMismatch())},
+    };
+    runner.add(std::move(result));
+}
+
+std::vector<uint32_t> threadCounts(const Runner& runner) {
+    std::vector<uint32_t> threads = runner.getSettings().Threads;
+    if (threads.empty()) {
+        const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        threads = {1};
+        if (hardware > 1)
+            threads.push_back(hardware);
+    }
+    return threads;
+}
+
+} // namespace
+
+void runReplays(Runner& runner) {
+    if (!runner.isEnabled("world/replay"))
+        return;
+    for (const std::string& path : runner.getSettings().Replays) {
+        for (uint32_t t : threadCounts(runner))
+            replay(runner, path, std::max(1u, t));
+    }
+}
+
+void runWorld(Runner& runner) {
+    const std::vector<uint32_t> threads = threadCounts(runner);
+
+    for (size_t bodies : {size_t(1'000), size_t(10'000), size_t(100'000), size_t(1'000'000)}) {
+        if (bodies > runner.getSettings().MaxBodies)
+            break;
+        for (uint32_t t : threads) {
+            step(runner, Scene::Integrate, bodies, std::max(1u, t));
+            step(runner, Scene::Pile, bodies, std::max(1u, t));
+        }
+    }
+
+    if (!runner.isEnabled("world/parallel"))
+        return;
+    for (size_t worlds : {size_t(100), size_t(1'000)}) {
+        if (worlds * 100 > runner.getSettings().MaxBodies)
+            break;
+        for (uint32_t t : threads)
+            parallel(runner, worlds, 100, std::max(1u, t));
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef> // size_t
+#include <memory_resource>
+#include <vector>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Where AlignedAllocator, and so every LaneVector and the per-body arrays of
+// RigidbodyData, takes its memory from; new_delete_resource() by default. Set
+// it before creating any world, e.g. to a resource backed by huge pages.
+// Containers keep the resource they were created with; nullptr restores the default.
+std::pmr::memory_resource* getPersistentResource();
+void setPersistentResource(std::pmr::memory_resource* resource);
+
+// Maps allocations of 2MB and more separately, on a 2MB boundary, and asks for
+// transparent huge pages on them; smaller ones, and large ones whose mapping
+// fails, go to new_delete_resource(). Meant for setPersistentResource() or as
+// the upstream of a LinearArena.
+std::pmr::memory_resource* getHugePageResource();
+
+// Minimal allocator that hands out storage aligned to Alignment bytes, so SIMD
+// kernels can use aligned loads on std::vector data.
+template <typename T, size_t Alignment = kCacheLineSize>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept : Resource(getPersistentResource()) {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& other) noexcept : Resource(other.Resource) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(Resource->allocate(n * sizeof(T), std::max(Alignment, alignof(T))));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        Resource->deallocate(p, n * sizeof(T), std::max(Alignment, alignof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>& other) const noexcept { return Resource == other.Resource; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>& other) const noexcept { return Resource != other.Resource; }
+
+    std::pmr::memory_resource* Resource;
+};
+
+// Vector whose data starts on a cache line, for SoA lanes read by SIMD kernels
+template <typename T>
+using LaneVector = std::vector<T, AlignedAllocator<T, kCacheLineSize>>;
+
+// Widest batch of floats a kernel processes (16 per AVX-512 register). Lane
+// arrays padded to a multiple of it never need a tail loop.
+constexpr size_t kLaneWidth = 16;
+
+} // namespace nyx
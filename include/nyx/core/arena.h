@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Bump allocator over blocks taken from an upstream resource. Memory only goes
+// back all at once through reset(), or down to a marker through rewind(), so
+// allocating is a pointer increment and deallocate() does nothing.
+//
+// reset() folds the blocks into one large enough for everything allocated
+// since the last reset, so an arena reset every step stops reaching upstream
+// after the first few steps. Not thread safe; each thread gets its own
+// scratch arena for that.
+class LinearArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit LinearArena(size_t blockSize = kDefaultBlockSize, std::pmr::memory_resource* upstream = getPersistentResource());
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    struct Block;
+
+    // Position to rewind to; blocks taken after it are kept for reuse
+    struct Marker {
+        Block* Current;
+        uintptr_t Cursor;
+        size_t Used;
+    };
+
+    NYX_FORCEINLINE Marker getMarker() const { return Marker{Current, Cursor, Used}; }
+    void rewind(const Marker& marker);
+    void reset();
+    // Gives every block back upstream
+    void release();
+
+    // Uninitialized storage for count objects of T, valid until the next reset or rewind past it
+    template <typename T>
+    NYX_FORCEINLINE T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Bytes handed out since the last reset, including alignment padding
+    NYX_FORCEINLINE size_t getUsed() const { return Used; }
+    NYX_FORCEINLINE size_t getPeak() const { return Peak; }
+    NYX_FORCEINLINE size_t getCapacity() const { return Capacity; }
+    NYX_FORCEINLINE size_t getBlockCount() const { return BlockCount; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    void nextBlock(size_t bytes, size_t alignment);
+    Block* allocateBlock(size_t size);
+
+    std::pmr::memory_resource* Upstream;
+    size_t BlockSize;
+
+    Block* First = nullptr;
+    Block* Current = nullptr; // blocks after it are spare, from before a rewind or reset
+    uintptr_t Cursor = 0;     // next free byte of Current
+    uintptr_t End = 0;
+
+    size_t Used = 0;
+    size_t FramePeak = 0;     // largest Used since the last reset, what the next single block must hold
+    size_t Peak = 0;
+    size_t Capacity = 0;
+    size_t BlockCount = 0;
+};
+
+// The calling thread's arena for temporary buffers, e.g. inside a job
+LinearArena& getScratchArena();
+
+// Releases everything allocated from the thread's scratch arena while it is
+// open. Scopes nest; the innermost must close first.
+class ScratchScope {
+public:
+    ScratchScope() : Arena(getScratchArena()), Mark(Arena.getMarker()) {}
+    ~ScratchScope() { Arena.rewind(Mark); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    NYX_FORCEINLINE LinearArena& accessArena() { return Arena; }
+
+private:
+    LinearArena& Arena;
+    LinearArena::Marker Mark;
+};
+
+} // namespace nyx
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Appends to a file through a fixed buffer, so many small writes cost a
+// memcpy each and reach the file in large blocks. Errors are sticky: writes
+// after a failed one are dropped and close() reports it.
+class BufferedWriter {
+public:
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    explicit BufferedWriter(size_t bufferSize = kDefaultBufferSize) : Buffer(bufferSize) {}
+    ~BufferedWriter() { close(); }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // Replaces path with an empty file
+    bool open(const char* path);
+    // Flushes and closes; false when anything since open() was not written
+    bool close();
+    bool flush();
+
+    NYX_FORCEINLINE bool isOpen() const { return File != nullptr; }
+    NYX_FORCEINLINE bool hasFailed() const { return Failed; }
+    // Bytes passed to write() since open(), flushed or not
+    NYX_FORCEINLINE size_t getBytesWritten() const { return Flushed + Used; }
+
+    NYX_FORCEINLINE void write(const void* data, size_t size) {
+        if (size <= Buffer.size() - Used) {
+            std::memcpy(Buffer.data() + Used, data, size);
+            Used += size;
+        } else {
+            writeLarge(data, size);
+        }
+    }
+
+    template <typename T>
+    NYX_FORCEINLINE void writeValue(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Values are written as bytes");
+        write(&value, sizeof(T));
+    }
+
+private:
+    void writeLarge(const void* data, size_t size);
+
+    std::vector<std::byte> Buffer;
+    size_t Used = 0;
+    size_t Flushed = 0;
+    std::FILE* File = nullptr;
+    bool Failed = false;
+};
+
+} // namespace nyx
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// The hot batch kernels (inertia inversion and rotation, the contact solver,
+// the broadphase sweep, transform interpolation, hull support, the quaternion
+// array kernels) are compiled for every level below in the same library, each
+// function with its own target attribute, and pick one per call from
+// getSimdLevel(). The rest of the library, Vec3 and friends included, is
+// compiled for the build's own flags, so a build without NYX_NATIVE runs on
+// any x86-64 and still uses AVX2 where the CPU has it.
+#if !defined(USE_DOUBLE_PRECISION) && (defined(__x86_64__) || defined(__i386__))
+#define NYX_SIMD_DISPATCH 1
+#define NYX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NYX_TARGET(isa)
+#endif
+
+#define NYX_TARGET_SSE4 NYX_TARGET("sse4.1")
+#define NYX_TARGET_AVX2 NYX_TARGET("avx2,fma")
+#define NYX_TARGET_AVX512 NYX_TARGET("avx512f,avx2,fma")
+
+enum class SimdLevel : uint8_t {
+    Scalar, // the build's own flags
+    Sse4,
+    Avx2,   // with FMA
+    Avx512, // AVX-512F
+};
+
+struct CpuFeatures {
+    bool Sse41 = false;
+    bool Avx2 = false;
+    bool Fma = false;
+    bool Avx512F = false; // only with the OS saving the wider registers, like Avx2
+};
+
+// What cpuid reports for this CPU, read once
+const CpuFeatures& getCpuFeatures();
+// The best level both this CPU and this build can run; Scalar off x86
+SimdLevel getSupportedSimdLevel();
+
+// The level the kernels use. Starts at getSupportedSimdLevel(), or at the
+// level named by the NYX_SIMD environment variable (scalar, sse4, avx2,
+// avx512) when that is lower.
+SimdLevel getSimdLevel();
+// Lowers or raises the level for later calls, clamped to the supported one;
+// returns the level now in use. Not while a world is stepping.
+SimdLevel setSimdLevel(SimdLevel level);
+
+const char* getSimdLevelName(SimdLevel level);
+// False when name is none of the names getSimdLevelName gives
+bool parseSimdLevel(std::string_view name, SimdLevel& level);
+
+} // namespace nyx
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Bodies per cache line of a float lane; parallel body ranges are split on
+// multiples of it so two workers never write the same line.
+constexpr size_t kBodiesPerCacheLine = kCacheLineSize / sizeof(float);
+
+using RangeFunction = void (*)(void* context, size_t begin, size_t end);
+using TaskFunction = void (*)(void* context, uint32_t index);
+
+// Hook for engines that already own a thread pool. run() must invoke
+// task(context, i) for every i in [0, count) and return once all have finished.
+class TaskScheduler {
+public:
+    virtual ~TaskScheduler() = default;
+
+    virtual uint32_t getConcurrency() const = 0;
+    virtual void run(uint32_t count, TaskFunction task, void* context) = 0;
+};
+
+struct JobSystemSettings {
+    uint32_t WorkerCount = 0;            // threads spawned besides the caller, 0 runs everything inline
+    bool PinWorkers = false;             // pin worker i to logical core i + 1
+    TaskScheduler* Scheduler = nullptr;  // use an external scheduler instead of spawning workers
+};
+
+// Work-stealing thread pool. Every worker owns a queue it pops from the back;
+// idle workers steal from the front of the others. The calling thread takes
+// part in the work it submits.
+class JobSystem {
+public:
+    explicit JobSystem(const JobSystemSettings& settings = {});
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // workers plus the calling thread
+    uint32_t getThreadCount() const;
+
+    // Split [0, count) into chunks whose boundaries are multiples of granularity
+    // and run fn(begin, end) on them in parallel. Returns once every chunk is done.
+    template <typename Fn>
+    void parallelFor(size_t count, size_t granularity, const Fn& fn) {
+        run(count, granularity, [](void* context, size_t begin, size_t end) {
+            (*static_cast<const Fn*>(context))(begin, end);
+        }, const_cast<Fn*>(&fn));
+    }
+
+    static uint32_t getHardwareWorkerCount();
+
+private:
+    struct RangeTask;
+    struct Job {
+        RangeTask* Task;
+        uint32_t Chunk;
+    };
+    struct WorkQueue;
+
+    void run(size_t count, size_t granularity, RangeFunction fn, void* context);
+    void workerMain(uint32_t queueIndex);
+
+    bool push(uint32_t queueIndex, const Job& job);
+    bool pop(uint32_t queueIndex, Job& job);
+    bool steal(uint32_t thiefIndex, Job& job);
+    static void execute(const Job& job);
+
+    JobSystemSettings Settings;
+    std::vector<std::thread> Workers;
+    std::unique_ptr<WorkQueue[]> Queues; // [0] belongs to external callers, [i + 1] to worker i
+    uint32_t QueueCount = 0;
+
+    std::atomic<uint32_t> QueuedJobs{0};
+    std::atomic<bool> Quit{false};
+    std::mutex WakeMutex;
+    std::condition_variable WakeCondition;
+};
+
+// Runs fn over [0, count) on jobs, or inline when no job system is set.
+template <typename Fn>
+NYX_FORCEINLINE void parallelFor(JobSystem* jobs, size_t count, size_t granularity, const Fn& fn) {
+    if (jobs)
+        jobs->parallelFor(count, granularity, fn);
+    else if (count)
+        fn(size_t(0), count);
+}
+
+// Runs fn(begin, end, buffer) over slices of [0, count), at least minPerSlice
+// items each and at most four per thread, every slice appending to its own
+// buffer in slices. The buffers are then concatenated into out in slice order,
+// which keeps out independent of the thread count. slices only grows, so the
+// buffers keep their capacity from one call to the next.
+template <typename Buffers, typename Out, typename Fn>
+void parallelCollect(JobSystem* jobs, size_t count, size_t minPerSlice, Buffers& slices, Out& out, const Fn& fn) {
+    const size_t threads = jobs ? jobs->getThreadCount() : 1;
+    const size_t sliceCount = std::max<size_t>(1, std::min(threads * 4, count / minPerSlice));
+    if (slices.size() < sliceCount)
+        slices.resize(sliceCount);
+
+    parallelFor(jobs, sliceCount, 1, [&](size_t begin, size_t end) {
+        for (size_t slice = begin; slice < end; ++slice) {
+            slices[slice].clear();
+            fn(slice * count / sliceCount, (slice + 1) * count / sliceCount, slices[slice]);
+        }
+    });
+
+    out.clear();
+    for (size_t slice = 0; slice < sliceCount; ++slice)
+        out.insert(out.end(), slices[slice].begin(), slices[slice].end());
+}
+
+} // namespace nyx
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// A whole file mapped into memory, mmap on Linux and macOS. Elsewhere the file
+// is read into a buffer, and a created file is written out by close().
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool openRead(const char* path);
+    // Replaces path with a file of size bytes, mapped writable
+    bool create(const char* path, size_t size);
+    // Returns false when a created file could not be written out
+    bool close();
+
+    NYX_FORCEINLINE std::byte* data() { return Data; }
+    NYX_FORCEINLINE const std::byte* data() const { return Data; }
+    NYX_FORCEINLINE size_t size() const { return Size; }
+
+private:
+    std::byte* Data = nullptr;
+    size_t Size = 0;
+    bool Writable = false;
+#if defined(NYX_PLATFORM_LINUX) || defined(NYX_PLATFORM_MACOS)
+    int Fd = -1;
+#else
+    std::vector<std::byte> Buffer;
+    std::string Path; // of a created file, written out on close
+#endif
+};
+
+} // namespace nyx
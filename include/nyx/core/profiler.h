@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Time spent in one stage, wall clock and CPU timestamp counter
+struct ProfileSample {
+    uint64_t Nanoseconds = 0;
+    uint64_t Cycles = 0; // 0 where there is no timestamp counter
+
+    NYX_FORCEINLINE double getMilliseconds() const { return static_cast<double>(Nanoseconds) * 1e-6; }
+};
+
+NYX_FORCEINLINE uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Writes the time between its construction and destruction into sample
+class ProfileScope {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ProfileScope(ProfileSample& sample) : Sample(sample), Start(Clock::now()), StartCycles(readCycleCounter()) {}
+    ~ProfileScope() {
+        Sample.Cycles = readCycleCounter() - StartCycles;
+        Sample.Nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Start).count());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileSample& Sample;
+    Clock::time_point Start;
+    uint64_t StartCycles;
+};
+
+// Stage timing compiles away unless NYX_PROFILE is defined, see the NYX_PROFILE
+// CMake option; the samples then stay zero
+#define NYX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define NYX_PROFILE_CONCAT(a, b) NYX_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(NYX_PROFILE)
+#define NYX_PROFILE_SCOPE(sample) nyx::ProfileScope NYX_PROFILE_CONCAT(nyxProfileScope, __LINE__)(sample)
+#else
+#define NYX_PROFILE_SCOPE(sample) ((void)0)
+#endif
+
+} // namespace nyx
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Fixed capacity history; pushing onto a full buffer drops the oldest entry.
+// Index 0 is the oldest entry, size() - 1 the newest.
+template <typename T, size_t Capacity>
+class RingBuffer {
+public:
+    static_assert(Capacity > 0);
+
+    NYX_FORCEINLINE void push(const T& value) {
+        Items[Head] = value;
+        Head = (Head + 1) % Capacity;
+        Count += Count < Capacity ? 1 : 0;
+    }
+
+    NYX_FORCEINLINE const T& operator[](size_t index) const {
+        assert(index < Count);
+        return Items[(Head + Capacity - Count + index) % Capacity];
+    }
+
+    NYX_FORCEINLINE const T& back() const { return (*this)[Count - 1]; }
+    NYX_FORCEINLINE size_t size() const { return Count; }
+    NYX_FORCEINLINE bool empty() const { return Count == 0; }
+    NYX_FORCEINLINE void clear() { Head = Count = 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    std::array<T, Capacity> Items{};
+    size_t Head = 0; // where the next push goes
+    size_t Count = 0;
+};
+
+} // namespace nyx
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#include "nyx/core/base.h"
+
+namespace nyx {
+
+// Records zones on every thread while started and writes them as Chrome Trace
+// Event JSON, which chrome://tracing and ui.perfetto.dev open with one track
+// per thread.
+//
+// Each thread appends to a fixed size buffer of its own, so recording takes no
+// lock; a full buffer drops further zones. The buffers are only read by write,
+// best called after stop(). One recorder is active at a time, and it must not be
+// destroyed while zones may still be open on other threads.
+class TraceRecorder {
+public:
+    static constexpr uint32_t kDefaultEventsPerThread = 1 << 16;
+
+    explicit TraceRecorder(uint32_t eventsPerThread = kDefaultEventsPerThread);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Makes this the recorder every NYX_TRACE_SCOPE writes to, replacing any other
+    void start();
+    void stop();
+    NYX_FORCEINLINE bool isRecording() const { return sActive.load(std::memory_order_relaxed) == this; }
+    // Drops everything recorded; only while stopped
+    void clear();
+
+    void write(std::ostream& out) const;
+    bool writeFile(const char* path) const;
+
+    uint64_t getEventCount() const;
+    uint64_t getDroppedCount() const;
+
+    NYX_FORCEINLINE static TraceRecorder* getActive() { return sActive.load(std::memory_order_acquire); }
+    NYX_FORCEINLINE static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // name must outlive the recorder, string literals in practice
+    void record(const char* name, uint64_t begin, uint64_t end);
+
+private:
+    struct Event {
+        const char* Name;
+        uint64_t Begin; // ns, steady clock
+        uint64_t End;
+    };
+    struct ThreadBuffer;
+
+    ThreadBuffer* acquireBuffer();
+
+    static std::atomic<TraceRecorder*> sActive;
+
+    uint32_t Capacity;
+    uint64_t Session = 0;  // tells buffers cached by threads for an older recording apart
+    uint64_t Epoch = 0;    // start() time, written as 0
+    std::atomic<ThreadBuffer*> Buffers{nullptr}; // pushed lock-free by the threads
+    std::atomic<uint32_t> ThreadCount{0};
+};
+
+// Names the calling thread's track in recordings started after the call
+void setTraceThreadName(const char* name);
+
+class TraceScope {
+public:
+    NYX_FORCEINLINE explicit TraceScope(const char* name) : Recorder(TraceRecorder::getActive()), Name(name) {
+        if (Recorder)
+            Begin = TraceRecorder::now();
+    }
+    NYX_FORCEINLINE ~TraceScope() {
+        if (Recorder)
+            Recorder->record(Name, Begin, TraceRecorder::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder* Recorder;
+    const char* Name;
+    uint64_t Begin = 0;
+};
+
+// Compiled in with NYX_PROFILE; costs an atomic load while nothing records
+#define NYX_TRACE_CONCAT_IMPL(a, b) a##b
+#define NYX_TRACE_CONCAT(a, b) NYX_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(NYX_PROFILE)
+#define NYX_TRACE_SCOPE(name) nyx::TraceScope NYX_TRACE_CONCAT(nyxTraceScope, __LINE__)(name)
+#else
+#define NYX_TRACE_SCOPE(name) ((void)0)
+#endif
+
+} // namespace nyx
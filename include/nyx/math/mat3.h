@@ -55,6 +55,15 @@ public:
         return result;
     }
 
+    bool isDiagonal() const {
+        return m[0][1] == 0.0f && m[0][2] == 0.0f && m[1][0] == 0.0f &&
+               m[1][2] == 0.0f && m[2][0] == 0.0f && m[2][1] == 0.0f;
+    }
+
+    bool isSymmetric() const {
+        return m[0][1] == m[1][0] && m[0][2] == m[2][0] && m[1][2] == m[2][1];
+    }
+
     bool isValid() const {
         real_t det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
                      m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
@@ -2,12 +2,18 @@
 
 #include <cmath>
 
+#include "nyx/core/base.h"
+
+// The approximation differs from std::sqrt in the last bits, which a
+// deterministic build cannot have
+#if defined(NYX_DETERMINISTIC)
+    #undef USE_CUSTOM_SQRT
+#endif
+
 #ifdef USE_CUSTOM_SQRT
     #include <cstdint>
 #endif
 
-#include "nyx/core/base.h"
-
 namespace nyx {
     NYX_FORCEINLINE real_t sqrt(real_t x)
     {
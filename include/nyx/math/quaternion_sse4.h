@@ -0,0 +1,99 @@
+#pragma once
+
+#include <assert.h>
+#include <smmintrin.h>
+
+#include "nyx/core/base.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+// Lanes are {x, y, z, w}, so the vector part lines up with Vec3's X, Y, Z
+class alignas(16) Quaternion {
+public:
+  NYX_FORCEINLINE Quaternion() : Value(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f)) {}
+  NYX_FORCEINLINE Quaternion(float w, float x, float y, float z) : Value(_mm_set_ps(w, z, y, x)) {}
+  NYX_FORCEINLINE Quaternion(float w, const Vec3 &v) : Value(_mm_insert_ps(v.Value, _mm_set_ss(w), 0x30)) {}
+  NYX_FORCEINLINE Quaternion(__m128 m) : Value(m) {}
+
+  NYX_FORCEINLINE static Quaternion identity() { return Quaternion(); }
+
+  // Hamilton product, this * other
+  NYX_FORCEINLINE Quaternion operator*(const Quaternion &other) const {
+    const __m128 b = other.Value;
+    const __m128 aw = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 ax = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 ay = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 az = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(2, 2, 2, 2));
+    // Per lane {x, y, z, w} of the result:
+    //   aw * b{x, y, z, w} + ax * b{w, z, y, x} * {+, -, +, -}
+    //   + ay * b{z, w, x, y} * {+, +, -, -} + az * b{y, x, w, z} * {-, +, +, -}
+    const __m128 sx = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0, 0x80000000, 0));
+    const __m128 sy = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0x80000000, 0, 0));
+    const __m128 sz = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0, 0, 0x80000000));
+    __m128 r = _mm_mul_ps(aw, b);
+    r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(ax, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3))), sx));
+    r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(ay, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))), sy));
+    r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(az, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1))), sz));
+    return r;
+  }
+
+  NYX_FORCEINLINE Quaternion operator*(float scalar) const {
+    return _mm_mul_ps(Value, _mm_set1_ps(scalar));
+  }
+
+  NYX_FORCEINLINE Quaternion operator+(const Quaternion &other) const {
+    return _mm_add_ps(Value, other.Value);
+  }
+
+  // Rotates v; the quaternion must be unit length. With u the vector part,
+  // t = 2 * cross(u, v) and v' = v + w * t + cross(u, t), two cross products
+  // instead of two full quaternion products.
+  NYX_FORCEINLINE Vec3 operator*(const Vec3 &v) const {
+    const Vec3 u(_mm_and_ps(Value, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))));
+    const Vec3 t = u.cross(v) * 2.0f;
+    const __m128 w = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(3, 3, 3, 3));
+    return Vec3(_mm_add_ps(_mm_add_ps(v.Value, _mm_mul_ps(t.Value, w)), u.cross(t).Value));
+  }
+
+  NYX_FORCEINLINE Quaternion &operator+=(const Quaternion &other) {
+    Value = _mm_add_ps(Value, other.Value);
+    return *this;
+  }
+
+  // inverse of a unit quaternion
+  NYX_FORCEINLINE Quaternion conjugate() const {
+    return _mm_xor_ps(Value, _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0x80000000, 0x80000000)));
+  }
+
+  // Exact square root and division, not rsqrt: orientations are renormalized
+  // every step and an approximate length would drift them off unit length
+  NYX_FORCEINLINE void normalize() {
+    const __m128 lengthSq = _mm_dp_ps(Value, Value, 0xFF);
+    if (_mm_cvtss_f32(lengthSq) > 0.0f)
+      Value = _mm_div_ps(Value, _mm_sqrt_ps(lengthSq));
+  }
+
+  NYX_FORCEINLINE Quaternion inverse() const {
+    const float normSq = _mm_cvtss_f32(_mm_dp_ps(Value, Value, 0xF1));
+    if (normSq == 0.0f) {
+      assert(false);
+      return _mm_setzero_ps();
+    }
+    return conjugate() * (1.0f / normSq);
+  }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+  union {
+    struct {
+      float x, y, z, w;
+    };
+    __m128 Value;
+  };
+#pragma GCC diagnostic pop
+};
+
+NYX_FORCEINLINE Quaternion operator*(float scalar, const Quaternion &q) { return q * scalar; }
+
+} // namespace nyx
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "nyx/core/base.h"
+#include "nyx/math/mat3.h"
+#include "nyx/math/quaternion.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+// A symmetric 3x3 matrix, such as an inertia tensor, in the six floats that
+// differ: 24 bytes where Mat3 takes 36
+class SymMat3 {
+public:
+    real_t XX, YY, ZZ, XY, XZ, YZ;
+
+    SymMat3() : XX(1.0f), YY(1.0f), ZZ(1.0f), XY(0.0f), XZ(0.0f), YZ(0.0f) {}
+
+    SymMat3(real_t xx, real_t yy, real_t zz, real_t xy, real_t xz, real_t yz)
+        : XX(xx), YY(yy), ZZ(zz), XY(xy), XZ(xz), YZ(yz) {}
+
+    // The upper triangle of m, which should be symmetric
+    explicit SymMat3(const Mat3& m)
+        : XX(m.m[0][0]), YY(m.m[1][1]), ZZ(m.m[2][2]), XY(m.m[0][1]), XZ(m.m[0][2]), YZ(m.m[1][2]) {}
+
+    Mat3 toMat3() const {
+        return Mat3(XX, XY, XZ,
+                    XY, YY, YZ,
+                    XZ, YZ, ZZ);
+    }
+
+    Vec3 operator*(const Vec3& v) const {
+        return Vec3(
+            XX * v.X + XY * v.Y + XZ * v.Z,
+            XY * v.X + YY * v.Y + YZ * v.Z,
+            XZ * v.X + YZ * v.Y + ZZ * v.Z
+        );
+    }
+
+    // Mat3::inverse of the full matrix, to the bit; the inverse of a symmetric
+    // matrix is symmetric, so only six of its cofactors are needed
+    SymMat3 inverse() const {
+        real_t det = XX * (YY * ZZ - YZ * YZ) -
+                     XY * (XY * ZZ - YZ * XZ) +
+                     XZ * (XY * YZ - YY * XZ);
+
+        if (std::abs(det) < 1e-6f) {
+            return SymMat3(); // Return identity if non-invertible
+        }
+
+        real_t invDet = 1.0f / det;
+        return SymMat3((YY * ZZ - YZ * YZ) * invDet,
+                       (XX * ZZ - XZ * XZ) * invDet,
+                       (XX * YY - XY * XY) * invDet,
+                       (XZ * YZ - XY * ZZ) * invDet,
+                       (XY * YZ - XZ * YY) * invDet,
+                       (XZ * XY - XX * YZ) * invDet);
+    }
+
+    bool isDiagonal() const {
+        return XY == 0.0f && XZ == 0.0f && YZ == 0.0f;
+    }
+};
+
+// R * s * Rᵀ, with R the rotation of the unit quaternion q: a body space
+// tensor such as an inverse inertia taken to world space. Spelled out in the
+// order the batch kernel of rotateTensors computes it.
+NYX_FORCEINLINE SymMat3 rotateTensor(const Quaternion& q, const SymMat3& s) {
+    const real_t x2 = q.x * 2.0f, y2 = q.y * 2.0f, z2 = q.z * 2.0f;
+    const real_t xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+    const real_t xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+    const real_t wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+    const real_t r00 = 1.0f - (yy + zz), r01 = xy - wz, r02 = xz + wy;
+    const real_t r10 = xy + wz, r11 = 1.0f - (xx + zz), r12 = yz - wx;
+    const real_t r20 = xz - wy, r21 = yz + wx, r22 = 1.0f - (xx + yy);
+
+    // A = R * s, then the upper triangle of A * Rᵀ
+    const real_t a00 = r00 * s.XX + r01 * s.XY + r02 * s.XZ;
+    const real_t a01 = r00 * s.XY + r01 * s.YY + r02 * s.YZ;
+    const real_t a02 = r00 * s.XZ + r01 * s.YZ + r02 * s.ZZ;
+    const real_t a10 = r10 * s.XX + r11 * s.XY + r12 * s.XZ;
+    const real_t a11 = r10 * s.XY + r11 * s.YY + r12 * s.YZ;
+    const real_t a12 = r10 * s.XZ + r11 * s.YZ + r12 * s.ZZ;
+    const real_t a20 = r20 * s.XX + r21 * s.XY + r22 * s.XZ;
+    const real_t a21 = r20 * s.XY + r21 * s.YY + r22 * s.YZ;
+    const real_t a22 = r20 * s.XZ + r21 * s.YZ + r22 * s.ZZ;
+    return SymMat3(a00 * r00 + a01 * r01 + a02 * r02,
+                   a10 * r10 + a11 * r11 + a12 * r12,
+                   a20 * r20 + a21 * r21 + a22 * r22,
+                   a00 * r10 + a01 * r11 + a02 * r12,
+                   a00 * r20 + a01 * r21 + a02 * r22,
+                   a10 * r20 + a11 * r21 + a12 * r22);
+}
+
+// out[k] = rotateTensor(q[indices[k]], s[indices[k]]) for k < count, packed in
+// the order of indices; 8 at a time with AVX2, picked by getSimdLevel()
+void rotateTensors(const Quaternion* q, const SymMat3* s, SymMat3* out, const uint32_t* indices, size_t count);
+
+} // namespace nyx
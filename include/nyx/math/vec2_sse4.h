@@ -90,14 +90,22 @@ public:
         return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(Value, Value, 0x31)));
     }
 
-    // 1/length() of the vector
+    // 1/length() of the vector; exact under NYX_DETERMINISTIC, see Vec3::rlength
     NYX_FORCEINLINE float rlength() const {
+#if defined(NYX_DETERMINISTIC)
+        return 1.0f / length();
+#else
         return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_dp_ps(Value, Value, 0x31)));
+#endif
     }
 
     // returns the vector scaled to unit length
     NYX_FORCEINLINE Vec2 normalize() const {
+#if defined(NYX_DETERMINISTIC)
+        return _mm_div_ps(Value, _mm_sqrt_ps(_mm_dp_ps(Value, Value, 0x3F)));
+#else
         return _mm_mul_ps(Value, _mm_rsqrt_ps(_mm_dp_ps(Value, Value, 0x3F)));
+#endif
     }
 
     // overloaded operators that ensure alignment
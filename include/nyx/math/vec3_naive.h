@@ -80,17 +80,15 @@ public:
         return len;
     }
 
-    NYX_FORCEINLINE Vec3 normalize() {
+    NYX_FORCEINLINE Vec3 normalize() const {
         real_t len = length();
         if (len <= 0) 
         {
             return Vec3{0};
         }
         
-        Vec3 result{0, 0, 0};
         real_t inv = 1.0f / len;
-        result *= inv;
-        return result;    
+        return *this * inv;
     }
 };
 
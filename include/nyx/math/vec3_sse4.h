@@ -102,13 +102,22 @@ public:
   NYX_FORCEINLINE float length() const {
     return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(Value, Value, 0x71)));
   }
-  // 1/length() of the vector
+  // 1/length() of the vector; approximate unless NYX_DETERMINISTIC, whose
+  // results must not depend on the CPU's rsqrt tables
   NYX_FORCEINLINE float rlength() const {
+#if defined(NYX_DETERMINISTIC)
+    return 1.0f / length();
+#else
     return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_dp_ps(Value, Value, 0x71)));
+#endif
   }
   // returns the vector scaled to unit length
   NYX_FORCEINLINE Vec3 normalize() const {
+#if defined(NYX_DETERMINISTIC)
+    return _mm_div_ps(Value, _mm_sqrt_ps(_mm_dp_ps(Value, Value, 0x7F)));
+#else
     return _mm_mul_ps(Value, _mm_rsqrt_ps(_mm_dp_ps(Value, Value, 0x7F)));
+#endif
   }
 
   // overloaded operators that ensure alignment
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef> // size_t
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+struct Aabb {
+    Vec3 Min;
+    Vec3 Max;
+
+    NYX_FORCEINLINE bool overlaps(const Aabb& other) const {
+        return Min.X <= other.Max.X && Max.X >= other.Min.X &&
+               Min.Y <= other.Max.Y && Max.Y >= other.Min.Y &&
+               Min.Z <= other.Max.Z && Max.Z >= other.Min.Z;
+    }
+
+    NYX_FORCEINLINE bool contains(const Aabb& other) const {
+        return Min.X <= other.Min.X && Min.Y <= other.Min.Y && Min.Z <= other.Min.Z &&
+               Max.X >= other.Max.X && Max.Y >= other.Max.Y && Max.Z >= other.Max.Z;
+    }
+
+    NYX_FORCEINLINE Aabb merged(const Aabb& other) const {
+        return Aabb{Vec3(std::min(Min.X, other.Min.X), std::min(Min.Y, other.Min.Y), std::min(Min.Z, other.Min.Z)),
+                    Vec3(std::max(Max.X, other.Max.X), std::max(Max.Y, other.Max.Y), std::max(Max.Z, other.Max.Z))};
+    }
+
+    NYX_FORCEINLINE Aabb expanded(real_t margin) const {
+        return Aabb{Vec3(Min.X - margin, Min.Y - margin, Min.Z - margin),
+                    Vec3(Max.X + margin, Max.Y + margin, Max.Z + margin)};
+    }
+
+    NYX_FORCEINLINE real_t surfaceArea() const {
+        const real_t dx = Max.X - Min.X, dy = Max.Y - Min.Y, dz = Max.Z - Min.Z;
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    NYX_FORCEINLINE Vec3 center() const {
+        return Vec3((Min.X + Max.X) * 0.5f, (Min.Y + Max.Y) * 0.5f, (Min.Z + Max.Z) * 0.5f);
+    }
+
+    // Slab test. invDirection is 1 / direction per axis; distance is where the
+    // ray enters the box, or 0 when the origin is inside.
+    NYX_FORCEINLINE bool intersectRay(const Vec3& origin, const Vec3& invDirection, real_t maxDistance, real_t& distance) const {
+        const real_t tx1 = (Min.X - origin.X) * invDirection.X, tx2 = (Max.X - origin.X) * invDirection.X;
+        const real_t ty1 = (Min.Y - origin.Y) * invDirection.Y, ty2 = (Max.Y - origin.Y) * invDirection.Y;
+        const real_t tz1 = (Min.Z - origin.Z) * invDirection.Z, tz2 = (Max.Z - origin.Z) * invDirection.Z;
+
+        const real_t tEnter = std::max({std::min(tx1, tx2), std::min(ty1, ty2), std::min(tz1, tz2), real_t(0)});
+        const real_t tExit = std::min({std::max(tx1, tx2), std::max(ty1, ty2), std::max(tz1, tz2), maxDistance});
+        distance = tEnter;
+        return tEnter <= tExit;
+    }
+};
+
+// Per-body world space bounds as separate min/max lanes
+struct AabbLanes {
+    NYX_FORCEINLINE size_t size() const { return MinX.size(); }
+
+    void resize(size_t count) {
+        for (LaneVector<real_t>* lane : {&MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ})
+            lane->resize(count);
+    }
+
+    void reserve(size_t count) {
+        for (LaneVector<real_t>* lane : {&MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ})
+            lane->reserve(count);
+    }
+
+    NYX_FORCEINLINE Aabb get(size_t i) const {
+        return Aabb{Vec3(MinX[i], MinY[i], MinZ[i]), Vec3(MaxX[i], MaxY[i], MaxZ[i])};
+    }
+
+    NYX_FORCEINLINE bool overlaps(size_t a, size_t b) const {
+        return MinX[a] <= MaxX[b] && MaxX[a] >= MinX[b] &&
+               MinY[a] <= MaxY[b] && MaxY[a] >= MinY[b] &&
+               MinZ[a] <= MaxZ[b] && MaxZ[a] >= MinZ[b];
+    }
+
+    LaneVector<real_t> MinX, MinY, MinZ;
+    LaneVector<real_t> MaxX, MaxY, MaxZ;
+};
+
+} // namespace nyx
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/physics/collision/aabb.h"
+#include "nyx/physics/collision/broadphase.h"
+
+namespace nyx {
+
+constexpr int32_t kNullNode = -1;
+
+// One node per cache line
+struct alignas(kCacheLineSize) AabbTreeNode {
+    Aabb Box;
+    int32_t Parent = kNullNode; // next free node while on the free list
+    int32_t Left = kNullNode;
+    int32_t Right = kNullNode;
+    int32_t Height = 0;         // 0 for leaves, -1 for free nodes
+    uint32_t UserData = 0;
+
+    NYX_FORCEINLINE bool isLeaf() const { return Left == kNullNode; }
+};
+
+// Bounding volume hierarchy stored in a flat node array. Leaves can be
+// inserted and removed one at a time (cost-guided descent plus AVL rotations),
+// or the whole tree can be bulk built with a binned SAH split.
+class AabbTree {
+public:
+    int32_t createProxy(const Aabb& box, uint32_t userData);
+    void destroyProxy(int32_t proxy);
+
+    // Leaves hold a box fattened by margin. The proxy is only reinserted once the
+    // tight box escapes it; returns whether that happened.
+    bool moveProxy(int32_t proxy, const Aabb& tight, real_t margin);
+
+    // Replace the tree with one built from boxes[i] carrying userData[i].
+    // proxies[i] receives the leaf of entry i.
+    void build(const Aabb* boxes, const uint32_t* userData, size_t count, int32_t* proxies);
+
+    // After setLeafBox, refit() recomputes the internal boxes of a bulk built tree
+    // without changing its topology
+    NYX_FORCEINLINE void setLeafBox(int32_t proxy, const Aabb& box) { Nodes[proxy].Box = box; }
+    NYX_FORCEINLINE void setUserData(int32_t proxy, uint32_t userData) { Nodes[proxy].UserData = userData; }
+    void refit();
+
+    void clear();
+
+    NYX_FORCEINLINE const Aabb& getFatAabb(int32_t proxy) const { return Nodes[proxy].Box; }
+    NYX_FORCEINLINE uint32_t getUserData(int32_t proxy) const { return Nodes[proxy].UserData; }
+    NYX_FORCEINLINE size_t getProxyCount() const { return ProxyCount; }
+    NYX_FORCEINLINE int32_t getHeight() const { return Root == kNullNode ? 0 : Nodes[Root].Height; }
+    NYX_FORCEINLINE int32_t getRoot() const { return Root; }
+
+    // fn(userData) for every leaf whose box overlaps box; return false to stop
+    template <typename Fn>
+    void query(const Aabb& box, Fn&& fn) const {
+        TraversalStack stack;
+        stack.push(Root);
+        while (!stack.empty()) {
+            const int32_t index = stack.pop();
+            if (index == kNullNode) continue;
+
+            const AabbTreeNode& node = Nodes[index];
+            if (!node.Box.overlaps(box)) continue;
+
+            if (node.isLeaf()) {
+                if (!fn(node.UserData)) return;
+            } else {
+                stack.push(node.Left);
+                stack.push(node.Right);
+            }
+        }
+    }
+
+    // fn(userData, maxDistance) for every leaf the ray enters within maxDistance.
+    // fn returns the new maxDistance, so a hit can clip the rest of the search,
+    // or a negative value to stop.
+    template <typename Fn>
+    void raycast(const Vec3& origin, const Vec3& direction, real_t maxDistance, Fn&& fn) const {
+        const Vec3 invDirection(1.0f / direction.X, 1.0f / direction.Y, 1.0f / direction.Z);
+
+        TraversalStack stack;
+        stack.push(Root);
+        while (!stack.empty()) {
+            const int32_t index = stack.pop();
+            if (index == kNullNode) continue;
+
+            const AabbTreeNode& node = Nodes[index];
+            real_t distance;
+            if (!node.Box.intersectRay(origin, invDirection, maxDistance, distance)) continue;
+
+            if (node.isLeaf()) {
+                maxDistance = fn(node.UserData, maxDistance);
+                if (maxDistance < 0.0f) return;
+            } else {
+                stack.push(node.Left);
+                stack.push(node.Right);
+            }
+        }
+    }
+
+private:
+    // Depth-first traversal holds at most height + 1 nodes. Balanced trees stay
+    // well inside the fixed array; a deeper one spills into Overflow instead of
+    // running off the end.
+    struct TraversalStack {
+        static constexpr int32_t kCapacity = 128;
+
+        NYX_FORCEINLINE void push(int32_t node) {
+            if (Size < kCapacity)
+                Items[Size] = node;
+            else
+                Overflow.push_back(node);
+            ++Size;
+        }
+        NYX_FORCEINLINE int32_t pop() {
+            if (--Size < kCapacity)
+                return Items[Size];
+            const int32_t node = Overflow.back();
+            Overflow.pop_back();
+            return node;
+        }
+        NYX_FORCEINLINE bool empty() const { return Size == 0; }
+
+        int32_t Items[kCapacity];
+        int32_t Size = 0;
+        std::vector<int32_t> Overflow; // items past kCapacity, only allocated by trees that deep
+    };
+
+    int32_t allocateNode();
+    void freeNode(int32_t node);
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    int32_t balance(int32_t index);
+    void refitUpwards(int32_t index);
+    int32_t buildRange(const Aabb* boxes, const uint32_t* userData, int32_t* proxies,
+                       uint32_t* indices, size_t begin, size_t end, int32_t parent, uint32_t depth);
+
+    std::vector<AabbTreeNode> Nodes;
+    std::vector<uint32_t> BuildIndices;
+    std::vector<Vec3> BuildCenters;
+    int32_t Root = kNullNode;
+    int32_t FreeList = kNullNode;
+    size_t ProxyCount = 0;
+};
+
+// Broadphase over two trees: active bodies live in an incrementally updated
+// tree with fattened leaves, inactive bodies in an SAH bulk-built tree that is
+// rebuilt when its membership changes and refit when its bodies move.
+class AabbTreeBroadphase : public Broadphase {
+public:
+    static constexpr real_t kDefaultMargin = 0.1f;
+
+    void update(const RigidbodyData& data, JobSystem* jobs) override;
+    void removeBody(uint32_t body, uint32_t last) override;
+
+    NYX_FORCEINLINE void setMargin(real_t margin) { Margin = margin; }
+
+    NYX_FORCEINLINE const AabbTree& getDynamicTree() const { return DynamicTree; }
+    NYX_FORCEINLINE const AabbTree& getStaticTree() const { return StaticTree; }
+
+    // Candidates from both trees; leaves are fattened, so callers refine with the tight bounds
+    template <typename Fn>
+    void query(const Aabb& box, Fn&& fn) const {
+        bool stopped = false;
+        DynamicTree.query(box, [&](uint32_t body) {
+            stopped = !fn(body);
+            return !stopped;
+        });
+        if (!stopped)
+            StaticTree.query(box, fn);
+    }
+
+    template <typename Fn>
+    void raycast(const Vec3& origin, const Vec3& direction, real_t maxDistance, Fn&& fn) const {
+        bool stopped = false;
+        DynamicTree.raycast(origin, direction, maxDistance, [&](uint32_t body, real_t distance) {
+            distance = fn(body, distance);
+            stopped = distance < 0.0f;
+            if (!stopped) maxDistance = distance;
+            return distance;
+        });
+        if (!stopped)
+            StaticTree.raycast(origin, direction, maxDistance, fn);
+    }
+
+private:
+    void syncProxies(const RigidbodyData& data);
+    void rebuildStaticTree(const RigidbodyData& data);
+
+    AabbTree DynamicTree;
+    AabbTree StaticTree;
+    std::vector<int32_t> Proxies;       // per body, leaf in whichever tree holds it
+    std::vector<uint8_t> InStaticTree;  // per body
+    std::vector<Aabb> StaticBoxes;      // scratch for static rebuilds
+    std::vector<uint32_t> StaticBodies;
+    std::vector<int32_t> StaticProxies;
+    std::vector<std::vector<BodyPair>> SlicePairs;
+    real_t Margin = kDefaultMargin;
+    bool StaticStale = false;           // a static body was removed since the last rebuild
+};
+
+} // namespace nyx
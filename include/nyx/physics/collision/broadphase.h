@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+
+namespace nyx {
+
+struct RigidbodyData;
+
+// Potentially colliding bodies, A < B
+struct BodyPair {
+    uint32_t A;
+    uint32_t B;
+
+    NYX_FORCEINLINE bool operator==(const BodyPair& other) const { return A == other.A && B == other.B; }
+    NYX_FORCEINLINE bool operator<(const BodyPair& other) const { return A < other.A || (A == other.A && B < other.B); }
+};
+
+struct RaycastHit {
+    uint32_t Body;
+    real_t Distance; // along the ray, in units of the direction's length
+};
+
+NYX_FORCEINLINE BodyPair makeBodyPair(uint32_t a, uint32_t b) {
+    return a < b ? BodyPair{a, b} : BodyPair{b, a};
+}
+
+enum class BroadphaseType : uint8_t {
+    None,
+    SweepAndPrune,
+    AabbTree,
+    HashGrid
+};
+
+// Finds body pairs whose bounds overlap. Pairs where neither body is awake
+// (inactive or asleep) are skipped.
+// The pair buffer is owned by the broadphase and reused from step to step.
+class Broadphase {
+public:
+    virtual ~Broadphase() = default;
+
+    virtual void update(const RigidbodyData& data, JobSystem* jobs) = 0;
+
+    // Called before RigidbodySystem::removeRigidbody moves last into body's place,
+    // for broadphases that keep per-body state between steps
+    virtual void removeBody(uint32_t /*body*/, uint32_t /*last*/) {}
+
+    NYX_FORCEINLINE const std::vector<BodyPair>& getPairs() const { return Pairs; }
+
+protected:
+    std::vector<BodyPair> Pairs;
+};
+
+} // namespace nyx
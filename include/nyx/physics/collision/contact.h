@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nyx/core/base.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+// Face to face contacts between boxes clip down to at most this many points
+constexpr uint32_t kMaxContactsPerPair = 4;
+
+// Point of contact between two bodies, world space
+struct Contact {
+    uint32_t A;
+    uint32_t B;
+    Vec3 Normal; // unit, from A towards B
+    Vec3 PointA; // on the surface of A
+    Vec3 PointB; // on the surface of B
+    real_t Depth; // penetration along Normal
+};
+
+} // namespace nyx
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nyx/core/base.h"
+#include "nyx/math/vec3.h"
+#include "nyx/physics/collision/contact.h"
+#include "nyx/physics/collision/shapes.h"
+
+namespace nyx {
+
+// A shape reduced to its core (point, segment, box or hull) plus a radius.
+// GJK and EPA run on the cores; the radius is added back afterwards, which
+// keeps round shapes exact and the iteration counts low.
+struct GjkProxy {
+    const ShapeStore* Shapes;
+    ShapeHandle Shape;
+    ShapeTransform Xf;
+    real_t Radius;
+
+    GjkProxy(const ShapeStore& shapes, ShapeHandle shape, const ShapeTransform& xf);
+
+    // World space point of the core furthest along direction
+    Vec3 support(const Vec3& direction) const;
+};
+
+struct GjkVertex {
+    Vec3 W; // A - B
+    Vec3 A;
+    Vec3 B;
+};
+
+struct GjkSimplex {
+    GjkVertex Vertices[4];
+    real_t Weights[4]; // barycentric weights of the point closest to the origin
+    uint32_t Count = 0;
+};
+
+// Closest points between the cores. Returns false when they overlap, leaving
+// simplex around the origin for EPA.
+bool gjkClosestPoints(const GjkProxy& a, const GjkProxy& b, GjkSimplex& simplex, Vec3& pointA, Vec3& pointB);
+
+// Penetration of overlapping cores from the simplex GJK stopped with.
+// Returns false if the Minkowski difference is too flat to expand.
+bool epaPenetration(const GjkProxy& a, const GjkProxy& b, const GjkSimplex& simplex,
+                    Vec3& normal, real_t& depth, Vec3& pointA, Vec3& pointB);
+
+// Full shapes, radii included. Fills everything in contact except the body ids.
+bool collideConvex(const GjkProxy& a, const GjkProxy& b, Contact& contact);
+
+} // namespace nyx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/physics/collision/aabb.h"
+#include "nyx/physics/collision/broadphase.h"
+
+namespace nyx {
+
+// Uniform grid hashed into a flat table, for dense scenes of similarly sized
+// bodies. Each body is binned by the cell of its position with a parallel
+// counting sort; pairs come from its own cell and the 13 forward neighbours,
+// which is exhaustive as long as cells are at least one body diameter wide.
+class HashGridBroadphase : public Broadphase {
+public:
+    void update(const RigidbodyData& data, JobSystem* jobs) override;
+
+    // Cells narrower than the largest bounding diameter miss pairs; 0 sizes them
+    // to that diameter every update
+    NYX_FORCEINLINE void setCellSize(real_t size) { CellSize = size; }
+    NYX_FORCEINLINE real_t getCellSize() const { return CellSize; }
+    NYX_FORCEINLINE real_t getUsedCellSize() const { return UsedCellSize; }
+
+private:
+    void binBodies(const RigidbodyData& data, JobSystem* jobs);
+    void findPairs(size_t begin, size_t end, std::vector<BodyPair>& out) const;
+
+    NYX_FORCEINLINE uint32_t bucketOf(int32_t x, int32_t y, int32_t z) const {
+        const uint32_t h = uint32_t(x) * 73856093u ^ uint32_t(y) * 19349663u ^ uint32_t(z) * 83492791u;
+        return h & BucketMask;
+    }
+
+    real_t CellSize = 0.0f;
+    real_t UsedCellSize = 0.0f;
+    uint32_t BucketMask = 0;
+
+    std::vector<uint32_t> BodyBucket;  // per body
+    std::vector<uint32_t> BucketCount; // per bucket, updated through std::atomic_ref
+    std::vector<uint32_t> BucketStart; // per bucket + 1, exclusive prefix sum of BucketCount
+    std::vector<uint32_t> BlockOffsets;
+
+    // Bodies sorted by bucket, with what the pair search needs gathered alongside
+    std::vector<uint32_t> Sorted;
+    std::vector<int32_t> SortedCellX, SortedCellY, SortedCellZ;
+    AabbLanes SortedBounds;
+    std::vector<uint8_t> SortedAwake;
+
+    std::vector<std::vector<BodyPair>> SlicePairs;
+};
+
+} // namespace nyx
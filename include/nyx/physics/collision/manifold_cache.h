@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/math/vec3.h"
+#include "nyx/physics/collision/contact.h"
+
+namespace nyx {
+
+struct RigidbodyData;
+
+constexpr uint32_t kMaxManifoldPoints = kMaxContactsPerPair;
+
+struct ManifoldPoint {
+    Vec3 LocalA;  // on the surface of A, in A's frame
+    Vec3 LocalB;  // on the surface of B, in B's frame
+    Vec3 PointA;  // world space, as of the last cache update
+    Vec3 PointB;
+    real_t Depth;
+
+    // Accumulated by the solver and fed back in the next step to warm start it
+    real_t NormalImpulse;
+    real_t TangentImpulse[2];
+};
+
+// Up to four points of contact between two bodies, kept across steps. Box
+// pairs report their whole support polygon at once, most other routines a single
+// point per step; the manifold accumulates those while they stay valid, so
+// resting contacts build a stable support polygon either way.
+struct ContactManifold {
+    uint32_t A;
+    uint32_t B;
+    Vec3 Normal; // from A towards B, from the latest contact
+    ManifoldPoint Points[kMaxManifoldPoints];
+    uint32_t PointCount;
+    uint32_t LastSeen; // step stamp of the latest contact
+};
+
+// Manifolds of touching pairs, found through an open addressed hash table
+// (linear probing, backward shift deletion) keyed by body pair. Both the
+// manifold pool and the table only grow, so steady state steps allocate nothing.
+class ManifoldCache {
+public:
+    // Points closer than this in A's frame are the same point
+    static constexpr real_t kDefaultMatchDistance = 0.02f;
+    // Points separating or sliding apart further than this are dropped
+    static constexpr real_t kDefaultBreakingDistance = 0.02f;
+
+    // Merges this step's contacts into the manifolds and drops the manifolds of
+    // pairs that stopped touching. Contacts of one pair must be adjacent. Manifolds
+    // between bodies that are both asleep or inactive stay as they are.
+    void update(const std::vector<Contact>& contacts, const RigidbodyData& data, JobSystem* jobs);
+    void clear();
+
+    // Drops body's manifolds and renames last to body in the others, matching
+    // RigidbodySystem::removeRigidbody. Linear in the number of manifolds.
+    void removeBody(uint32_t body, uint32_t last);
+
+    ContactManifold* find(uint32_t a, uint32_t b);
+    NYX_FORCEINLINE const ContactManifold* find(uint32_t a, uint32_t b) const { return const_cast<ManifoldCache*>(this)->find(a, b); }
+
+    NYX_FORCEINLINE const std::vector<ContactManifold>& getManifolds() const { return Manifolds; }
+    NYX_FORCEINLINE std::vector<ContactManifold>& accessManifolds() { return Manifolds; }
+    NYX_FORCEINLINE bool empty() const { return Manifolds.empty(); }
+
+    // The manifolds and the step stamp, for snapshots. restored() rebuilds the
+    // lookup table once they were replaced.
+    template <typename Fn>
+    void visitState(Fn&& fn) { fn(Manifolds); fn(Step); }
+    template <typename Fn>
+    void visitState(Fn&& fn) const { fn(Manifolds); fn(Step); }
+    void restored();
+    // Every manifold names a pair of bodies below bodies, A first, and holds
+    // at most kMaxManifoldPoints points; snapshot data is checked with this
+    bool isConsistent(size_t bodies) const;
+
+    NYX_FORCEINLINE void setMatchDistance(real_t distance) { MatchDistance = distance; }
+    NYX_FORCEINLINE void setBreakingDistance(real_t distance) { BreakingDistance = distance; }
+
+private:
+    static constexpr uint32_t kEmptySlot = ~0u;
+    static constexpr size_t kMinSlots = 64;
+
+    NYX_FORCEINLINE size_t slotOf(uint32_t a, uint32_t b) const {
+        const uint64_t key = (uint64_t(a) << 32 | b) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(key >> 32) & (Slots.size() - 1);
+    }
+
+    uint32_t findOrInsert(uint32_t a, uint32_t b);
+    void remove(uint32_t manifold);
+    void rehash(size_t slotCount);
+    void refresh(ContactManifold& manifold, const RigidbodyData& data) const;
+    void addPoint(ContactManifold& manifold, const Contact& contact, const RigidbodyData& data) const;
+
+    std::vector<ContactManifold> Manifolds;
+    std::vector<uint32_t> Slots;         // manifold index or kEmptySlot, power of two size
+    struct Run {
+        uint32_t First;    // first contact of the pair
+        uint32_t Manifold;
+    };
+
+    std::vector<Run> Runs;               // per touching pair this step
+    uint32_t Step = 0;
+    real_t MatchDistance = kDefaultMatchDistance;
+    real_t BreakingDistance = kDefaultBreakingDistance;
+};
+
+} // namespace nyx
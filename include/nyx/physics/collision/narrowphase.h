@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/arena.h"
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/physics/collision/broadphase.h"
+#include "nyx/physics/collision/contact.h"
+#include "nyx/physics/collision/shapes.h"
+
+namespace nyx {
+
+struct RigidbodyData;
+
+struct ShapeInstance {
+    ShapeHandle Shape;
+    ShapeTransform Xf;
+};
+
+// Writes up to kMaxContactsPerPair contacts, all but the body ids, and returns
+// how many; a's type is never above b's
+using CollideFunction = uint32_t (*)(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts);
+
+// Turns broadphase pairs into contacts. Pairs are grouped by their pair of
+// shape types so each batch runs one routine from a compile-time table:
+// closed form tests for spheres, boxes against spheres and capsules against
+// each other, separating axes with face clipping for two boxes, GJK/EPA for
+// everything else. Bodies without a shape are skipped. The contacts of one
+// pair are adjacent in the output and share a normal.
+class Narrowphase {
+public:
+    // The sort by shape types takes its buffers from frameArena, which only has
+    // to keep them until update returns
+    void update(const std::vector<BodyPair>& pairs, const RigidbodyData& data, const ShapeStore& shapes, LinearArena& frameArena, JobSystem* jobs);
+
+    NYX_FORCEINLINE const std::vector<Contact>& getContacts() const { return Contacts; }
+    NYX_FORCEINLINE void clear() { Contacts.clear(); }
+
+    // One pair outside of a step, in either type order
+    static uint32_t collide(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts);
+
+private:
+    std::vector<std::vector<Contact>> SliceContacts;
+    std::vector<Contact> Contacts;
+};
+
+} // namespace nyx
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+#include "nyx/math/quaternion.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+// Ordered from cheapest to most expensive; the narrowphase dispatches on the
+// lower type first
+enum class ShapeType : uint8_t {
+    None,
+    Sphere,
+    Box,
+    Capsule,
+    Convex,
+    Count
+};
+
+constexpr size_t kShapeTypeCount = static_cast<size_t>(ShapeType::Count);
+
+// Hull vertices are stored in blocks of this many, padded with the last vertex
+constexpr uint32_t kHullVertexBlock = 4;
+
+struct SphereShape {
+    real_t Radius;
+};
+
+struct BoxShape {
+    Vec3 HalfExtents;
+};
+
+// Segment from -HalfHeight to +HalfHeight along local Y, swept by Radius
+struct CapsuleShape {
+    real_t HalfHeight;
+    real_t Radius;
+};
+
+// Range of ShapeStore's hull vertex lanes. Any point cloud works: its support
+// mapping is the same as that of its convex hull.
+struct ConvexShape {
+    uint32_t FirstVertex;
+    uint32_t VertexCount; // padded to a multiple of kHullVertexBlock
+};
+
+struct ShapeHandle {
+    ShapeType Type = ShapeType::None;
+    uint32_t Index = 0; // into the array of Type
+};
+
+// Rigid transform with the rotation expanded to its basis vectors, so shapes
+// can move points in and out of local space with a few dot products
+struct ShapeTransform {
+    Vec3 Position;
+    Vec3 Axis[3];
+
+    NYX_FORCEINLINE ShapeTransform(const Vec3& position, const Quaternion& q) : Position(position) {
+        const real_t xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const real_t xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const real_t wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        Axis[0] = Vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+        Axis[1] = Vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+        Axis[2] = Vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+    }
+
+    NYX_FORCEINLINE Vec3 rotate(const Vec3& v) const { return Axis[0] * v.X + Axis[1] * v.Y + Axis[2] * v.Z; }
+    NYX_FORCEINLINE Vec3 inverseRotate(const Vec3& v) const { return Vec3(dot(Axis[0], v), dot(Axis[1], v), dot(Axis[2], v)); }
+    NYX_FORCEINLINE Vec3 toWorld(const Vec3& p) const { return Position + rotate(p); }
+    NYX_FORCEINLINE Vec3 toLocal(const Vec3& p) const { return inverseRotate(p - Position); }
+};
+
+// Collision geometry, one shape per body, centred on the body's position.
+// Each shape type lives in its own contiguous array so the narrowphase walks
+// homogeneous data. Slots of removed or replaced shapes are reused by the next
+// shape of their type; hull vertices are not reclaimed.
+class ShapeStore {
+public:
+    // Each setter returns the radius of the shape's bounding sphere
+    real_t setSphere(size_t body, real_t radius);
+    real_t setBox(size_t body, const Vec3& halfExtents);
+    real_t setCapsule(size_t body, real_t halfHeight, real_t radius);
+    real_t setConvex(size_t body, const Vec3* points, size_t count);
+
+    // Drops body's shape and gives it last's, matching RigidbodySystem::removeRigidbody
+    void removeBody(size_t body, size_t last);
+
+    NYX_FORCEINLINE ShapeHandle getShape(size_t body) const {
+        return body < BodyShapes.size() ? BodyShapes[body] : ShapeHandle{};
+    }
+    NYX_FORCEINLINE bool empty() const { return ShapeCount == 0; }
+
+    NYX_FORCEINLINE const SphereShape& getSphere(uint32_t index) const { return Spheres[index]; }
+    NYX_FORCEINLINE const BoxShape& getBox(uint32_t index) const { return Boxes[index]; }
+    NYX_FORCEINLINE const CapsuleShape& getCapsule(uint32_t index) const { return Capsules[index]; }
+    NYX_FORCEINLINE const ConvexShape& getConvex(uint32_t index) const { return Convexes[index]; }
+
+    // Local space vertex of the hull furthest along direction
+    Vec3 hullSupport(const ConvexShape& hull, const Vec3& direction) const;
+
+    // Every array and count of the store, in a fixed order, for snapshots
+    template <typename Fn>
+    void visitState(Fn&& fn) { visitStateOf(*this, fn); }
+    template <typename Fn>
+    void visitState(Fn&& fn) const { visitStateOf(*this, fn); }
+    // Shapes name bodies below bodies and slots and hull vertices the store
+    // has, as snapshot data must before it replaces a world's
+    bool isConsistent(size_t bodies) const;
+
+private:
+    template <typename Self, typename Fn>
+    static void visitStateOf(Self& self, Fn& fn) {
+        fn(self.BodyShapes);
+        fn(self.Spheres);
+        fn(self.Boxes);
+        fn(self.Capsules);
+        fn(self.Convexes);
+        fn(self.HullX);
+        fn(self.HullY);
+        fn(self.HullZ);
+        for (auto& free : self.FreeSlots)
+            fn(free);
+        fn(self.ShapeCount);
+    }
+
+    ShapeHandle& slot(size_t body, ShapeType type, size_t typeCount);
+    void release(ShapeHandle handle);
+
+    std::vector<ShapeHandle> BodyShapes; // per body
+    std::vector<SphereShape> Spheres;
+    std::vector<BoxShape> Boxes;
+    std::vector<CapsuleShape> Capsules;
+    std::vector<ConvexShape> Convexes;
+    LaneVector<real_t> HullX, HullY, HullZ;
+    std::vector<uint32_t> FreeSlots[kShapeTypeCount]; // per type, indices no body uses
+    size_t ShapeCount = 0;
+};
+
+} // namespace nyx
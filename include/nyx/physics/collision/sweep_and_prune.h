@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+#include "nyx/physics/collision/broadphase.h"
+
+namespace nyx {
+
+// Single-axis sort and sweep. The body order along the sweep axis is kept
+// between steps and repaired with an insertion sort, which is close to O(n)
+// when bodies move little from one step to the next.
+class SweepAndPrune : public Broadphase {
+public:
+    void update(const RigidbodyData& data, JobSystem* jobs) override;
+    NYX_FORCEINLINE void removeBody(uint32_t, uint32_t) override { ++Removed; }
+
+    NYX_FORCEINLINE uint32_t getAxis() const { return Axis; }
+
+private:
+    void chooseAxis(const RigidbodyData& data);
+    void sortOrder(const RigidbodyData& data);
+    void gatherSorted(const RigidbodyData& data, JobSystem* jobs);
+    void sweep(size_t begin, size_t end, std::vector<BodyPair>& out) const;
+
+    uint32_t Axis = 0;
+    bool OrderValid = false;
+    size_t Removed = 0; // since the last sort; each one displaces the body moved into its place
+
+    std::vector<uint32_t> Order; // body indices sorted by their minimum on Axis
+    std::vector<real_t> Keys;    // minimum on Axis, parallel to Order
+
+    // Bounds gathered in sweep order, so the sweep streams through memory
+    LaneVector<real_t> SortedMax;
+    LaneVector<real_t> SortedMinU, SortedMaxU, SortedMinV, SortedMaxV;
+    std::vector<uint8_t> SortedAwake;
+
+    std::vector<std::vector<BodyPair>> SlicePairs; // per parallel slice, kept to avoid reallocating
+};
+
+} // namespace nyx
@@ -1,48 +1,190 @@
 #pragma once
 
+#include <cassert>
 #include <cstdint>
+#include <span>
 #include <vector>
 
+#include "nyx/core/aligned_allocator.h"
 #include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/core/profiler.h"
 #include "nyx/math/mat3.h"
 #include "nyx/math/quaternion.h"
+#include "nyx/math/sym_mat3.h"
 #include "nyx/math/vec3.h"
+#include "nyx/physics/collision/aabb.h"
 
 namespace nyx {
 
+// Apply the world space inverse inertia R * I⁻¹ * Rᵀ without forming the matrix;
+// for one vector that is cheaper than rotateTensor
+NYX_FORCEINLINE Vec3 applyWorldInvInertia(const Quaternion& orientation, const SymMat3& invInertia, const Vec3& v) {
+    return orientation * (invInertia * (orientation.conjugate() * v));
+}
+
+// Names a rigidbody for as long as it exists. Body indices change when other
+// bodies are removed; a handle keeps naming the same body, and goes stale once
+// its body is removed and its slot reused with a new generation.
+struct RigidbodyHandle {
+    static constexpr uint32_t kInvalidSlot = ~0u;
+
+    uint32_t Slot = kInvalidSlot; // into the handle table
+    uint32_t Generation = 0;
+
+    NYX_FORCEINLINE bool operator==(const RigidbodyHandle& other) const = default;
+};
+
+// Initial state of a body for RigidbodySystem::addRigidbodies
+struct RigidbodyDesc {
+    Vec3 Position{0.0f, 0.0f, 0.0f};
+    Vec3 Velocity{0.0f, 0.0f, 0.0f};
+    real_t Mass = 1.0f;
+    Mat3 Inertia; // local space, symmetric
+};
+
+// What the last update did; the samples stay zero without NYX_PROFILE
+struct RigidbodyStats {
+    ProfileSample AwakeList;  // applying pending sleep and wake changes
+    ProfileSample Velocities;
+    ProfileSample Positions;  // integration and clearing the forces
+    ProfileSample Bounds;
+    uint32_t Integrated = 0;  // awake bodies moved
+};
+
 struct RigidbodyData {
-    RigidbodyData();
+    static constexpr size_t kInitialEntityCount = 10'000;
+
+    // Room for capacity bodies up front; see RigidbodySystem::reserve
+    explicit RigidbodyData(size_t capacity = kInitialEntityCount);
     ~RigidbodyData() = default;
 
-    NYX_FORCEINLINE const std::vector<Vec3>& getPositions() const { return Positions; }
-    NYX_FORCEINLINE const std::vector<Vec3>& getVelocities() const { return Velocities; }
-    NYX_FORCEINLINE const std::vector<Vec3>& getAngularVelocities() const { return AngularVelocities; }
-    NYX_FORCEINLINE const std::vector<Quaternion>& getOrientations() const { return Orientations; }
-    NYX_FORCEINLINE const std::vector<Mat3>& getInvInertias() const { return InvInertias; }
+    // Grows every per-body array to hold count bodies, so adding up to that many allocates nothing
+    void reserve(size_t count);
+
+    // Calls fn on every array that holds state rather than something derived
+    // from it, always in the same order; snapshots are written and read with it
+    template <typename Fn>
+    void visitState(Fn&& fn) { visitStateOf(*this, fn); }
+    template <typename Fn>
+    void visitState(Fn&& fn) const { visitStateOf(*this, fn); }
+    // Every per-body array holds size() entries and every body, island and
+    // handle slot it stores is in range; snapshot data is checked with this
+    // before it replaces a world's
+    bool isConsistent() const;
+
+    NYX_FORCEINLINE const LaneVector<Vec3>& getPositions() const { return Positions; }
+    NYX_FORCEINLINE const LaneVector<Vec3>& getVelocities() const { return Velocities; }
+    NYX_FORCEINLINE const LaneVector<Vec3>& getAngularVelocities() const { return AngularVelocities; }
+    NYX_FORCEINLINE const LaneVector<Quaternion>& getOrientations() const { return Orientations; }
+    NYX_FORCEINLINE const LaneVector<Vec3>& getForces() const { return Forces; }
+    NYX_FORCEINLINE const LaneVector<Vec3>& getTorques() const { return Torques; }
+    NYX_FORCEINLINE const LaneVector<real_t>& getInvMasses() const { return InvMasses; }
+    NYX_FORCEINLINE const LaneVector<SymMat3>& getInvInertias() const { return InvInertias; }
+    // R * I⁻¹ * Rᵀ per awake body, in getAwakeBodies() order. Taken by
+    // integrateVelocities from the orientations it sees and valid until
+    // integratePositions turns the bodies, which covers the contact solver.
+    NYX_FORCEINLINE const LaneVector<SymMat3>& getWorldInvInertias() const { return WorldInvInertias; }
+    NYX_FORCEINLINE const LaneVector<uint32_t>& getActive() const { return Active; }
+    NYX_FORCEINLINE const LaneVector<real_t>& getSleepTimes() const { return SleepTimes; }
+    NYX_FORCEINLINE const LaneVector<real_t>& getBoundingRadii() const { return BoundingRadii; }
+    NYX_FORCEINLINE const AabbLanes& getBounds() const { return Bounds; }
+    NYX_FORCEINLINE size_t size() const { return Positions.size(); }
+
+    // Body indices are dense and change on removal; handles resolve to the current one
+    NYX_FORCEINLINE bool isValid(RigidbodyHandle handle) const {
+        return handle.Slot < HandleSlots.size() && HandleSlots[handle.Slot].Generation == handle.Generation;
+    }
+    NYX_FORCEINLINE size_t getIndex(RigidbodyHandle handle) const {
+        assert(isValid(handle) && "Stale rigidbody handle");
+        return HandleSlots[handle.Slot].Body;
+    }
+    NYX_FORCEINLINE RigidbodyHandle getHandle(size_t index) const { return Handles[index]; }
+    // Every RigidbodyHandle::Slot handed out so far is below this
+    NYX_FORCEINLINE size_t getHandleSlotCount() const { return HandleSlots.size(); }
+
+    // Active bodies that are not asleep, ascending. Everything that moves bodies
+    // walks this list; it is refreshed by RigidbodySystem::updateAwakeBodies.
+    NYX_FORCEINLINE const LaneVector<uint32_t>& getAwakeBodies() const { return AwakeBodies; }
+    // Per body, its position in getAwakeBodies() or kNotAwake
+    NYX_FORCEINLINE const LaneVector<uint32_t>& getAwakeSlots() const { return AwakeSlots; }
+    // Exact at any time, even before the awake list is refreshed
+    NYX_FORCEINLINE bool isAwake(size_t index) const { return Active[index] && SleepIslands[index] == kNoIsland; }
+    NYX_FORCEINLINE bool isSleeping(size_t index) const { return SleepIslands[index] != kNoIsland; }
 
-    NYX_FORCEINLINE std::vector<Vec3>& accessPositions() { return Positions; }
-    NYX_FORCEINLINE std::vector<Vec3>& accessVelocities() { return Velocities; }
-    NYX_FORCEINLINE std::vector<Vec3>& accessForces() { return Forces; }
-    NYX_FORCEINLINE std::vector<Vec3>& accessTorques() { return Torques; }
-    NYX_FORCEINLINE std::vector<Vec3>& accessAngularVelocities() { return AngularVelocities; }
-    NYX_FORCEINLINE std::vector<Quaternion>& accessOrientations() { return Orientations; }
+    // Moving a body or changing its activity flags the cached bounds / awake list
+    NYX_FORCEINLINE LaneVector<Vec3>& accessPositions() { BoundsStale = true; return Positions; }
+    NYX_FORCEINLINE LaneVector<Vec3>& accessVelocities() { return Velocities; }
+    NYX_FORCEINLINE LaneVector<Vec3>& accessForces() { return Forces; }
+    NYX_FORCEINLINE LaneVector<Vec3>& accessTorques() { return Torques; }
+    NYX_FORCEINLINE LaneVector<Vec3>& accessAngularVelocities() { return AngularVelocities; }
+    NYX_FORCEINLINE LaneVector<Quaternion>& accessOrientations() { return Orientations; }
+    NYX_FORCEINLINE LaneVector<uint32_t>& accessActive() { AwakeStale = true; return Active; }
+    NYX_FORCEINLINE LaneVector<real_t>& accessSleepTimes() { return SleepTimes; }
+
+    static constexpr uint32_t kNotAwake = ~0u;
+    static constexpr uint32_t kNoIsland = ~0u;
 
 private:
-    static constexpr size_t kInitialEntityCount = 10'000;
+    template <typename Self, typename Fn>
+    static void visitStateOf(Self& self, Fn& fn) {
+        fn(self.Positions);
+        fn(self.Velocities);
+        fn(self.AngularVelocities);
+        fn(self.Orientations);
+        fn(self.Forces);
+        fn(self.Torques);
+        fn(self.Masses);
+        fn(self.InvMasses);
+        fn(self.Inertias);
+        fn(self.InvInertias);
+        fn(self.Active);
+        fn(self.SleepTimes);
+        fn(self.SleepIslands);
+        fn(self.NextInIsland);
+        fn(self.BoundingRadii);
+        fn(self.Handles);
+        fn(self.HandleSlots);
+        fn(self.FreeHandleSlots);
+    }
+
+    static constexpr real_t kDefaultBoundingRadius = 0.5f;
+
+    NYX_ALIGNAS_CACHE LaneVector<Vec3> Positions;            // world space
+    NYX_ALIGNAS_CACHE LaneVector<Vec3> Velocities;           // world space, m/s
+    NYX_ALIGNAS_CACHE LaneVector<Vec3> AngularVelocities;    // world space, rad/s
+    NYX_ALIGNAS_CACHE LaneVector<Quaternion> Orientations;   // world space
+    NYX_ALIGNAS_CACHE LaneVector<Vec3> Forces;               // world space
+    NYX_ALIGNAS_CACHE LaneVector<Vec3> Torques;              // world space
+
+    NYX_ALIGNAS_CACHE LaneVector<real_t> Masses;      // kg
+    NYX_ALIGNAS_CACHE LaneVector<real_t> InvMasses;
+    NYX_ALIGNAS_CACHE LaneVector<SymMat3> Inertias;          // local space
+    NYX_ALIGNAS_CACHE LaneVector<SymMat3> InvInertias;       // local space
+    NYX_ALIGNAS_CACHE LaneVector<SymMat3> WorldInvInertias;  // per awake body, derived
+
+    NYX_ALIGNAS_CACHE LaneVector<uint32_t> Active;
+
+    NYX_ALIGNAS_CACHE LaneVector<real_t> SleepTimes;      // s spent below the sleep thresholds
+    NYX_ALIGNAS_CACHE LaneVector<uint32_t> SleepIslands;  // first body of the sleeping island, or kNoIsland
+    NYX_ALIGNAS_CACHE LaneVector<uint32_t> NextInIsland;  // next body of the same sleeping island, or kNoIsland
+    NYX_ALIGNAS_CACHE LaneVector<uint32_t> AwakeBodies;
+    NYX_ALIGNAS_CACHE LaneVector<uint32_t> AwakeSlots;
 
-    NYX_ALIGNAS_CACHE std::vector<Vec3> Positions;            // world space
-    NYX_ALIGNAS_CACHE std::vector<Vec3> Velocities;           // world space, m/s
-    NYX_ALIGNAS_CACHE std::vector<Vec3> AngularVelocities;    // local space
-    NYX_ALIGNAS_CACHE std::vector<Quaternion> Orientations;   // world space
-    NYX_ALIGNAS_CACHE std::vector<Vec3> Forces;               // world space
-    NYX_ALIGNAS_CACHE std::vector<Vec3> Torques;              // local space
+    NYX_ALIGNAS_CACHE LaneVector<real_t> BoundingRadii; // m, sphere around Positions enclosing the body
+    AabbLanes Bounds;                                    // world space, refreshed at the end of every update
 
-    NYX_ALIGNAS_CACHE std::vector<real_t> Masses;      // kg
-    NYX_ALIGNAS_CACHE std::vector<real_t> InvMasses;
-    NYX_ALIGNAS_CACHE std::vector<Mat3> Inertias;      // local space
-    NYX_ALIGNAS_CACHE std::vector<Mat3> InvInertias;   // local space
+    struct HandleSlot {
+        uint32_t Body;       // dense index while in use
+        uint32_t Generation; // bumped on removal, so older handles no longer match
+    };
 
-    NYX_ALIGNAS_CACHE std::vector<uint32_t> Active;
+    LaneVector<RigidbodyHandle> Handles;  // per body, the handle naming it
+    LaneVector<HandleSlot> HandleSlots;   // sparse, indexed by RigidbodyHandle::Slot
+    LaneVector<uint32_t> FreeHandleSlots; // reused most recently freed first
+
+    bool BoundsStale = true;    // bodies that are not awake moved, so every bound is refreshed once
+    bool AwakeStale = true;     // bodies were added or (de)activated; the awake list is rebuilt from scratch
 
     friend class RigidbodySystem;
 };
@@ -56,11 +198,11 @@ struct Rigidbody {
   // transform direction from world space to body space
   NYX_FORCEINLINE Vec3 inverseTransformDirection(const Vec3& direction) const { return Data->getOrientations()[Index].inverse() * direction;}
 
-  // get velocity and angular velocity in body space
-  NYX_FORCEINLINE Vec3 getPointVelocity(const Vec3& point) const { return inverseTransformDirection(Data->getVelocities()[Index]) + cross(Data->getAngularVelocities()[Index], point); }
+  // velocity of a body space point, returned in body space
+  NYX_FORCEINLINE Vec3 getPointVelocity(const Vec3& point) const { return inverseTransformDirection(Data->getVelocities()[Index] + cross(Data->getAngularVelocities()[Index], transformDirection(point))); }
 
   // force and point vectors are in body space
-  NYX_FORCEINLINE void addForceAtPoint(const Vec3& force, const Vec3& point) { Data->accessForces()[Index] += transformDirection(force), Data->accessTorques()[Index] += cross(point, force); }
+  NYX_FORCEINLINE void addForceAtPoint(const Vec3& force, const Vec3& point) { Data->accessForces()[Index] += transformDirection(force), Data->accessTorques()[Index] += transformDirection(cross(point, force)); }
 
   // force vector in body space
   NYX_FORCEINLINE void addRelativeForce(const Vec3& force) { Data->accessForces()[Index] += transformDirection(force); }
@@ -71,21 +213,68 @@ struct Rigidbody {
 
 class RigidbodySystem {
 public:
-    RigidbodySystem();
+    explicit RigidbodySystem(size_t capacity = RigidbodyData::kInitialEntityCount);
     ~RigidbodySystem() = default;
 
-    size_t addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia);
+    RigidbodyHandle addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia);
+    // Same as calling addRigidbody for each, in order, but every array grows once
+    // and the bodies are filled in parallel, inverting the inertias in SIMD
+    // batches. handles, when given, receives one handle per body.
+    void addRigidbodies(std::span<const RigidbodyDesc> bodies, RigidbodyHandle* handles = nullptr);
+    // Moves the last body into the removed one's place in every per-body array, so
+    // the last body's index becomes the removed one's. The removed body's sleeping
+    // island wakes up, as it may have been holding the others up.
+    void removeRigidbody(RigidbodyHandle handle);
+    // Rebuilds the awake list, the lanes and the bounds after the state arrays
+    // were replaced through RigidbodyData::visitState
+    void restored();
+    NYX_FORCEINLINE void reserve(size_t count) { Data.reserve(count); }
     void update(real_t dt);
+
+    // The two halves of update, for callers that solve velocity constraints in between.
+    // integratePositions also clears the forces and refreshes the bounds.
+    void integrateVelocities(real_t dt);
+    void integratePositions(real_t dt);
     void applyImpulse(size_t index, const Vec3& impulse, const Vec3& contactVector);
 
+    // Sleeping bodies keep their pose and skip every stage until woken. Waking one
+    // body wakes the whole island it fell asleep with.
+    void wake(size_t index);
+    // Puts the bodies to sleep as one island and zeroes their velocities
+    void sleep(const uint32_t* bodies, size_t count);
+    // Applies pending sleep and wake changes to the awake list; update does this itself
+    void updateAwakeBodies();
+
+    void setBoundingRadius(size_t index, real_t radius);
+
+    // Body ranges of every stage are split across jobs; nullptr runs them inline
+    NYX_FORCEINLINE void setJobSystem(JobSystem* jobs) { Jobs = jobs; }
+
+    // force and torque are in world space, accumulated until the end of the next update.
+    // Both wake the body; forces written through accessForces wait until it wakes.
+    NYX_FORCEINLINE void addForce(size_t index, const Vec3& force) { wake(index); Data.Forces[index] += force; }
+    NYX_FORCEINLINE void addTorque(size_t index, const Vec3& torque) { wake(index); Data.Torques[index] += torque; }
+
+    // uniform acceleration applied to every active body, m/s^2
+    NYX_FORCEINLINE void setGravity(const Vec3& gravity) { Gravity = gravity; }
+    NYX_FORCEINLINE const Vec3& getGravity() const { return Gravity; }
+
     NYX_FORCEINLINE const RigidbodyData& getData() const { return Data; }
     NYX_FORCEINLINE RigidbodyData& accessData() { return Data; }
+    NYX_FORCEINLINE const RigidbodyStats& getStats() const { return Stats; }
 
 private:
     void integrate(real_t dt);
     void clearForces();
+    void updateBounds();
+    RigidbodyHandle allocateHandle(size_t index);
 
     RigidbodyData Data;
+    RigidbodyStats Stats;
+    std::vector<uint32_t> Woken; // bodies woken since the awake list was refreshed
+    bool AwakeChanged = false;   // bodies fell asleep since the awake list was refreshed
+    JobSystem* Jobs = nullptr;
+    Vec3 Gravity{0.0f, 0.0f, 0.0f};
 };
 
 }  // namespace nyx
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "nyx/core/buffered_writer.h"
+#include "nyx/core/mapped_file.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+namespace nyx {
+
+class PhysicsWorld;
+
+// A recording is an InputRecordingHeader, a snapshot of the world when it
+// started, then one record per input: an InputRecord tag followed by its
+// fields, packed, with vectors as three real_t. A Step record closes the
+// inputs of each update.
+constexpr char kInputRecordingMagic[8] = {'N', 'Y', 'X', 'R', 'E', 'C', '\0', '\0'};
+constexpr uint32_t kInputRecordingVersion = 1;
+
+enum class InputRecord : uint8_t {
+    Step,       // dt, then the state hash after the update when the recording has them
+    AddBody,    // position, velocity, mass, inertia
+    AddBodies,  // count, then count bodies as in AddBody
+    RemoveBody, // handle
+    Force,      // handle, force
+    Torque,     // handle, torque
+    Impulse,    // handle, impulse, contact vector
+    Gravity,    // gravity
+    Sphere,     // handle, radius
+    Box,        // handle, half extents
+    Capsule,    // handle, half height, radius
+    Convex,     // handle, count, points
+    End
+};
+
+struct InputRecordingHeader {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t RealSize;      // sizeof(real_t) of the recording build
+    uint32_t Hashes;        // 1 when Step records carry the state hash
+    uint32_t Reserved;
+    uint64_t SnapshotSize;  // bytes of the snapshot after the header
+};
+
+// Captures what is done to a world through PhysicsWorld: added and removed
+// bodies, shapes, forces, torques, impulses, gravity and the dt of every
+// update. Writes to the arrays from accessRigidbodyData() and setting
+// changes other than gravity are not seen after start().
+class InputRecorder {
+public:
+    InputRecorder() = default;
+    ~InputRecorder() { stop(); }
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // Writes world as the initial state and attaches to it. With hashes, every
+    // step also stores getStateHash() so a replay can tell where it went differently.
+    bool start(PhysicsWorld& world, const char* path, bool hashes = true);
+    // Detaches and closes the file; false when any of it could not be written
+    bool stop();
+
+    NYX_FORCEINLINE bool isRecording() const { return World != nullptr; }
+    NYX_FORCEINLINE uint32_t getStepCount() const { return Steps; }
+    NYX_FORCEINLINE size_t getBytesWritten() const { return Writer.getBytesWritten(); }
+
+    // Called by PhysicsWorld before it applies each input
+    NYX_FORCEINLINE void recordAddBody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
+        writeTag(InputRecord::AddBody);
+        writeBody(pos, vel, mass, inertia);
+    }
+    void recordAddBodies(std::span<const RigidbodyDesc> bodies);
+    NYX_FORCEINLINE void recordRemoveBody(RigidbodyHandle body) {
+        writeTag(InputRecord::RemoveBody);
+        Writer.writeValue(body);
+    }
+    NYX_FORCEINLINE void recordForce(RigidbodyHandle body, const Vec3& force) { writeBodyVector(InputRecord::Force, body, force); }
+    NYX_FORCEINLINE void recordTorque(RigidbodyHandle body, const Vec3& torque) { writeBodyVector(InputRecord::Torque, body, torque); }
+    NYX_FORCEINLINE void recordImpulse(RigidbodyHandle body, const Vec3& impulse, const Vec3& contactVector) {
+        writeBodyVector(InputRecord::Impulse, body, impulse);
+        writeVec3(contactVector);
+    }
+    NYX_FORCEINLINE void recordGravity(const Vec3& gravity) {
+        writeTag(InputRecord::Gravity);
+        writeVec3(gravity);
+    }
+    NYX_FORCEINLINE void recordSphere(RigidbodyHandle body, real_t radius) {
+        writeTag(InputRecord::Sphere);
+        Writer.writeValue(body);
+        Writer.writeValue(radius);
+    }
+    NYX_FORCEINLINE void recordBox(RigidbodyHandle body, const Vec3& halfExtents) { writeBodyVector(InputRecord::Box, body, halfExtents); }
+    NYX_FORCEINLINE void recordCapsule(RigidbodyHandle body, real_t halfHeight, real_t radius) {
+        writeTag(InputRecord::Capsule);
+        Writer.writeValue(body);
+        Writer.writeValue(halfHeight);
+        Writer.writeValue(radius);
+    }
+    void recordConvex(RigidbodyHandle body, const Vec3* points, size_t count);
+    // After the update of world, which closes the step
+    void recordStep(real_t dt, const PhysicsWorld& world);
+
+private:
+    NYX_FORCEINLINE void writeTag(InputRecord tag) { Writer.writeValue(tag); }
+    NYX_FORCEINLINE void writeVec3(const Vec3& v) {
+        const real_t xyz[3] = {v.X, v.Y, v.Z};
+        Writer.writeValue(xyz);
+    }
+    NYX_FORCEINLINE void writeBodyVector(InputRecord tag, RigidbodyHandle body, const Vec3& v) {
+        writeTag(tag);
+        Writer.writeValue(body);
+        writeVec3(v);
+    }
+    void writeBody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia);
+
+    BufferedWriter Writer;
+    PhysicsWorld* World = nullptr;
+    bool Hashes = false;
+    uint32_t Steps = 0;
+};
+
+// Plays a recording back into a world, as fast as the world steps. The world
+// must step bitwise like the recording one did (see NYX_DETERMINISTIC) for the
+// replay to follow it; with hashes in the recording, getFirstMismatch() tells
+// the first step where it did not.
+class InputReplay {
+public:
+    static constexpr uint32_t kNoMismatch = ~0u;
+
+    bool open(const char* path);
+    // Replaces the state of world with the one the recording started from
+    bool start(PhysicsWorld& world);
+    // Applies the inputs of the next step and updates world; false at the end
+    // of the recording or when a record does not make sense for world
+    bool step(PhysicsWorld& world);
+    // Every remaining step; returns how many ran
+    uint32_t run(PhysicsWorld& world);
+
+    NYX_FORCEINLINE uint32_t getStepCount() const { return Steps; }
+    NYX_FORCEINLINE uint32_t getFirstMismatch() const { return FirstMismatch; }
+    // A damaged record or one naming a body the world does not have stopped the replay
+    NYX_FORCEINLINE bool hasFailed() const { return Failed; }
+
+private:
+    template <typename T>
+    bool read(T& value);
+    bool readVec3(Vec3& v);
+    bool readBody(RigidbodyDesc& body);
+    bool readHandle(const PhysicsWorld& world, RigidbodyHandle& body);
+
+    MappedFile File;
+    InputRecordingHeader Header{};
+    size_t Begin = 0;  // first record, after the snapshot
+    size_t Cursor = 0;
+    uint32_t Steps = 0;
+    uint32_t FirstMismatch = kNoMismatch;
+    bool Failed = false;
+    std::vector<RigidbodyDesc> Bodies;
+    std::vector<Vec3> Points;
+};
+
+} // namespace nyx
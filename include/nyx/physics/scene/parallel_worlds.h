@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/physics/scene/physics_world.h"
+
+namespace nyx {
+
+// A container of many small independent worlds, e.g. rollouts of the same
+// scene, stepped in parallel. Each world owns its storage, sized for the bodies
+// it holds, and steps inline on one thread; the container spreads whole worlds
+// over its job system, so a sweep over thousands of them costs one parallelFor
+// instead of thousands. Nothing is shared between worlds: the per-body kernels
+// still run once per world, not once over every world's bodies.
+//
+// A world's baseline is a snapshot of it that reset() goes back to; clone()
+// copies a world into another through the same snapshot format. Both replace
+// only what a snapshot holds (see PhysicsWorld::getSnapshotSize).
+class ParallelWorlds {
+public:
+    static constexpr size_t kDefaultWorldCapacity = 64;
+
+    explicit ParallelWorlds(const JobSystemSettings& jobSettings = {});
+
+    ParallelWorlds(const ParallelWorlds&) = delete;
+    ParallelWorlds& operator=(const ParallelWorlds&) = delete;
+
+    // An empty world with room for capacity bodies; returns its index
+    uint32_t addWorld(size_t capacity = kDefaultWorldCapacity);
+    // A new world holding a copy of src, baseline included
+    uint32_t addClone(uint32_t src);
+    NYX_FORCEINLINE uint32_t size() const { return static_cast<uint32_t>(Worlds.size()); }
+
+    NYX_FORCEINLINE PhysicsWorld& accessWorld(uint32_t index) { return Worlds[index]->World; }
+    NYX_FORCEINLINE const PhysicsWorld& getWorld(uint32_t index) const { return Worlds[index]->World; }
+
+    // Every world once by dt
+    void update(real_t dt);
+    // Every world n ticks of its own FixedStepSettings
+    void stepN(uint32_t n);
+
+    // Remembers the world's current state as the one reset() returns it to
+    void saveBaseline(uint32_t index);
+    NYX_FORCEINLINE bool hasBaseline(uint32_t index) const { return !Worlds[index]->Baseline.empty(); }
+    // False when the world has no baseline
+    bool reset(uint32_t index);
+    // Every world with a baseline, in parallel
+    void resetAll();
+    // dst takes src's state and baseline
+    void clone(uint32_t src, uint32_t dst);
+
+    NYX_FORCEINLINE JobSystem& accessJobSystem() { return Jobs; }
+
+private:
+    struct Entry {
+        explicit Entry(size_t capacity) : World(JobSystemSettings{}, capacity) {}
+
+        PhysicsWorld World;
+        std::vector<std::byte> Baseline;
+    };
+
+    JobSystem Jobs;
+    std::vector<std::unique_ptr<Entry>> Worlds;
+    std::vector<std::byte> Scratch; // the snapshot clone() copies through
+};
+
+} // namespace nyx
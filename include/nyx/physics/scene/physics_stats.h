@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nyx/core/profiler.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+namespace nyx {
+
+// The stages of PhysicsWorld::update, in the order they run
+enum class PhysicsStage : uint32_t {
+    Velocities,  // forces and gravity
+    Solve,       // contact impulses
+    Positions,   // integration and bounds
+    Broadphase,
+    Narrowphase,
+    Manifolds,
+    Islands,     // islands and sleeping
+    Publish,     // transforms for the render thread, when enabled
+    Count
+};
+
+constexpr uint32_t kPhysicsStageCount = static_cast<uint32_t>(PhysicsStage::Count);
+
+constexpr const char* getStageName(PhysicsStage stage) {
+    switch (stage) {
+    case PhysicsStage::Velocities: return "Velocities";
+    case PhysicsStage::Solve: return "Solve";
+    case PhysicsStage::Positions: return "Positions";
+    case PhysicsStage::Broadphase: return "Broadphase";
+    case PhysicsStage::Narrowphase: return "Narrowphase";
+    case PhysicsStage::Manifolds: return "Manifolds";
+    case PhysicsStage::Islands: return "Islands";
+    case PhysicsStage::Publish: return "Publish";
+    case PhysicsStage::Count: break;
+    }
+    return "Unknown";
+}
+
+// One PhysicsWorld::update: time per stage and how much work each had. The
+// samples stay zero unless built with NYX_PROFILE; the counters are always set.
+struct PhysicsStats {
+    uint64_t Frame = 0;  // updates before this one
+    ProfileSample Step;  // the whole update
+    ProfileSample Stages[kPhysicsStageCount];
+    RigidbodyStats Rigidbodies; // breakdown of Velocities and Positions
+
+    uint32_t Bodies = 0;
+    uint32_t AwakeBodies = 0;
+    uint32_t Pairs = 0;
+    uint32_t Contacts = 0;
+    uint32_t Manifolds = 0;
+    uint32_t SolverIterations = 0;
+    uint32_t Islands = 0;
+
+    NYX_FORCEINLINE const ProfileSample& getStage(PhysicsStage stage) const { return Stages[static_cast<uint32_t>(stage)]; }
+    NYX_FORCEINLINE ProfileSample& accessStage(PhysicsStage stage) { return Stages[static_cast<uint32_t>(stage)]; }
+};
+
+} // namespace nyx
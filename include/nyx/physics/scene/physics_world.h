@@ -1,25 +1,225 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "nyx/core/arena.h"
 #include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/core/ring_buffer.h"
 #include "nyx/math/vec3.h"
 #include "nyx/math/mat3.h"
+#include "nyx/physics/collision/broadphase.h"
+#include "nyx/physics/collision/manifold_cache.h"
+#include "nyx/physics/collision/narrowphase.h"
+#include "nyx/physics/collision/shapes.h"
 #include "nyx/physics/rigidbody/rigidbody_system.h"
+#include "nyx/physics/scene/input_recording.h"
+#include "nyx/physics/scene/physics_stats.h"
+#include "nyx/physics/scene/transform_buffer.h"
+#include "nyx/physics/solver/contact_solver.h"
+#include "nyx/physics/solver/islands.h"
 
 namespace nyx {
 
+// Fixed-tick stepping through PhysicsWorld::advance and stepN
+struct FixedStepSettings {
+    real_t Dt = 1.0f / 60.0f; // s per tick
+    uint32_t Substeps = 1;    // updates per tick, each of Dt / Substeps
+    uint32_t MaxSteps = 5;    // ticks per advance at most; time beyond them is dropped
+};
+
 class PhysicsWorld {
 public:
+    static constexpr size_t kStatsHistory = 128;
+
     PhysicsWorld();
+    // capacity bodies fit before any per-body array grows; small worlds, as in
+    // ParallelWorlds, pass what they hold instead of the 10'000 default
+    explicit PhysicsWorld(const JobSystemSettings& jobSettings, size_t capacity = RigidbodyData::kInitialEntityCount);
     ~PhysicsWorld() = default;
 
-    size_t addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia);
-    void update(real_t dt);
+    RigidbodyHandle addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia);
+    // One pass over every array for level loads; see RigidbodySystem::addRigidbodies
+    NYX_FORCEINLINE void addRigidbodies(std::span<const RigidbodyDesc> bodies, RigidbodyHandle* handles = nullptr) {
+        if (Recorder) Recorder->recordAddBodies(bodies);
+        Rb.addRigidbodies(bodies, handles);
+    }
+    // The last body takes the removed one's index, in the rigidbody data as well
+    // as in the shapes, the broadphase and the cached manifolds. Contacts and
+    // pairs of the last update still use the old indices.
+    void removeRigidbody(RigidbodyHandle handle);
+    // Room for count bodies in every per-body array, so spawning up to that many allocates nothing
+    NYX_FORCEINLINE void reserve(size_t count) { Rb.reserve(count); }
+    // One update of dt, whatever it is; advance() and stepN() keep it fixed
+    NYX_FORCEINLINE void update(real_t dt) { step(dt, PublishTransforms ? dt : 0.0f); }
+
+    // Adds frameTime to the accumulator and runs as many whole ticks as it holds,
+    // at most MaxSteps so a slow frame does not make the next one slower still.
+    // Returns the ticks run; the rest carries over to the next call.
+    uint32_t advance(real_t frameTime);
+    // n ticks back to back, without returning in between. With transform
+    // publishing on only the last two ticks publish, so a frame spans one tick.
+    void stepN(uint32_t n);
+    NYX_FORCEINLINE void setFixedStepSettings(const FixedStepSettings& settings) { FixedStep = settings; }
+    NYX_FORCEINLINE const FixedStepSettings& getFixedStepSettings() const { return FixedStep; }
+    // How far into the next tick the accumulator is, in [0, 1); the alpha to
+    // draw the last published frame with
+    NYX_FORCEINLINE real_t getInterpolationAlpha() const { return Accumulator / FixedStep.Dt; }
+
+    NYX_FORCEINLINE bool isValid(RigidbodyHandle handle) const { return Rb.getData().isValid(handle); }
+    // Index into the rigidbody data, valid until the next removal
+    NYX_FORCEINLINE size_t getIndex(RigidbodyHandle handle) const { return Rb.getData().getIndex(handle); }
+
+    NYX_FORCEINLINE void setGravity(const Vec3& gravity) {
+        if (Recorder) Recorder->recordGravity(gravity);
+        Rb.setGravity(gravity);
+    }
+    // Both wake the body; they last until the end of the next update
+    NYX_FORCEINLINE void addForce(RigidbodyHandle body, const Vec3& force) {
+        if (Recorder) Recorder->recordForce(body, force);
+        Rb.addForce(getIndex(body), force);
+    }
+    NYX_FORCEINLINE void addTorque(RigidbodyHandle body, const Vec3& torque) {
+        if (Recorder) Recorder->recordTorque(body, torque);
+        Rb.addTorque(getIndex(body), torque);
+    }
+    // Changes the velocities at once; contactVector goes from the center of mass to where the impulse acts
+    NYX_FORCEINLINE void applyImpulse(RigidbodyHandle body, const Vec3& impulse, const Vec3& contactVector) {
+        if (Recorder) Recorder->recordImpulse(body, impulse, contactVector);
+        Rb.applyImpulse(getIndex(body), impulse, contactVector);
+    }
+
+    // Share an external pool between worlds; nullptr goes back to the world's own pool
+    void setJobSystem(JobSystem* jobs);
+    NYX_FORCEINLINE JobSystem& accessJobSystem() { return *Jobs; }
+
+    // Bounds come from RigidbodySystem::setBoundingRadius
+    void setBroadphase(BroadphaseType type);
+    NYX_FORCEINLINE BroadphaseType getBroadphaseType() const { return BpType; }
+    NYX_FORCEINLINE void setBoundingRadius(RigidbodyHandle body, real_t radius) { Rb.setBoundingRadius(getIndex(body), radius); }
+
+    // overlapping pairs found by the last update
+    const std::vector<BodyPair>& getPairs() const;
+
+    // Collision shapes also set the body's bounding radius
+    NYX_FORCEINLINE void setSphereShape(RigidbodyHandle body, real_t radius) {
+        if (Recorder) Recorder->recordSphere(body, radius);
+        setBoundingRadius(body, Shapes.setSphere(getIndex(body), radius));
+    }
+    NYX_FORCEINLINE void setBoxShape(RigidbodyHandle body, const Vec3& halfExtents) {
+        if (Recorder) Recorder->recordBox(body, halfExtents);
+        setBoundingRadius(body, Shapes.setBox(getIndex(body), halfExtents));
+    }
+    NYX_FORCEINLINE void setCapsuleShape(RigidbodyHandle body, real_t halfHeight, real_t radius) {
+        if (Recorder) Recorder->recordCapsule(body, halfHeight, radius);
+        setBoundingRadius(body, Shapes.setCapsule(getIndex(body), halfHeight, radius));
+    }
+    NYX_FORCEINLINE void setConvexShape(RigidbodyHandle body, const Vec3* points, size_t count) {
+        if (Recorder) Recorder->recordConvex(body, points, count);
+        setBoundingRadius(body, Shapes.setConvex(getIndex(body), points, count));
+    }
+    NYX_FORCEINLINE const ShapeStore& getShapes() const { return Shapes; }
+
+    // Contacts between the shapes of the pairs found by the last update
+    NYX_FORCEINLINE const std::vector<Contact>& getContacts() const { return Np.getContacts(); }
+
+    // Contacts accumulated over the last steps; the next update resolves them
+    NYX_FORCEINLINE const ManifoldCache& getManifolds() const { return Manifolds; }
+    NYX_FORCEINLINE void setContactSolverSettings(const ContactSolverSettings& settings) { Solver.setSettings(settings); }
+    NYX_FORCEINLINE const ContactSolverSettings& getContactSolverSettings() const { return Solver.getSettings(); }
+    NYX_FORCEINLINE const ContactSolverStats& getContactSolverStats() const { return Solver.getStats(); }
+
+    // Resting islands fall asleep and skip every stage until something touches them
+    NYX_FORCEINLINE void setSleepSettings(const SleepSettings& settings) { Islands.setSettings(settings); }
+    NYX_FORCEINLINE const SleepSettings& getSleepSettings() const { return Islands.getSettings(); }
+    NYX_FORCEINLINE void wakeRigidbody(RigidbodyHandle body) { Rb.wake(getIndex(body)); }
+    NYX_FORCEINLINE bool isAwake(RigidbodyHandle body) const { return Rb.getData().isAwake(getIndex(body)); }
+    NYX_FORCEINLINE uint32_t getIslandCount() const { return Islands.getIslandCount(); }
+
+    // Bodies whose bounds overlap box. Uses the trees with BroadphaseType::AabbTree,
+    // a linear scan of the bounds otherwise. Reflects the bounds of the last update.
+    void queryOverlap(const Aabb& box, std::vector<uint32_t>& bodies) const;
+
+    // Closest body whose bounds the ray enters within maxDistance
+    bool raycast(const Vec3& origin, const Vec3& direction, real_t maxDistance, RaycastHit& hit) const;
 
     NYX_FORCEINLINE const RigidbodyData& getRigidbodyData() const { return Rb.getData(); }
     NYX_FORCEINLINE RigidbodyData& accessRigidbodyData() { return Rb.accessData(); }
 
+    // Binary checkpoint of everything the next update depends on: the bodies with
+    // their sleep state and handles, shapes, cached contacts, gravity, the solver
+    // and sleep settings and the broadphase and storage choices. See snapshot.h
+    // for the format. The job system and the stats are not part of it.
+    size_t getSnapshotSize() const;
+    // Returns the bytes written, 0 when size is too small
+    size_t saveSnapshot(void* buffer, size_t size) const;
+    bool saveSnapshot(const char* path) const;
+    // Replaces the world's state; on failure the world is left as it was. The
+    // broadphase starts over, so pairs and contacts are empty until the next update.
+    bool loadSnapshot(const void* data, size_t size);
+    bool loadSnapshot(const char* path);
+
+    // FNV-1a over the bits of every body's position, velocities, orientation and
+    // sleep state, to compare runs frame by frame. Equal only between builds
+    // that step bitwise identically, e.g. with NYX_DETERMINISTIC.
+    uint64_t getStateHash() const;
+
+    // With publishing on, every update ends by handing the poses before and
+    // after it to TransformBuffer. A render thread reads them with
+    // acquireTransforms() while the next update runs, instead of the body
+    // arrays, and draws in between with interpolateTransforms().
+    NYX_FORCEINLINE void setTransformPublishing(bool enabled) {
+        PublishTransforms = enabled;
+        Transforms.reset();
+    }
+    NYX_FORCEINLINE bool isPublishingTransforms() const { return PublishTransforms; }
+    // Lock free; from one thread only, which may be another than the one updating
+    NYX_FORCEINLINE const TransformFrame& acquireTransforms() { return Transforms.acquire(); }
+
+    // Set by InputRecorder::start and stop; every input through the world is
+    // passed to it while set
+    NYX_FORCEINLINE void setInputRecorder(InputRecorder* recorder) { Recorder = recorder; }
+
+    // Timings and counters of the last update, and of the kStatsHistory before it
+    NYX_FORCEINLINE const PhysicsStats& getStats() const { return Stats; }
+    NYX_FORCEINLINE const RingBuffer<PhysicsStats, kStatsHistory>& getStatsHistory() const { return StatsHistory; }
+
+    // Memory for data that lives for one step, freed all at once at the end of
+    // update; the narrowphase sorts its pairs in it. Not thread safe; jobs use
+    // getScratchArena() instead.
+    NYX_FORCEINLINE LinearArena& accessFrameArena() { return FrameArena; }
+
 private:
+    // Publishes transforms spanning publishDt unless it is 0
+    void step(real_t dt, real_t publishDt);
+    void recordStats();
+
+    JobSystem OwnedJobs;
+    JobSystem* Jobs = &OwnedJobs;
+    InputRecorder* Recorder = nullptr;
     RigidbodySystem Rb;
+
+    BroadphaseType BpType = BroadphaseType::None;
+    std::unique_ptr<Broadphase> Bp;
+
+    ShapeStore Shapes;
+    Narrowphase Np;
+    ManifoldCache Manifolds;
+    ContactSolver Solver;
+    IslandBuilder Islands;
+
+    LinearArena FrameArena;
+
+    bool PublishTransforms = false;
+    TransformBuffer Transforms;
+
+    FixedStepSettings FixedStep;
+    real_t Accumulator = 0.0f;
+
+    PhysicsStats Stats;
+    uint64_t FrameCount = 0;
+    RingBuffer<PhysicsStats, kStatsHistory> StatsHistory;
 };
 
 } // namespace nyx
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nyx/core/base.h"
+#include "nyx/math/vec3.h"
+
+namespace nyx {
+
+// Layout of a PhysicsWorld snapshot:
+//
+//   SnapshotHeader
+//   SnapshotSection[SectionCount]
+//   one block per section, each starting on a kSnapshotAlignment boundary
+//
+// The blocks are the state arrays of the world copied as they are in memory,
+// in the order the visitState functions list them, so writing and reading
+// are one memcpy per array. Because a mapped file starts on a page, every
+// block of a mapped snapshot is aligned for direct use as well.
+//
+// Native byte order and real_t; a reader rejects snapshots that differ in
+// either, in the version or in any element size, and ones whose arrays do not
+// agree with each other on the body count or the indices they store.
+constexpr uint32_t kSnapshotVersion = 4; // 2: inertias as SymMat3, 3: no storage mode, 4: flags as bytes
+constexpr uint32_t kSnapshotByteOrder = 0x01020304;
+constexpr uint64_t kSnapshotAlignment = 64;
+constexpr char kSnapshotMagic[8] = {'N', 'Y', 'X', 'S', 'N', 'A', 'P', '\0'};
+
+struct SnapshotHeader {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t ByteOrder;  // kSnapshotByteOrder as written
+    uint32_t RealSize;   // sizeof(real_t)
+    uint32_t SectionCount;
+    uint64_t Size;       // of the whole snapshot, bytes
+    uint64_t Bodies;
+};
+
+struct SnapshotSection {
+    uint64_t Offset;     // from the start of the snapshot
+    uint64_t Count;
+    uint32_t ElementSize;
+    uint32_t Reserved;
+};
+
+// Block of the first section: the world's settings field by field. Flags are
+// bytes rather than bool, whose only valid values are 0 and 1; a reader
+// rejects any other byte instead of copying it into a bool.
+struct SnapshotWorldState {
+    Vec3 Gravity;
+    uint32_t Broadphase;        // BroadphaseType
+    uint32_t SolverIterations;
+    real_t Baumgarte;
+    real_t Slop;
+    real_t Friction;
+    real_t Restitution;
+    real_t RestitutionThreshold;
+    real_t Tolerance;
+    real_t SleepLinearThreshold;
+    real_t SleepAngularThreshold;
+    real_t TimeToSleep;
+    uint8_t WarmStarting;
+    uint8_t SleepEnabled;
+};
+
+} // namespace nyx
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+namespace nyx {
+
+// Positions and orientations as separate float lanes, padded to kLaneWidth
+// with the identity so kernels never need a tail loop
+struct TransformLanes {
+    NYX_FORCEINLINE size_t size() const { return Count; }
+    NYX_FORCEINLINE size_t paddedSize() const { return PositionX.size(); }
+
+    void resize(size_t count);
+
+    NYX_FORCEINLINE Vec3 getPosition(size_t i) const { return Vec3(PositionX[i], PositionY[i], PositionZ[i]); }
+    NYX_FORCEINLINE Quaternion getOrientation(size_t i) const { return Quaternion(OrientationW[i], OrientationX[i], OrientationY[i], OrientationZ[i]); }
+
+    LaneVector<real_t> PositionX, PositionY, PositionZ;
+    LaneVector<real_t> OrientationW, OrientationX, OrientationY, OrientationZ;
+
+    size_t Count = 0;
+};
+
+// The transforms of every body after one update, next to the ones it had after
+// the update before. Lane i of both is body Handles[i], so a body that changed
+// index in between still interpolates between its own two poses; one added in
+// between starts with Previous equal to Current.
+struct TransformFrame {
+    NYX_FORCEINLINE size_t size() const { return Current.size(); }
+
+    TransformLanes Previous;
+    TransformLanes Current;
+    LaneVector<RigidbodyHandle> Handles;
+    uint64_t Frame = 0; // PhysicsStats::Frame of the update that published it
+    real_t Dt = 0.0f;   // how far apart Previous and Current are
+};
+
+// Hands frames from the physics thread to one reader without locks. Three
+// frames rotate: the writer fills its own, then swaps it with the latest one
+// in a single atomic exchange; the reader swaps the latest one for the frame
+// it was holding. Only the writer writes, and never to a frame the reader
+// can have.
+class TransformBuffer {
+public:
+    // Physics thread: fills the back frame from data and makes it the latest
+    void publish(const RigidbodyData& data, uint64_t frame, real_t dt, JobSystem* jobs);
+    // Render thread: the latest frame, which stays as it is until the next
+    // acquire. Empty before the first publish.
+    const TransformFrame& acquire();
+
+    // Drops the history, so the next frame starts without interpolation
+    NYX_FORCEINLINE void reset() { HistoryCount = 0; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4; // the latest frame was not acquired yet
+
+    TransformFrame Frames[3];
+    uint8_t Back = 0;                     // writer's
+    uint8_t Front = 1;                    // reader's
+    std::atomic<uint8_t> Latest{2};
+
+    // Where each handle slot was in the frame published last, which the next
+    // publish takes its Previous poses from
+    LaneVector<uint32_t> HistorySlots;
+    size_t HistoryCount = 0;
+    uint8_t Last = 2;
+};
+
+// out = lerp of the positions and nlerp along the shorter arc of the
+// orientations from frame.Previous to frame.Current by alpha in [0, 1]
+void interpolateTransforms(const TransformFrame& frame, real_t alpha, TransformLanes& out);
+// Lanes [begin, end) only; out must already be resized to the frame and begin be a multiple of kLaneWidth
+void interpolateTransforms(const TransformFrame& frame, real_t alpha, TransformLanes& out, size_t begin, size_t end);
+
+} // namespace nyx
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/aligned_allocator.h"
+#include "nyx/core/base.h"
+#include "nyx/core/job_system.h"
+#include "nyx/math/vec3.h"
+#include "nyx/physics/collision/manifold_cache.h"
+
+namespace nyx {
+
+class RigidbodySystem;
+
+// Manifolds solved side by side, one per float of an AVX register. The same at
+// every SimdLevel, so the batches do not depend on the CPU.
+#if !defined(USE_DOUBLE_PRECISION)
+constexpr uint32_t kSolverWidth = 8;
+#else
+constexpr uint32_t kSolverWidth = 1;
+#endif
+
+struct ContactSolverSettings {
+    uint32_t Iterations = 8;
+    real_t Baumgarte = 0.2f;     // fraction of the penetration removed per step
+    real_t Slop = 0.005f;        // penetration left alone, keeps resting contacts from jittering
+    real_t Friction = 0.5f;
+    real_t Restitution = 0.0f;
+    real_t RestitutionThreshold = 1.0f; // approach speed below which contacts do not bounce, m/s
+    real_t Tolerance = 0.0f;     // stop once no normal impulse changes by more than this; 0 runs every iteration
+    bool WarmStarting = true;
+};
+
+// What the last solve did
+struct ContactSolverStats {
+    uint32_t Iterations = 0;
+    uint32_t Manifolds = 0;
+    uint32_t Points = 0;
+    uint32_t Colors = 0;
+    uint32_t Batches = 0;
+    uint32_t OverflowManifolds = 0; // bodies with too many contacts to color, solved one per batch
+    // Largest change of a normal impulse in the first and the last iteration;
+    // the gap between them shows how far the solver converged
+    real_t FirstImpulseDelta = 0.0f;
+    real_t LastImpulseDelta = 0.0f;
+};
+
+// Projected Gauss-Seidel over the points of the cached manifolds, with friction
+// and Baumgarte stabilization. Runs between the velocity and position halves
+// of the step, applying the same impulses as RigidbodySystem::applyImpulse to
+// a copy of the velocities that is written back at the end.
+//
+// Manifolds are graph colored so no two in a color share a moving body. Each
+// color is cut into batches of kSolverWidth manifolds solved in SIMD lanes, and
+// the batches of a color run in parallel without touching the same velocities.
+// The accumulated impulses are written back to the manifolds, and with warm
+// starting the next step begins from them.
+class ContactSolver {
+public:
+    void solve(RigidbodySystem& rb, ManifoldCache& manifolds, real_t dt, JobSystem* jobs);
+
+    NYX_FORCEINLINE void setSettings(const ContactSolverSettings& settings) { Settings = settings; }
+    NYX_FORCEINLINE const ContactSolverSettings& getSettings() const { return Settings; }
+    NYX_FORCEINLINE const ContactSolverStats& getStats() const { return Stats; }
+
+private:
+    // Greedy colors tracked in one bit per color per body; the rest overflow
+    static constexpr uint32_t kMaxColors = 64;
+
+    struct SolverBody {
+        real_t V[3];
+        real_t W[3];
+    };
+
+    // kSolverWidth manifolds, each array indexed by lane. Body 0 is a static
+    // stand-in for bodies that are not awake and for padding lanes.
+    struct alignas(kSolverWidth * sizeof(real_t)) ContactBatch {
+        struct Point {
+            real_t RA[3][kSolverWidth], RB[3][kSolverWidth]; // from each body's position
+            real_t NormalMass[kSolverWidth];
+            real_t TangentMass[2][kSolverWidth];
+            real_t Bias[kSolverWidth]; // target separating velocity
+            real_t NormalImpulse[kSolverWidth];
+            real_t TangentImpulse[2][kSolverWidth];
+        };
+
+        uint32_t BodyA[kSolverWidth], BodyB[kSolverWidth];
+        uint32_t Manifold[kSolverWidth]; // ~0u in padding lanes
+        real_t Normal[3][kSolverWidth];
+        real_t Tangent[2][3][kSolverWidth];
+        real_t InvMassA[kSolverWidth], InvMassB[kSolverWidth];
+        real_t InvInertiaA[6][kSolverWidth], InvInertiaB[6][kSolverWidth]; // world space xx yy zz xy xz yz
+        Point Points[kMaxManifoldPoints];
+    };
+
+    void gatherBodies(const RigidbodySystem& rb, JobSystem* jobs);
+    void color(const RigidbodySystem& rb, const ManifoldCache& manifolds);
+    void prepare(const RigidbodySystem& rb, const ManifoldCache& manifolds, real_t dt, JobSystem* jobs);
+    void prepareLane(const RigidbodySystem& rb, const ContactManifold& manifold, ContactBatch& batch, uint32_t lane, real_t dt) const;
+    template <typename Fn>
+    void forEachColor(JobSystem* jobs, const Fn& fn);
+    void scatterResults(RigidbodySystem& rb, ManifoldCache& manifolds, JobSystem* jobs);
+
+    ContactSolverSettings Settings;
+    ContactSolverStats Stats;
+
+    // All reused from step to step
+    std::vector<SolverBody> Bodies;     // awake slot + 1, [0] is the static stand-in
+    std::vector<uint64_t> BodyColors;   // colors used per awake body
+    std::vector<uint8_t> ManifoldColor; // per manifold, kMaxColors for overflow, 0xFF when skipped
+    std::vector<uint32_t> Ordered;      // manifold indices grouped by color
+    std::vector<uint32_t> ColorBatches; // first batch of each color, then of the overflow, then the end
+    LaneVector<ContactBatch> Batches;
+    std::vector<real_t> BatchDelta;     // largest normal impulse change per batch in the current iteration
+};
+
+} // namespace nyx
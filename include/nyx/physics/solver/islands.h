@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nyx/core/base.h"
+#include "nyx/physics/collision/manifold_cache.h"
+
+namespace nyx {
+
+class RigidbodySystem;
+
+struct SleepSettings {
+    bool Enabled = true;
+    real_t LinearThreshold = 0.05f;  // m/s
+    real_t AngularThreshold = 0.05f; // rad/s
+    real_t TimeToSleep = 0.5f;       // s every body of an island must stay below both
+};
+
+// Groups awake bodies into islands, the connected parts of the contact graph,
+// with union-find over the cached manifolds. Inactive bodies do not join
+// islands, so everything resting on the same ground still splits up.
+//
+// An island falls asleep once all of its bodies have been slower than the
+// thresholds for TimeToSleep. An awake island touching a sleeping body wakes
+// that body's island instead, and the two can only fall asleep together later.
+class IslandBuilder {
+public:
+    void update(RigidbodySystem& rb, const ManifoldCache& manifolds, real_t dt);
+
+    NYX_FORCEINLINE void setSettings(const SleepSettings& settings) { Settings = settings; }
+    NYX_FORCEINLINE const SleepSettings& getSettings() const { return Settings; }
+
+    // Islands of awake bodies found by the last update, before any fell asleep
+    NYX_FORCEINLINE uint32_t getIslandCount() const { return IslandCount; }
+
+private:
+    uint32_t find(uint32_t slot);
+    void unite(uint32_t a, uint32_t b);
+
+    SleepSettings Settings;
+    uint32_t IslandCount = 0;
+
+    // All indexed by awake slot and reused from step to step
+    std::vector<uint32_t> Parent;
+    std::vector<real_t> IslandSleepTime; // per root, the shortest sleep time of its bodies
+    std::vector<uint32_t> IslandStart;   // per root, offset of its bodies in Members
+    std::vector<uint32_t> Cursor;
+    std::vector<uint32_t> Members;       // awake bodies grouped by island
+    std::vector<uint32_t> Touched;       // awake slot, then the sleeping body it touches
+};
+
+} // namespace nyx
@@ -0,0 +1,98 @@
+#include "nyx/core/aligned_allocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+#if defined(NYX_PLATFORM_LINUX)
+#include <sys/mman.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+std::atomic<std::pmr::memory_resource*> gPersistentResource{nullptr};
+
+// Allocations of at least a huge page are mapped on their own, aligned to a
+// huge page and advised to be backed by huge pages, cutting TLB misses on the
+// large per-body arrays. Smaller ones, and every one off Linux, go to
+// new_delete_resource(). A large block whose mapping fails comes from
+// new_delete_resource() too and is remembered, so it is freed the same way.
+class HugePageResource final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+private:
+    static bool isLarge(size_t bytes, size_t alignment) {
+        return bytes >= kHugePageSize && alignment <= kHugePageSize;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+#if defined(NYX_PLATFORM_LINUX)
+        if (isLarge(bytes, alignment)) {
+            // mmap only promises page alignment; map a huge page more and trim both ends
+            const size_t size = roundUp(bytes);
+            void* mapped = mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapped != MAP_FAILED) {
+                const uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+                const uintptr_t aligned = (start + kHugePageSize - 1) & ~uintptr_t(kHugePageSize - 1);
+                if (aligned != start)
+                    munmap(mapped, aligned - start);
+                munmap(reinterpret_cast<void*>(aligned + size), start + kHugePageSize - aligned);
+                void* p = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+                madvise(p, size, MADV_HUGEPAGE);
+#endif
+                return p;
+            }
+
+            void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            std::lock_guard<std::mutex> lock(FallbackMutex);
+            Fallbacks.insert(p);
+            return p;
+        }
+#endif
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+#if defined(NYX_PLATFORM_LINUX)
+        if (isLarge(bytes, alignment)) {
+            std::unique_lock<std::mutex> lock(FallbackMutex);
+            if (Fallbacks.erase(p) == 0) {
+                lock.unlock();
+                munmap(p, roundUp(bytes));
+                return;
+            }
+        }
+#endif
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    static size_t roundUp(size_t bytes) { return (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1); }
+
+    std::mutex FallbackMutex;
+    std::unordered_set<void*> Fallbacks; // large blocks taken from the heap after a failed mmap
+};
+
+} // namespace
+
+std::pmr::memory_resource* getPersistentResource() {
+    std::pmr::memory_resource* resource = gPersistentResource.load(std::memory_order_acquire);
+    return resource ? resource : std::pmr::new_delete_resource();
+}
+
+void setPersistentResource(std::pmr::memory_resource* resource) {
+    gPersistentResource.store(resource, std::memory_order_release);
+}
+
+std::pmr::memory_resource* getHugePageResource() {
+    static HugePageResource resource;
+    return &resource;
+}
+
+} // namespace nyx
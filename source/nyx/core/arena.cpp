@@ -0,0 +1,125 @@
+#include "nyx/core/arena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace nyx {
+
+// Header in front of each block's data, a cache line so the data starts on one
+struct alignas(kCacheLineSize) LinearArena::Block {
+    Block* Next;
+    size_t Size; // bytes of data after the header
+};
+
+namespace {
+
+NYX_FORCEINLINE uintptr_t alignUp(uintptr_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(uintptr_t(alignment) - 1);
+}
+
+NYX_FORCEINLINE uintptr_t blockBegin(LinearArena::Block* block) {
+    return reinterpret_cast<uintptr_t>(block) + sizeof(LinearArena::Block);
+}
+
+} // namespace
+
+LinearArena::LinearArena(size_t blockSize, std::pmr::memory_resource* upstream)
+    : Upstream(upstream), BlockSize(blockSize) {
+    assert(Upstream && BlockSize > 0);
+}
+
+LinearArena::~LinearArena() {
+    release();
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+    uintptr_t p = alignUp(Cursor, alignment);
+    if (!Current || p + bytes > End) {
+        nextBlock(bytes, alignment);
+        p = alignUp(Cursor, alignment);
+    }
+
+    Used += p + bytes - Cursor;
+    Cursor = p + bytes;
+    FramePeak = std::max(FramePeak, Used);
+    Peak = std::max(Peak, Used);
+    return reinterpret_cast<void*>(p);
+}
+
+void LinearArena::nextBlock(size_t bytes, size_t alignment) {
+    const size_t needed = bytes + (alignment > kCacheLineSize ? alignment : 0);
+
+    // Reuse the spare block after Current when it is large enough, otherwise
+    // put a new one in front of it
+    Block* spare = Current ? Current->Next : First;
+    Block* block = spare;
+    if (!spare || spare->Size < needed) {
+        block = allocateBlock(std::max(BlockSize, needed));
+        block->Next = spare;
+        if (Current)
+            Current->Next = block;
+        else
+            First = block;
+    }
+
+    Current = block;
+    Cursor = blockBegin(block);
+    End = Cursor + block->Size;
+}
+
+LinearArena::Block* LinearArena::allocateBlock(size_t size) {
+    void* memory = Upstream->allocate(sizeof(Block) + size, alignof(Block));
+    Block* block = static_cast<Block*>(memory);
+    block->Next = nullptr;
+    block->Size = size;
+    Capacity += size;
+    ++BlockCount;
+    return block;
+}
+
+void LinearArena::rewind(const Marker& marker) {
+    assert(marker.Used <= Used);
+    Current = marker.Current;
+    Cursor = marker.Cursor;
+    End = Current ? blockBegin(Current) + Current->Size : 0;
+    Used = marker.Used;
+}
+
+void LinearArena::reset() {
+    // A step that spilled over several blocks gets them replaced by one that
+    // holds all of it, with some room for differing alignment padding
+    if (BlockCount > 1) {
+        const size_t size = alignUp(std::max(BlockSize, FramePeak + FramePeak / 8), 4096);
+        release();
+        First = allocateBlock(size);
+    }
+
+    Current = First;
+    Cursor = First ? blockBegin(First) : 0;
+    End = First ? Cursor + First->Size : 0;
+    Used = 0;
+    FramePeak = 0;
+}
+
+void LinearArena::release() {
+    for (Block* block = First; block;) {
+        Block* next = block->Next;
+        Upstream->deallocate(block, sizeof(Block) + block->Size, alignof(Block));
+        block = next;
+    }
+
+    First = Current = nullptr;
+    Cursor = End = 0;
+    Used = 0;
+    FramePeak = 0;
+    Capacity = 0;
+    BlockCount = 0;
+}
+
+LinearArena& getScratchArena() {
+    thread_local LinearArena arena;
+    return arena;
+}
+
+} // namespace nyx
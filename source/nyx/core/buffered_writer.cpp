@@ -0,0 +1,56 @@
+#include "nyx/core/buffered_writer.h"
+
+namespace nyx {
+
+bool BufferedWriter::open(const char* path) {
+    close();
+    File = std::fopen(path, "wb");
+    Failed = File == nullptr;
+    Used = 0;
+    Flushed = 0;
+    return File != nullptr;
+}
+
+bool BufferedWriter::close() {
+    if (!File)
+        return !Failed;
+    flush();
+    if (std::fclose(File) != 0)
+        Failed = true;
+    File = nullptr;
+    return !Failed;
+}
+
+bool BufferedWriter::flush() {
+    if (Used > 0) {
+        if (!File || Failed || std::fwrite(Buffer.data(), 1, Used, File) != Used)
+            Failed = true;
+        else
+            Flushed += Used;
+        Used = 0;
+    }
+    return !Failed;
+}
+
+void BufferedWriter::writeLarge(const void* data, size_t size) {
+    // Fill the buffer first so the file sees the bytes in order, then write
+    // anything a full buffer could not hold straight through
+    const size_t head = Buffer.size() - Used;
+    std::memcpy(Buffer.data() + Used, data, head);
+    Used += head;
+    flush();
+
+    const std::byte* rest = static_cast<const std::byte*>(data) + head;
+    size -= head;
+    if (size >= Buffer.size()) {
+        if (!File || Failed || std::fwrite(rest, 1, size, File) != size)
+            Failed = true;
+        else
+            Flushed += size;
+    } else {
+        std::memcpy(Buffer.data(), rest, size);
+        Used = size;
+    }
+}
+
+} // namespace nyx
@@ -0,0 +1,99 @@
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <cpuid.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+constexpr const char* kLevelNames[] = {"scalar", "sse4", "avx2", "avx512"};
+
+CpuFeatures detect() {
+    CpuFeatures features;
+#if defined(NYX_SIMD_DISPATCH)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return features;
+    features.Sse41 = ecx & bit_SSE4_1;
+    const bool fma = ecx & bit_FMA;
+
+    // AVX registers are only usable when the OS saves them on a context switch
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return features;
+    unsigned xcr0 = 0;
+    [[maybe_unused]] unsigned xcr0High = 0;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+    constexpr unsigned kAvxState = 0x6;     // SSE and upper YMM halves
+    constexpr unsigned kAvx512State = 0xE0; // opmasks and upper ZMM registers
+    if ((xcr0 & kAvxState) != kAvxState || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return features;
+    features.Avx2 = ebx & bit_AVX2;
+    features.Fma = fma;
+    features.Avx512F = (ebx & bit_AVX512F) && (xcr0 & kAvx512State) == kAvx512State;
+#endif
+    return features;
+}
+
+SimdLevel initialLevel() {
+    SimdLevel level = getSupportedSimdLevel();
+    SimdLevel requested;
+    if (const char* name = std::getenv("NYX_SIMD"); name && parseSimdLevel(name, requested))
+        level = std::min(level, requested);
+    return level;
+}
+
+// Function-local, so kernels run from another file's static initializers
+// still see the detected level rather than an unset global
+std::atomic<SimdLevel>& simdLevel() {
+    static std::atomic<SimdLevel> level{initialLevel()};
+    return level;
+}
+
+} // namespace
+
+const CpuFeatures& getCpuFeatures() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+SimdLevel getSupportedSimdLevel() {
+    const CpuFeatures& cpu = getCpuFeatures();
+    if (cpu.Avx512F && cpu.Avx2 && cpu.Fma)
+        return SimdLevel::Avx512;
+    if (cpu.Avx2 && cpu.Fma)
+        return SimdLevel::Avx2;
+    return cpu.Sse41 ? SimdLevel::Sse4 : SimdLevel::Scalar;
+}
+
+SimdLevel getSimdLevel() {
+    return simdLevel().load(std::memory_order_relaxed);
+}
+
+SimdLevel setSimdLevel(SimdLevel level) {
+    level = std::min(level, getSupportedSimdLevel());
+    simdLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    return kLevelNames[static_cast<uint8_t>(level)];
+}
+
+bool parseSimdLevel(std::string_view name, SimdLevel& level) {
+    for (uint8_t i = 0; i < std::size(kLevelNames); ++i) {
+        if (name == kLevelNames[i]) {
+            level = static_cast<SimdLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace nyx
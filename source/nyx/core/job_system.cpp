@@ -0,0 +1,249 @@
+#include "nyx/core/job_system.h"
+#include "nyx/core/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h> // _mm_pause
+#endif
+
+#if defined(NYX_PLATFORM_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(NYX_PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+// Queue the current thread pops from; threads foreign to a JobSystem use queue 0
+thread_local const JobSystem* tOwner = nullptr;
+thread_local uint32_t tQueueIndex = 0;
+
+constexpr uint32_t kSpinsBeforeSleep = 256;
+
+NYX_FORCEINLINE void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+void pinThread(std::thread& thread, uint32_t core) {
+    const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+#if defined(NYX_PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(NYX_PLATFORM_WINDOWS)
+    SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << (core % cores));
+#else
+    (void)thread;
+    (void)cores;
+#endif
+}
+
+} // namespace
+
+struct JobSystem::RangeTask {
+    RangeFunction Fn;
+    void* Context;
+    size_t Count;
+    size_t ChunkSize;
+    std::atomic<uint32_t> Remaining;
+};
+
+// Fixed-capacity deque, so submitting work never allocates. The owner pushes
+// and pops at the tail, thieves take from the head.
+struct alignas(kCacheLineSize) JobSystem::WorkQueue {
+    static constexpr uint32_t kCapacity = 1024;
+    static constexpr uint32_t kMask = kCapacity - 1;
+
+    void lock() {
+        while (Lock.test_and_set(std::memory_order_acquire)) {
+            while (Lock.test(std::memory_order_relaxed))
+                cpuRelax();
+        }
+    }
+    void unlock() { Lock.clear(std::memory_order_release); }
+
+    std::atomic_flag Lock = ATOMIC_FLAG_INIT;
+    uint32_t Head = 0;
+    uint32_t Tail = 0;
+    Job Jobs[kCapacity];
+};
+
+JobSystem::JobSystem(const JobSystemSettings& settings) : Settings(settings) {
+    if (Settings.Scheduler || Settings.WorkerCount == 0)
+        return;
+
+    QueueCount = Settings.WorkerCount + 1;
+    Queues = std::make_unique<WorkQueue[]>(QueueCount);
+
+    Workers.reserve(Settings.WorkerCount);
+    for (uint32_t i = 0; i < Settings.WorkerCount; ++i) {
+        Workers.emplace_back(&JobSystem::workerMain, this, i + 1);
+        if (Settings.PinWorkers)
+            pinThread(Workers.back(), i + 1);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(WakeMutex);
+        Quit.store(true, std::memory_order_release);
+    }
+    WakeCondition.notify_all();
+
+    for (std::thread& worker : Workers)
+        worker.join();
+}
+
+uint32_t JobSystem::getThreadCount() const {
+    if (Settings.Scheduler)
+        return std::max(1u, Settings.Scheduler->getConcurrency());
+    return static_cast<uint32_t>(Workers.size()) + 1;
+}
+
+uint32_t JobSystem::getHardwareWorkerCount() {
+    return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+void JobSystem::run(size_t count, size_t granularity, RangeFunction fn, void* context) {
+    if (count == 0)
+        return;
+
+    // A few chunks per thread leaves room for stealing to even out the load
+    granularity = std::max<size_t>(granularity, 1);
+    const size_t threads = getThreadCount();
+    size_t chunkSize = (count + threads * 4 - 1) / (threads * 4);
+    chunkSize = (chunkSize + granularity - 1) / granularity * granularity;
+    const uint32_t chunkCount = static_cast<uint32_t>((count + chunkSize - 1) / chunkSize);
+
+    if (threads == 1 || chunkCount == 1) {
+        fn(context, 0, count);
+        return;
+    }
+
+    RangeTask task{fn, context, count, chunkSize, {chunkCount}};
+
+    if (Settings.Scheduler) {
+        Settings.Scheduler->run(chunkCount, [](void* ctx, uint32_t chunk) {
+            execute(Job{static_cast<RangeTask*>(ctx), chunk});
+        }, &task);
+        return;
+    }
+
+    const uint32_t self = tOwner == this ? tQueueIndex : 0;
+
+    // Contiguous blocks of chunks per queue keep neighbouring ranges on one core unless stolen
+    QueuedJobs.fetch_add(chunkCount, std::memory_order_relaxed);
+    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const uint32_t queue = static_cast<uint32_t>(uint64_t(chunk) * QueueCount / chunkCount);
+        if (!push(queue, Job{&task, chunk})) {
+            QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            execute(Job{&task, chunk});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(WakeMutex);
+    }
+    WakeCondition.notify_all();
+
+    // Help out until every chunk of this task has finished
+    while (task.Remaining.load(std::memory_order_acquire) != 0) {
+        Job job;
+        if (pop(self, job) || steal(self, job))
+            execute(job);
+        else
+            cpuRelax();
+    }
+}
+
+void JobSystem::workerMain(uint32_t queueIndex) {
+    tOwner = this;
+    tQueueIndex = queueIndex;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "Worker %u", queueIndex);
+    setTraceThreadName(name);
+
+    uint32_t idleSpins = 0;
+    while (!Quit.load(std::memory_order_acquire)) {
+        Job job;
+        if (pop(queueIndex, job) || steal(queueIndex, job)) {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < kSpinsBeforeSleep) {
+            cpuRelax();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(WakeMutex);
+        WakeCondition.wait(lock, [this] {
+            return Quit.load(std::memory_order_acquire) || QueuedJobs.load(std::memory_order_relaxed) > 0;
+        });
+        idleSpins = 0;
+    }
+}
+
+bool JobSystem::push(uint32_t queueIndex, const Job& job) {
+    WorkQueue& queue = Queues[queueIndex];
+    queue.lock();
+    const bool hasRoom = queue.Tail - queue.Head < WorkQueue::kCapacity;
+    if (hasRoom)
+        queue.Jobs[queue.Tail++ & WorkQueue::kMask] = job;
+    queue.unlock();
+    return hasRoom;
+}
+
+bool JobSystem::pop(uint32_t queueIndex, Job& job) {
+    WorkQueue& queue = Queues[queueIndex];
+    queue.lock();
+    const bool hasJob = queue.Tail != queue.Head;
+    if (hasJob)
+        job = queue.Jobs[--queue.Tail & WorkQueue::kMask];
+    queue.unlock();
+
+    if (hasJob)
+        QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return hasJob;
+}
+
+bool JobSystem::steal(uint32_t thiefIndex, Job& job) {
+    for (uint32_t offset = 1; offset < QueueCount; ++offset) {
+        WorkQueue& queue = Queues[(thiefIndex + offset) % QueueCount];
+        queue.lock();
+        const bool hasJob = queue.Tail != queue.Head;
+        if (hasJob)
+            job = queue.Jobs[queue.Head++ & WorkQueue::kMask];
+        queue.unlock();
+
+        if (hasJob) {
+            QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(const Job& job) {
+    RangeTask* task = job.Task;
+    const size_t begin = size_t(job.Chunk) * task->ChunkSize;
+    const size_t end = std::min(begin + task->ChunkSize, task->Count);
+    {
+        NYX_TRACE_SCOPE("Job");
+        task->Fn(task->Context, begin, end);
+    }
+
+    // The submitter may return as soon as this reaches zero, so task must not be touched after it
+    task->Remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+} // namespace nyx
@@ -0,0 +1,129 @@
+#include "nyx/core/mapped_file.h"
+
+#if defined(NYX_PLATFORM_LINUX) || defined(NYX_PLATFORM_MACOS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+
+namespace nyx {
+
+#if defined(NYX_PLATFORM_LINUX) || defined(NYX_PLATFORM_MACOS)
+
+bool MappedFile::openRead(const char* path) {
+    close();
+    Fd = ::open(path, O_RDONLY);
+    if (Fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(Fd, &info) != 0 || info.st_size <= 0) {
+        close();
+        return false;
+    }
+    Size = static_cast<size_t>(info.st_size);
+
+    void* p = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    Data = static_cast<std::byte*>(p);
+    return true;
+}
+
+bool MappedFile::create(const char* path, size_t size) {
+    close();
+    Fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (Fd < 0 || size == 0 || ftruncate(Fd, static_cast<off_t>(size)) != 0) {
+        close();
+        return false;
+    }
+
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    Data = static_cast<std::byte*>(p);
+    Size = size;
+    Writable = true;
+    return true;
+}
+
+bool MappedFile::close() {
+    bool ok = true;
+    if (Data) {
+        // The kernel writes the pages back; msync only reports whether it can
+        if (Writable)
+            ok = msync(Data, Size, MS_ASYNC) == 0;
+        munmap(Data, Size);
+    }
+    if (Fd >= 0)
+        ::close(Fd);
+
+    Data = nullptr;
+    Size = 0;
+    Writable = false;
+    Fd = -1;
+    return ok;
+}
+
+#else
+
+bool MappedFile::openRead(const char* path) {
+    close();
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        Buffer.resize(static_cast<size_t>(size));
+        if (std::fread(Buffer.data(), 1, Buffer.size(), file) != Buffer.size())
+            Buffer.clear();
+    }
+    std::fclose(file);
+
+    Data = Buffer.empty() ? nullptr : Buffer.data();
+    Size = Buffer.size();
+    return Data != nullptr;
+}
+
+bool MappedFile::create(const char* path, size_t size) {
+    close();
+    if (size == 0)
+        return false;
+    Buffer.assign(size, std::byte{0});
+    Data = Buffer.data();
+    Size = size;
+    Writable = true;
+    Path = path;
+    return true;
+}
+
+bool MappedFile::close() {
+    bool ok = true;
+    if (Writable) {
+        std::FILE* file = std::fopen(Path.c_str(), "wb");
+        ok = file && std::fwrite(Buffer.data(), 1, Buffer.size(), file) == Buffer.size();
+        if (file)
+            ok = std::fclose(file) == 0 && ok;
+    }
+
+    Buffer = {};
+    Data = nullptr;
+    Size = 0;
+    Writable = false;
+    Path.clear();
+    return ok;
+}
+
+#endif
+
+} // namespace nyx
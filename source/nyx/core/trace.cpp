@@ -0,0 +1,161 @@
+#include "nyx/core/trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+
+namespace nyx {
+
+struct TraceRecorder::ThreadBuffer {
+    std::unique_ptr<Event[]> Events;
+    std::atomic<uint32_t> Count{0}; // published with release, so write sees whole events
+    std::atomic<uint64_t> Dropped{0};
+    uint32_t ThreadId = 0;
+    char Name[32] = {};
+    ThreadBuffer* Next = nullptr;
+};
+
+std::atomic<TraceRecorder*> TraceRecorder::sActive{nullptr};
+
+namespace {
+
+std::atomic<uint64_t> gSessions{0};
+
+// The buffer the calling thread last recorded into, and what it belongs to
+thread_local const TraceRecorder* tRecorder = nullptr;
+thread_local uint64_t tSession = 0;
+thread_local void* tBuffer = nullptr;
+thread_local char tThreadName[32] = {};
+
+void writeString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            out << '\\';
+        out << *s;
+    }
+    out << '"';
+}
+
+} // namespace
+
+void setTraceThreadName(const char* name) {
+    std::snprintf(tThreadName, sizeof(tThreadName), "%s", name);
+}
+
+TraceRecorder::TraceRecorder(uint32_t eventsPerThread)
+    : Capacity(eventsPerThread), Session(gSessions.fetch_add(1, std::memory_order_relaxed) + 1) {}
+
+TraceRecorder::~TraceRecorder() {
+    stop();
+    clear();
+}
+
+void TraceRecorder::start() {
+    if (Epoch == 0)
+        Epoch = now();
+    sActive.store(this, std::memory_order_release);
+}
+
+void TraceRecorder::stop() {
+    TraceRecorder* self = this;
+    sActive.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+}
+
+void TraceRecorder::clear() {
+    ThreadBuffer* buffer = Buffers.exchange(nullptr, std::memory_order_acquire);
+    while (buffer) {
+        ThreadBuffer* next = buffer->Next;
+        delete buffer;
+        buffer = next;
+    }
+    ThreadCount.store(0, std::memory_order_relaxed);
+    Session = gSessions.fetch_add(1, std::memory_order_relaxed) + 1;
+    Epoch = 0;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::acquireBuffer() {
+    if (tRecorder == this && tSession == Session)
+        return static_cast<ThreadBuffer*>(tBuffer);
+
+    // First zone of this thread in the recording; the only allocation it makes
+    ThreadBuffer* buffer = new ThreadBuffer;
+    buffer->Events = std::make_unique<Event[]>(Capacity);
+    buffer->ThreadId = ThreadCount.fetch_add(1, std::memory_order_relaxed);
+    if (tThreadName[0])
+        std::memcpy(buffer->Name, tThreadName, sizeof(buffer->Name));
+    else
+        std::snprintf(buffer->Name, sizeof(buffer->Name), "Thread %u", buffer->ThreadId);
+
+    buffer->Next = Buffers.load(std::memory_order_relaxed);
+    while (!Buffers.compare_exchange_weak(buffer->Next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    tRecorder = this;
+    tSession = Session;
+    tBuffer = buffer;
+    return buffer;
+}
+
+void TraceRecorder::record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadBuffer* buffer = acquireBuffer();
+    const uint32_t count = buffer->Count.load(std::memory_order_relaxed);
+    if (count == Capacity) {
+        buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->Events[count] = Event{name, begin, end};
+    buffer->Count.store(count + 1, std::memory_order_release);
+}
+
+void TraceRecorder::write(std::ostream& out) const {
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    const char* separator = "\n";
+    char numbers[96];
+    for (const ThreadBuffer* buffer = Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next) {
+        out << separator << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->ThreadId << ",\"args\":{\"name\":";
+        writeString(out, buffer->Name);
+        out << "}}";
+        separator = ",\n";
+
+        const uint32_t count = buffer->Count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; ++i) {
+            const Event& event = buffer->Events[i];
+            // Complete events, timestamps in microseconds from start()
+            std::snprintf(numbers, sizeof(numbers), "\"ts\":%.3f,\"dur\":%.3f",
+                          static_cast<double>(event.Begin - Epoch) * 1e-3, static_cast<double>(event.End - event.Begin) * 1e-3);
+            out << separator << "{\"ph\":\"X\",\"name\":";
+            writeString(out, event.Name);
+            out << ",\"pid\":1,\"tid\":" << buffer->ThreadId << ',' << numbers << '}';
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+bool TraceRecorder::writeFile(const char* path) const {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    write(file);
+    return static_cast<bool>(file);
+}
+
+uint64_t TraceRecorder::getEventCount() const {
+    uint64_t count = 0;
+    for (const ThreadBuffer* buffer = Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next)
+        count += buffer->Count.load(std::memory_order_acquire);
+    return count;
+}
+
+uint64_t TraceRecorder::getDroppedCount() const {
+    uint64_t count = 0;
+    for (const ThreadBuffer* buffer = Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next)
+        count += buffer->Dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+} // namespace nyx
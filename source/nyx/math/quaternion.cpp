@@ -0,0 +1,261 @@
+#include "nyx/math/quaternion.h"
+#include "nyx/core/cpu_features.h"
+
+#include <cmath>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+// Loads and stores below move whole 16 byte elements, padding included
+static_assert(sizeof(Quaternion) == 4 * sizeof(real_t), "Quaternion is w, x, y, z and nothing else");
+static_assert(sizeof(Vec3) == 4 * sizeof(real_t) || sizeof(real_t) != 4, "Vec3 is padded to four floats");
+
+struct Contiguous {
+    NYX_FORCEINLINE size_t operator()(size_t k) const { return k; }
+};
+
+struct Indexed {
+    const uint32_t* Indices;
+    NYX_FORCEINLINE size_t operator()(size_t k) const { return Indices[k]; }
+};
+
+// The arithmetic of the operators, spelled out so every level below can do
+// the same operations in the same order. The zero terms are the w of
+// (0, ω) and stay, as they decide the sign of a zero result.
+void integrateOne(Quaternion& q, const Vec3& omega, real_t dt) {
+    const real_t hx = omega.X * 0.5f, hy = omega.Y * 0.5f, hz = omega.Z * 0.5f;
+    const real_t hw = 0.0f * 0.5f;
+    const real_t pw = hw * q.w - hx * q.x - hy * q.y - hz * q.z;
+    const real_t px = hw * q.x + hx * q.w + hy * q.z - hz * q.y;
+    const real_t py = hw * q.y - hx * q.z + hy * q.w + hz * q.x;
+    const real_t pz = hw * q.z + hx * q.y - hy * q.x + hz * q.w;
+    q.w += pw * dt;
+    q.x += px * dt;
+    q.y += py * dt;
+    q.z += pz * dt;
+    q.normalize();
+}
+
+template <typename Index>
+void integrateScalar(Quaternion* q, const Vec3* angularVelocities, real_t dt, Index index, size_t begin, size_t end) {
+    for (size_t k = begin; k < end; ++k) {
+        const size_t i = index(k);
+        integrateOne(q[i], angularVelocities[i], dt);
+    }
+}
+
+#if defined(NYX_SIMD_DISPATCH)
+// Four 16 byte elements become one register per component, and back:
+// rows {a0 a1 a2 a3} of each element in, columns out. Its own inverse.
+NYX_FORCEINLINE NYX_TARGET_SSE4 void transpose(__m128& a, __m128& b, __m128& c, __m128& d) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+// The same for eight elements, in two 128 bit halves of four each
+NYX_FORCEINLINE NYX_TARGET_AVX2 void transpose(__m256& a, __m256& b, __m256& c, __m256& d) {
+    const __m256 t0 = _mm256_unpacklo_ps(a, b);
+    const __m256 t1 = _mm256_unpacklo_ps(c, d);
+    const __m256 t2 = _mm256_unpackhi_ps(a, b);
+    const __m256 t3 = _mm256_unpackhi_ps(c, d);
+    a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Element lo in the low half, element hi in the high half
+NYX_FORCEINLINE NYX_TARGET_AVX2 __m256 loadPair(const void* lo, const void* hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(static_cast<const float*>(lo))),
+                                _mm_loadu_ps(static_cast<const float*>(hi)), 1);
+}
+
+NYX_FORCEINLINE NYX_TARGET_AVX2 void storePair(void* lo, void* hi, __m256 v) {
+    _mm_storeu_ps(static_cast<float*>(lo), _mm256_castps256_ps128(v));
+    _mm_storeu_ps(static_cast<float*>(hi), _mm256_extractf128_ps(v, 1));
+}
+
+// One wide register per component, as the kernels work on them
+struct Wide4x128 {
+    __m128 A, B, C, D;
+};
+
+struct Wide4x256 {
+    __m256 A, B, C, D;
+};
+
+NYX_FORCEINLINE NYX_TARGET_SSE4 Wide4x128 load4(const void* base, size_t stride, size_t i0, size_t i1, size_t i2, size_t i3) {
+    const char* p = static_cast<const char*>(base);
+    Wide4x128 r{_mm_loadu_ps(reinterpret_cast<const float*>(p + i0 * stride)), _mm_loadu_ps(reinterpret_cast<const float*>(p + i1 * stride)),
+                _mm_loadu_ps(reinterpret_cast<const float*>(p + i2 * stride)), _mm_loadu_ps(reinterpret_cast<const float*>(p + i3 * stride))};
+    transpose(r.A, r.B, r.C, r.D);
+    return r;
+}
+
+NYX_FORCEINLINE NYX_TARGET_SSE4 void store4(void* base, size_t stride, size_t i0, size_t i1, size_t i2, size_t i3, Wide4x128 r) {
+    char* p = static_cast<char*>(base);
+    transpose(r.A, r.B, r.C, r.D);
+    _mm_storeu_ps(reinterpret_cast<float*>(p + i0 * stride), r.A);
+    _mm_storeu_ps(reinterpret_cast<float*>(p + i1 * stride), r.B);
+    _mm_storeu_ps(reinterpret_cast<float*>(p + i2 * stride), r.C);
+    _mm_storeu_ps(reinterpret_cast<float*>(p + i3 * stride), r.D);
+}
+
+NYX_FORCEINLINE NYX_TARGET_AVX2 Wide4x256 load8(const void* base, size_t stride, const size_t* i) {
+    const char* p = static_cast<const char*>(base);
+    Wide4x256 r{loadPair(p + i[0] * stride, p + i[4] * stride), loadPair(p + i[1] * stride, p + i[5] * stride),
+                loadPair(p + i[2] * stride, p + i[6] * stride), loadPair(p + i[3] * stride, p + i[7] * stride)};
+    transpose(r.A, r.B, r.C, r.D);
+    return r;
+}
+
+NYX_FORCEINLINE NYX_TARGET_AVX2 void store8(void* base, size_t stride, const size_t* i, Wide4x256 r) {
+    char* p = static_cast<char*>(base);
+    transpose(r.A, r.B, r.C, r.D);
+    storePair(p + i[0] * stride, p + i[4] * stride, r.A);
+    storePair(p + i[1] * stride, p + i[5] * stride, r.B);
+    storePair(p + i[2] * stride, p + i[6] * stride, r.C);
+    storePair(p + i[3] * stride, p + i[7] * stride, r.D);
+}
+
+namespace sse4 {
+
+// The operations quaternion_kernels.inl is written against
+
+struct Ops {
+    using V = __m128;
+    using Wide4 = Wide4x128;
+    static constexpr size_t kWidth = 4;
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static V set1(real_t a) { return _mm_set1_ps(a); }
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static V add(V a, V b) { return _mm_add_ps(a, b); }
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    // 1 / sqrt(a) where a > 0, else 1
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static V invLength(V a) {
+        const V one = _mm_set1_ps(1.0f);
+        return _mm_blendv_ps(one, _mm_div_ps(one, _mm_sqrt_ps(a)), _mm_cmpgt_ps(a, _mm_setzero_ps()));
+    }
+    template <typename Index>
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static Wide4 load(const void* base, size_t stride, Index index, size_t k) {
+        return load4(base, stride, index(k), index(k + 1), index(k + 2), index(k + 3));
+    }
+    template <typename Index>
+    NYX_FORCEINLINE NYX_TARGET_SSE4 static void store(void* base, size_t stride, Index index, size_t k, Wide4 r) {
+        store4(base, stride, index(k), index(k + 1), index(k + 2), index(k + 3), r);
+    }
+};
+
+#define NYX_KERNEL_TARGET NYX_TARGET_SSE4
+#include "quaternion_kernels.inl"
+#undef NYX_KERNEL_TARGET
+
+} // namespace sse4
+
+namespace avx2 {
+
+// The same for eight at a time
+struct Ops {
+    using V = __m256;
+    using Wide4 = Wide4x256;
+    static constexpr size_t kWidth = 8;
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static V set1(real_t a) { return _mm256_set1_ps(a); }
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static V invLength(V a) {
+        const V one = _mm256_set1_ps(1.0f);
+        return _mm256_blendv_ps(one, _mm256_div_ps(one, _mm256_sqrt_ps(a)), _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ));
+    }
+    template <typename Index>
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static Wide4 load(const void* base, size_t stride, Index index, size_t k) {
+        const size_t i[8] = {index(k), index(k + 1), index(k + 2), index(k + 3), index(k + 4), index(k + 5), index(k + 6), index(k + 7)};
+        return load8(base, stride, i);
+    }
+    template <typename Index>
+    NYX_FORCEINLINE NYX_TARGET_AVX2 static void store(void* base, size_t stride, Index index, size_t k, Wide4 r) {
+        const size_t i[8] = {index(k), index(k + 1), index(k + 2), index(k + 3), index(k + 4), index(k + 5), index(k + 6), index(k + 7)};
+        store8(base, stride, i, r);
+    }
+};
+
+#define NYX_KERNEL_TARGET NYX_TARGET_AVX2
+#include "quaternion_kernels.inl"
+#undef NYX_KERNEL_TARGET
+
+} // namespace avx2
+#endif
+
+// How many leading elements the widest available kernel handled; the caller
+// finishes the rest one at a time
+template <typename Index>
+size_t integrateDispatch([[maybe_unused]] Quaternion* q, [[maybe_unused]] const Vec3* w, [[maybe_unused]] real_t dt,
+                         [[maybe_unused]] Index index, [[maybe_unused]] size_t count) {
+#if defined(NYX_SIMD_DISPATCH)
+    switch (getSimdLevel()) {
+    case SimdLevel::Avx512:
+    case SimdLevel::Avx2:
+        return avx2::integrate(q, w, dt, index, count);
+    case SimdLevel::Sse4:
+        return sse4::integrate(q, w, dt, index, count);
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    return 0;
+}
+
+} // namespace
+
+void rotateMany(const Quaternion* q, const Vec3* v, Vec3* out, size_t count) {
+    size_t k = 0;
+#if defined(NYX_SIMD_DISPATCH)
+    switch (getSimdLevel()) {
+    case SimdLevel::Avx512:
+    case SimdLevel::Avx2:
+        k = avx2::rotate(q, v, out, count);
+        break;
+    case SimdLevel::Sse4:
+        k = sse4::rotate(q, v, out, count);
+        break;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    for (; k < count; ++k)
+        out[k] = q[k] * v[k];
+}
+
+void integrateMany(Quaternion* q, const Vec3* angularVelocities, real_t dt, size_t count) {
+    const size_t k = integrateDispatch(q, angularVelocities, dt, Contiguous{}, count);
+    integrateScalar(q, angularVelocities, dt, Contiguous{}, k, count);
+}
+
+void integrateMany(Quaternion* q, const Vec3* angularVelocities, real_t dt, const uint32_t* indices, size_t count) {
+    const size_t k = integrateDispatch(q, angularVelocities, dt, Indexed{indices}, count);
+    integrateScalar(q, angularVelocities, dt, Indexed{indices}, k, count);
+}
+
+void normalizeMany(Quaternion* q, size_t count) {
+    size_t k = 0;
+#if defined(NYX_SIMD_DISPATCH)
+    switch (getSimdLevel()) {
+    case SimdLevel::Avx512:
+    case SimdLevel::Avx2:
+        k = avx2::normalize(q, count);
+        break;
+    case SimdLevel::Sse4:
+        k = sse4::normalize(q, count);
+        break;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    for (; k < count; ++k)
+        q[k].normalize();
+}
+
+} // namespace nyx
@@ -0,0 +1,80 @@
+// The array kernels of quaternion.cpp, written once against Ops and included
+// once per level inside that level's namespace, with NYX_KERNEL_TARGET naming
+// its target. Each returns how many leading elements it handled, a multiple
+// of Ops::kWidth; the caller finishes the rest one at a time.
+//
+// Quaternions load as {w, x, y, z} and Vec3s as {X, Y, Z, padding}, one
+// register per component. The operations and their order are those of the
+// scalar operators, so every level rounds alike.
+
+using V = Ops::V;
+using Wide4 = Ops::Wide4;
+
+NYX_FORCEINLINE NYX_KERNEL_TARGET void normalizeLanes(Wide4& q) {
+    const V lengthSq = Ops::add(Ops::add(Ops::add(Ops::mul(q.A, q.A), Ops::mul(q.B, q.B)), Ops::mul(q.C, q.C)), Ops::mul(q.D, q.D));
+    const V inv = Ops::invLength(lengthSq);
+    q.A = Ops::mul(q.A, inv);
+    q.B = Ops::mul(q.B, inv);
+    q.C = Ops::mul(q.C, inv);
+    q.D = Ops::mul(q.D, inv);
+}
+
+// cross(a, b) of the first three components; the fourth is b's
+NYX_FORCEINLINE NYX_KERNEL_TARGET Wide4 crossLanes(const Wide4& a, const Wide4& b) {
+    return {Ops::sub(Ops::mul(a.B, b.C), Ops::mul(a.C, b.B)), Ops::sub(Ops::mul(a.C, b.A), Ops::mul(a.A, b.C)),
+            Ops::sub(Ops::mul(a.A, b.B), Ops::mul(a.B, b.A)), b.D};
+}
+
+template <typename Index>
+NYX_KERNEL_TARGET size_t integrate(Quaternion* q, const Vec3* angularVelocities, real_t dt, Index index, size_t count) {
+    const V half = Ops::set1(0.5f);
+    const V hw = Ops::mul(Ops::set1(0.0f), half);
+    const V vDt = Ops::set1(dt);
+    size_t k = 0;
+    for (; k + Ops::kWidth <= count; k += Ops::kWidth) {
+        Wide4 r = Ops::load(q, sizeof(Quaternion), index, k);
+        const Wide4 omega = Ops::load(angularVelocities, sizeof(Vec3), index, k);
+        const V hx = Ops::mul(omega.A, half), hy = Ops::mul(omega.B, half), hz = Ops::mul(omega.C, half);
+        const V pw = Ops::sub(Ops::sub(Ops::sub(Ops::mul(hw, r.A), Ops::mul(hx, r.B)), Ops::mul(hy, r.C)), Ops::mul(hz, r.D));
+        const V px = Ops::sub(Ops::add(Ops::add(Ops::mul(hw, r.B), Ops::mul(hx, r.A)), Ops::mul(hy, r.D)), Ops::mul(hz, r.C));
+        const V py = Ops::add(Ops::add(Ops::sub(Ops::mul(hw, r.C), Ops::mul(hx, r.D)), Ops::mul(hy, r.A)), Ops::mul(hz, r.B));
+        const V pz = Ops::add(Ops::sub(Ops::add(Ops::mul(hw, r.D), Ops::mul(hx, r.C)), Ops::mul(hy, r.B)), Ops::mul(hz, r.A));
+        r.A = Ops::add(r.A, Ops::mul(pw, vDt));
+        r.B = Ops::add(r.B, Ops::mul(px, vDt));
+        r.C = Ops::add(r.C, Ops::mul(py, vDt));
+        r.D = Ops::add(r.D, Ops::mul(pz, vDt));
+        normalizeLanes(r);
+        Ops::store(q, sizeof(Quaternion), index, k, r);
+    }
+    return k;
+}
+
+NYX_KERNEL_TARGET size_t rotate(const Quaternion* q, const Vec3* v, Vec3* out, size_t count) {
+    const V two = Ops::set1(2.0f);
+    size_t k = 0;
+    for (; k + Ops::kWidth <= count; k += Ops::kWidth) {
+        const Wide4 r = Ops::load(q, sizeof(Quaternion), Contiguous{}, k);
+        const Wide4 p = Ops::load(v, sizeof(Vec3), Contiguous{}, k);
+        const Wide4 u{r.B, r.C, r.D, r.A};
+        Wide4 t = crossLanes(u, p);
+        t.A = Ops::mul(t.A, two);
+        t.B = Ops::mul(t.B, two);
+        t.C = Ops::mul(t.C, two);
+        const Wide4 c = crossLanes(u, t);
+        // The padding goes back as it came
+        const Wide4 result{Ops::add(Ops::add(p.A, Ops::mul(t.A, r.A)), c.A), Ops::add(Ops::add(p.B, Ops::mul(t.B, r.A)), c.B),
+                           Ops::add(Ops::add(p.C, Ops::mul(t.C, r.A)), c.C), p.D};
+        Ops::store(out, sizeof(Vec3), Contiguous{}, k, result);
+    }
+    return k;
+}
+
+NYX_KERNEL_TARGET size_t normalize(Quaternion* q, size_t count) {
+    size_t k = 0;
+    for (; k + Ops::kWidth <= count; k += Ops::kWidth) {
+        Wide4 r = Ops::load(q, sizeof(Quaternion), Contiguous{}, k);
+        normalizeLanes(r);
+        Ops::store(q, sizeof(Quaternion), Contiguous{}, k, r);
+    }
+    return k;
+}
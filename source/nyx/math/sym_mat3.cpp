@@ -0,0 +1,82 @@
+#include "nyx/math/sym_mat3.h"
+#include "nyx/core/cpu_features.h"
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+#if defined(NYX_SIMD_DISPATCH)
+// a0 * b0 + a1 * b1 + a2 * b2, added left to right like the scalar code
+NYX_FORCEINLINE NYX_TARGET_AVX2 __m256 dot3(__m256 a0, __m256 b0, __m256 a1, __m256 b1, __m256 a2, __m256 b2) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1)), _mm256_mul_ps(a2, b2));
+}
+
+// Whole batches of eight only; returns how many tensors it rotated
+NYX_TARGET_AVX2 size_t rotateTensorsAvx2(const Quaternion* q, const SymMat3* s, SymMat3* out, const uint32_t* indices, size_t count) {
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vTwo = _mm256_set1_ps(2.0f);
+
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        // Bodies are scattered over the arrays, so they come in one at a time
+        alignas(32) float in[10][8];
+        for (size_t j = 0; j < 8; ++j) {
+            const Quaternion& r = q[indices[k + j]];
+            const SymMat3& t = s[indices[k + j]];
+            in[0][j] = r.w; in[1][j] = r.x; in[2][j] = r.y; in[3][j] = r.z;
+            in[4][j] = t.XX; in[5][j] = t.YY; in[6][j] = t.ZZ; in[7][j] = t.XY; in[8][j] = t.XZ; in[9][j] = t.YZ;
+        }
+        const __m256 w = _mm256_load_ps(in[0]), x = _mm256_load_ps(in[1]), y = _mm256_load_ps(in[2]), z = _mm256_load_ps(in[3]);
+        const __m256 sxx = _mm256_load_ps(in[4]), syy = _mm256_load_ps(in[5]), szz = _mm256_load_ps(in[6]);
+        const __m256 sxy = _mm256_load_ps(in[7]), sxz = _mm256_load_ps(in[8]), syz = _mm256_load_ps(in[9]);
+
+        const __m256 x2 = _mm256_mul_ps(x, vTwo), y2 = _mm256_mul_ps(y, vTwo), z2 = _mm256_mul_ps(z, vTwo);
+        const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        const __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        const __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+        const __m256 r00 = _mm256_sub_ps(vOne, _mm256_add_ps(yy, zz)), r01 = _mm256_sub_ps(xy, wz), r02 = _mm256_add_ps(xz, wy);
+        const __m256 r10 = _mm256_add_ps(xy, wz), r11 = _mm256_sub_ps(vOne, _mm256_add_ps(xx, zz)), r12 = _mm256_sub_ps(yz, wx);
+        const __m256 r20 = _mm256_sub_ps(xz, wy), r21 = _mm256_add_ps(yz, wx), r22 = _mm256_sub_ps(vOne, _mm256_add_ps(xx, yy));
+
+        const __m256 a00 = dot3(r00, sxx, r01, sxy, r02, sxz);
+        const __m256 a01 = dot3(r00, sxy, r01, syy, r02, syz);
+        const __m256 a02 = dot3(r00, sxz, r01, syz, r02, szz);
+        const __m256 a10 = dot3(r10, sxx, r11, sxy, r12, sxz);
+        const __m256 a11 = dot3(r10, sxy, r11, syy, r12, syz);
+        const __m256 a12 = dot3(r10, sxz, r11, syz, r12, szz);
+        const __m256 a20 = dot3(r20, sxx, r21, sxy, r22, sxz);
+        const __m256 a21 = dot3(r20, sxy, r21, syy, r22, syz);
+        const __m256 a22 = dot3(r20, sxz, r21, syz, r22, szz);
+
+        alignas(32) float result[6][8];
+        _mm256_store_ps(result[0], dot3(a00, r00, a01, r01, a02, r02));
+        _mm256_store_ps(result[1], dot3(a10, r10, a11, r11, a12, r12));
+        _mm256_store_ps(result[2], dot3(a20, r20, a21, r21, a22, r22));
+        _mm256_store_ps(result[3], dot3(a00, r10, a01, r11, a02, r12));
+        _mm256_store_ps(result[4], dot3(a00, r20, a01, r21, a02, r22));
+        _mm256_store_ps(result[5], dot3(a10, r20, a11, r21, a12, r22));
+        // The output is packed, so it goes out as whole SymMat3s
+        for (size_t j = 0; j < 8; ++j)
+            out[k + j] = SymMat3(result[0][j], result[1][j], result[2][j], result[3][j], result[4][j], result[5][j]);
+    }
+    return k;
+}
+#endif
+
+} // namespace
+
+void rotateTensors(const Quaternion* q, const SymMat3* s, SymMat3* out, const uint32_t* indices, size_t count) {
+    size_t k = 0;
+#if defined(NYX_SIMD_DISPATCH)
+    if (getSimdLevel() >= SimdLevel::Avx2)
+        k = rotateTensorsAvx2(q, s, out, indices, count);
+#endif
+    for (; k < count; ++k)
+        out[k] = rotateTensor(q[indices[k]], s[indices[k]]);
+}
+
+} // namespace nyx
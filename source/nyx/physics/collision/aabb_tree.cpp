@@ -0,0 +1,500 @@
+#include "nyx/physics/collision/aabb_tree.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace nyx {
+
+namespace {
+
+constexpr uint32_t kSahBinCount = 16;
+// Below this depth the bulk build falls back to median splits, which bounds the height
+constexpr uint32_t kMaxSahDepth = 48;
+constexpr size_t kMinBodiesPerSlice = 1024;
+
+NYX_FORCEINLINE real_t axisOf(const Vec3& v, uint32_t axis) {
+    return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+}
+
+} // namespace
+
+int32_t AabbTree::createProxy(const Aabb& box, uint32_t userData) {
+    const int32_t proxy = allocateNode();
+    Nodes[proxy].Box = box;
+    Nodes[proxy].UserData = userData;
+    Nodes[proxy].Height = 0;
+    insertLeaf(proxy);
+    ++ProxyCount;
+    return proxy;
+}
+
+void AabbTree::destroyProxy(int32_t proxy) {
+    assert(Nodes[proxy].isLeaf() && "Not a proxy");
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --ProxyCount;
+}
+
+bool AabbTree::moveProxy(int32_t proxy, const Aabb& tight, real_t margin) {
+    if (Nodes[proxy].Box.contains(tight))
+        return false;
+
+    removeLeaf(proxy);
+    Nodes[proxy].Box = tight.expanded(margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+void AabbTree::clear() {
+    Nodes.clear();
+    Root = kNullNode;
+    FreeList = kNullNode;
+    ProxyCount = 0;
+}
+
+int32_t AabbTree::allocateNode() {
+    if (FreeList == kNullNode) {
+        Nodes.emplace_back();
+        return static_cast<int32_t>(Nodes.size() - 1);
+    }
+
+    const int32_t node = FreeList;
+    FreeList = Nodes[node].Parent;
+    Nodes[node] = AabbTreeNode();
+    return node;
+}
+
+void AabbTree::freeNode(int32_t node) {
+    Nodes[node].Parent = FreeList;
+    Nodes[node].Height = -1;
+    FreeList = node;
+}
+
+void AabbTree::insertLeaf(int32_t leaf) {
+    if (Root == kNullNode) {
+        Root = leaf;
+        Nodes[leaf].Parent = kNullNode;
+        return;
+    }
+
+    // Walk down towards the sibling with the smallest increase in surface area
+    const Aabb leafBox = Nodes[leaf].Box;
+    int32_t index = Root;
+    while (!Nodes[index].isLeaf()) {
+        const AabbTreeNode& node = Nodes[index];
+        const real_t area = node.Box.surfaceArea();
+        const real_t combinedArea = node.Box.merged(leafBox).surfaceArea();
+
+        // Cost of pairing the leaf with this node, and the cost pushed down to either child
+        const real_t cost = 2.0f * combinedArea;
+        const real_t inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int32_t child) {
+            const Aabb& childBox = Nodes[child].Box;
+            const real_t mergedArea = childBox.merged(leafBox).surfaceArea();
+            return Nodes[child].isLeaf() ? mergedArea + inheritanceCost
+                                         : mergedArea - childBox.surfaceArea() + inheritanceCost;
+        };
+        const real_t costLeft = childCost(node.Left);
+        const real_t costRight = childCost(node.Right);
+
+        if (cost < costLeft && cost < costRight)
+            break;
+        index = costLeft < costRight ? node.Left : node.Right;
+    }
+
+    const int32_t sibling = index;
+    const int32_t oldParent = Nodes[sibling].Parent;
+    const int32_t newParent = allocateNode();
+    Nodes[newParent].Parent = oldParent;
+    Nodes[newParent].Box = leafBox.merged(Nodes[sibling].Box);
+    Nodes[newParent].Height = Nodes[sibling].Height + 1;
+    Nodes[newParent].Left = sibling;
+    Nodes[newParent].Right = leaf;
+    Nodes[sibling].Parent = newParent;
+    Nodes[leaf].Parent = newParent;
+
+    if (oldParent == kNullNode) {
+        Root = newParent;
+    } else if (Nodes[oldParent].Left == sibling) {
+        Nodes[oldParent].Left = newParent;
+    } else {
+        Nodes[oldParent].Right = newParent;
+    }
+
+    refitUpwards(Nodes[leaf].Parent);
+}
+
+void AabbTree::removeLeaf(int32_t leaf) {
+    if (leaf == Root) {
+        Root = kNullNode;
+        return;
+    }
+
+    const int32_t parent = Nodes[leaf].Parent;
+    const int32_t grandParent = Nodes[parent].Parent;
+    const int32_t sibling = Nodes[parent].Left == leaf ? Nodes[parent].Right : Nodes[parent].Left;
+
+    if (grandParent == kNullNode) {
+        Root = sibling;
+        Nodes[sibling].Parent = kNullNode;
+        freeNode(parent);
+        return;
+    }
+
+    if (Nodes[grandParent].Left == parent)
+        Nodes[grandParent].Left = sibling;
+    else
+        Nodes[grandParent].Right = sibling;
+    Nodes[sibling].Parent = grandParent;
+    freeNode(parent);
+
+    refitUpwards(grandParent);
+}
+
+void AabbTree::refitUpwards(int32_t index) {
+    while (index != kNullNode) {
+        index = balance(index);
+
+        AabbTreeNode& node = Nodes[index];
+        node.Height = 1 + std::max(Nodes[node.Left].Height, Nodes[node.Right].Height);
+        node.Box = Nodes[node.Left].Box.merged(Nodes[node.Right].Box);
+        index = node.Parent;
+    }
+}
+
+// Rotate the taller grandchild up when the children of a differ in height by more than one
+int32_t AabbTree::balance(int32_t iA) {
+    AabbTreeNode& a = Nodes[iA];
+    if (a.isLeaf() || a.Height < 2)
+        return iA;
+
+    const int32_t iB = a.Left;
+    const int32_t iC = a.Right;
+    AabbTreeNode& b = Nodes[iB];
+    AabbTreeNode& c = Nodes[iC];
+    const int32_t heightDiff = c.Height - b.Height;
+
+    auto replaceChild = [&](int32_t parent, int32_t oldChild, int32_t newChild) {
+        if (parent == kNullNode)
+            Root = newChild;
+        else if (Nodes[parent].Left == oldChild)
+            Nodes[parent].Left = newChild;
+        else
+            Nodes[parent].Right = newChild;
+    };
+
+    // Rotate c up
+    if (heightDiff > 1) {
+        const int32_t iF = c.Left;
+        const int32_t iG = c.Right;
+        AabbTreeNode& f = Nodes[iF];
+        AabbTreeNode& g = Nodes[iG];
+
+        c.Left = iA;
+        c.Parent = a.Parent;
+        a.Parent = iC;
+        replaceChild(c.Parent, iA, iC);
+
+        if (f.Height > g.Height) {
+            c.Right = iF;
+            a.Right = iG;
+            g.Parent = iA;
+            a.Box = b.Box.merged(g.Box);
+            c.Box = a.Box.merged(f.Box);
+            a.Height = 1 + std::max(b.Height, g.Height);
+            c.Height = 1 + std::max(a.Height, f.Height);
+        } else {
+            c.Right = iG;
+            a.Right = iF;
+            f.Parent = iA;
+            a.Box = b.Box.merged(f.Box);
+            c.Box = a.Box.merged(g.Box);
+            a.Height = 1 + std::max(b.Height, f.Height);
+            c.Height = 1 + std::max(a.Height, g.Height);
+        }
+        return iC;
+    }
+
+    // Rotate b up
+    if (heightDiff < -1) {
+        const int32_t iD = b.Left;
+        const int32_t iE = b.Right;
+        AabbTreeNode& d = Nodes[iD];
+        AabbTreeNode& e = Nodes[iE];
+
+        b.Left = iA;
+        b.Parent = a.Parent;
+        a.Parent = iB;
+        replaceChild(b.Parent, iA, iB);
+
+        if (d.Height > e.Height) {
+            b.Right = iD;
+            a.Left = iE;
+            e.Parent = iA;
+            a.Box = c.Box.merged(e.Box);
+            b.Box = a.Box.merged(d.Box);
+            a.Height = 1 + std::max(c.Height, e.Height);
+            b.Height = 1 + std::max(a.Height, d.Height);
+        } else {
+            b.Right = iE;
+            a.Left = iD;
+            d.Parent = iA;
+            a.Box = c.Box.merged(d.Box);
+            b.Box = a.Box.merged(e.Box);
+            a.Height = 1 + std::max(c.Height, d.Height);
+            b.Height = 1 + std::max(a.Height, e.Height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void AabbTree::build(const Aabb* boxes, const uint32_t* userData, size_t count, int32_t* proxies) {
+    clear();
+    if (count == 0)
+        return;
+
+    Nodes.reserve(2 * count - 1);
+    BuildIndices.resize(count);
+    std::iota(BuildIndices.begin(), BuildIndices.end(), 0u);
+    BuildCenters.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        BuildCenters[i] = boxes[i].center();
+
+    Root = buildRange(boxes, userData, proxies, BuildIndices.data(), 0, count, kNullNode, 0);
+    ProxyCount = count;
+}
+
+int32_t AabbTree::buildRange(const Aabb* boxes, const uint32_t* userData, int32_t* proxies,
+                             uint32_t* indices, size_t begin, size_t end, int32_t parent, uint32_t depth) {
+    const int32_t node = allocateNode();
+    Nodes[node].Parent = parent;
+
+    if (end - begin == 1) {
+        const uint32_t entry = indices[begin];
+        Nodes[node].Box = boxes[entry];
+        Nodes[node].UserData = userData[entry];
+        proxies[entry] = node;
+        return node;
+    }
+
+    // Split along the axis with the largest spread of centers
+    Vec3 centerMin = BuildCenters[indices[begin]];
+    Vec3 centerMax = centerMin;
+    for (size_t i = begin + 1; i < end; ++i) {
+        const Vec3& c = BuildCenters[indices[i]];
+        centerMin = Vec3(std::min(centerMin.X, c.X), std::min(centerMin.Y, c.Y), std::min(centerMin.Z, c.Z));
+        centerMax = Vec3(std::max(centerMax.X, c.X), std::max(centerMax.Y, c.Y), std::max(centerMax.Z, c.Z));
+    }
+    const Vec3 extent = centerMax - centerMin;
+    const uint32_t axis = extent.X >= extent.Y && extent.X >= extent.Z ? 0 : (extent.Y >= extent.Z ? 1 : 2);
+    const real_t axisMin = axisOf(centerMin, axis);
+    const real_t axisExtent = axisOf(extent, axis);
+
+    size_t mid = begin;
+    if (axisExtent > 0.0f && depth < kMaxSahDepth) {
+        // Binned SAH: cost of a split is area * count summed over both sides
+        const real_t binScale = kSahBinCount / axisExtent;
+        auto binOf = [&](uint32_t entry) {
+            const uint32_t bin = static_cast<uint32_t>((axisOf(BuildCenters[entry], axis) - axisMin) * binScale);
+            return std::min(bin, kSahBinCount - 1);
+        };
+
+        Aabb binBoxes[kSahBinCount];
+        size_t binCounts[kSahBinCount] = {};
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t entry = indices[i];
+            const uint32_t bin = binOf(entry);
+            binBoxes[bin] = binCounts[bin] ? binBoxes[bin].merged(boxes[entry]) : boxes[entry];
+            ++binCounts[bin];
+        }
+
+        real_t rightCosts[kSahBinCount];
+        Aabb rightBox;
+        size_t rightCount = 0;
+        for (uint32_t bin = kSahBinCount - 1; bin > 0; --bin) {
+            if (binCounts[bin]) {
+                rightBox = rightCount ? rightBox.merged(binBoxes[bin]) : binBoxes[bin];
+                rightCount += binCounts[bin];
+            }
+            rightCosts[bin] = rightCount ? rightBox.surfaceArea() * real_t(rightCount) : 0.0f;
+        }
+
+        real_t bestCost = 0.0f;
+        uint32_t bestSplit = 0; // bins [0, bestSplit) go left
+        Aabb leftBox;
+        size_t leftCount = 0;
+        for (uint32_t bin = 0; bin + 1 < kSahBinCount; ++bin) {
+            if (binCounts[bin]) {
+                leftBox = leftCount ? leftBox.merged(binBoxes[bin]) : binBoxes[bin];
+                leftCount += binCounts[bin];
+            }
+            if (leftCount == 0 || leftCount == end - begin) continue;
+
+            const real_t cost = leftBox.surfaceArea() * real_t(leftCount) + rightCosts[bin + 1];
+            if (bestSplit == 0 || cost < bestCost) {
+                bestCost = cost;
+                bestSplit = bin + 1;
+            }
+        }
+
+        if (bestSplit != 0) {
+            mid = std::partition(indices + begin, indices + end,
+                                 [&](uint32_t entry) { return binOf(entry) < bestSplit; }) - indices;
+        }
+    }
+
+    // Coincident centers or too deep: split at the median
+    if (mid == begin || mid == end) {
+        mid = begin + (end - begin) / 2;
+        std::nth_element(indices + begin, indices + mid, indices + end, [&](uint32_t a, uint32_t b) {
+            return axisOf(BuildCenters[a], axis) < axisOf(BuildCenters[b], axis);
+        });
+    }
+
+    const int32_t left = buildRange(boxes, userData, proxies, indices, begin, mid, node, depth + 1);
+    const int32_t right = buildRange(boxes, userData, proxies, indices, mid, end, node, depth + 1);
+
+    AabbTreeNode& n = Nodes[node];
+    n.Left = left;
+    n.Right = right;
+    n.Height = 1 + std::max(Nodes[left].Height, Nodes[right].Height);
+    n.Box = Nodes[left].Box.merged(Nodes[right].Box);
+    return node;
+}
+
+void AabbTree::refit() {
+    // Meant for bulk built trees, where children always come after their parent
+    // in Nodes, so a single reverse sweep refits bottom-up
+    for (size_t i = Nodes.size(); i-- > 0;) {
+        AabbTreeNode& node = Nodes[i];
+        if (node.Height <= 0) continue;
+        node.Box = Nodes[node.Left].Box.merged(Nodes[node.Right].Box);
+    }
+}
+
+void AabbTreeBroadphase::update(const RigidbodyData& data, JobSystem* jobs) {
+    syncProxies(data);
+
+    const AabbLanes& bounds = data.getBounds();
+    const LaneVector<uint32_t>& awake = data.getAwakeBodies();
+    const size_t count = awake.size();
+
+    // Only awake bodies query; pairs of two awake bodies are reported by the lower index
+    parallelCollect(jobs, count, kMinBodiesPerSlice, SlicePairs, Pairs, [&](size_t begin, size_t end, std::vector<BodyPair>& out) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t body = awake[k];
+            const Aabb box = bounds.get(body);
+            DynamicTree.query(box, [&](uint32_t other) {
+                if (other != body && (other > body || !data.isAwake(other)) && bounds.overlaps(body, other))
+                    out.push_back(makeBodyPair(body, other));
+                return true;
+            });
+            StaticTree.query(box, [&](uint32_t other) {
+                if (bounds.overlaps(body, other))
+                    out.push_back(makeBodyPair(body, other));
+                return true;
+            });
+        }
+    });
+}
+
+void AabbTreeBroadphase::removeBody(uint32_t body, uint32_t last) {
+    if (body >= Proxies.size())
+        return;
+
+    if (Proxies[body] != kNullNode) {
+        if (InStaticTree[body]) {
+            // Bulk built leaves stay until the next rebuild; an inverted box keeps
+            // this one out of every query and ray until then
+            const real_t inf = std::numeric_limits<real_t>::infinity();
+            StaticTree.setLeafBox(Proxies[body], Aabb{Vec3(inf, inf, inf), Vec3(-inf, -inf, -inf)});
+            StaticStale = true;
+        } else {
+            DynamicTree.destroyProxy(Proxies[body]);
+        }
+    }
+
+    // The moved body keeps its leaf, which now reports its new index
+    if (last < Proxies.size() && last != body) {
+        Proxies[body] = Proxies[last];
+        InStaticTree[body] = InStaticTree[last];
+        if (Proxies[body] != kNullNode)
+            (InStaticTree[body] ? StaticTree : DynamicTree).setUserData(Proxies[body], body);
+    } else {
+        Proxies[body] = kNullNode;
+        InStaticTree[body] = 0;
+    }
+    if (last < Proxies.size()) {
+        Proxies.pop_back();
+        InStaticTree.pop_back();
+    }
+}
+
+void AabbTreeBroadphase::syncProxies(const RigidbodyData& data) {
+    const AabbLanes& bounds = data.getBounds();
+    const LaneVector<uint32_t>& active = data.getActive();
+    const size_t count = bounds.size();
+
+    // Body indices no longer line up with the proxies; start over
+    if (Proxies.size() > count) {
+        DynamicTree.clear();
+        StaticTree.clear();
+        Proxies.clear();
+        InStaticTree.clear();
+    }
+    Proxies.resize(count, kNullNode);
+    InStaticTree.resize(count, 0);
+
+    bool staticChanged = StaticStale;
+    bool staticMoved = false;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t body = static_cast<uint32_t>(i);
+        const bool isStatic = !active[i];
+        const Aabb box = bounds.get(i);
+
+        if (Proxies[i] == kNullNode || InStaticTree[i] != isStatic) {
+            if (Proxies[i] != kNullNode && !InStaticTree[i])
+                DynamicTree.destroyProxy(Proxies[i]);
+
+            staticChanged |= isStatic || InStaticTree[i];
+            InStaticTree[i] = isStatic;
+            Proxies[i] = isStatic ? kNullNode : DynamicTree.createProxy(box.expanded(Margin), body);
+        } else if (!isStatic) {
+            DynamicTree.moveProxy(Proxies[i], box, Margin);
+        } else if (!StaticTree.getFatAabb(Proxies[i]).contains(box) || !box.contains(StaticTree.getFatAabb(Proxies[i]))) {
+            StaticTree.setLeafBox(Proxies[i], box);
+            staticMoved = true;
+        }
+    }
+
+    if (staticChanged) {
+        rebuildStaticTree(data);
+        StaticStale = false;
+    }
+    else if (staticMoved)
+        StaticTree.refit();
+}
+
+void AabbTreeBroadphase::rebuildStaticTree(const RigidbodyData& data) {
+    const AabbLanes& bounds = data.getBounds();
+
+    StaticBoxes.clear();
+    StaticBodies.clear();
+    for (size_t i = 0; i < InStaticTree.size(); ++i) {
+        if (!InStaticTree[i]) continue;
+        StaticBoxes.push_back(bounds.get(i));
+        StaticBodies.push_back(static_cast<uint32_t>(i));
+    }
+
+    StaticProxies.resize(StaticBodies.size());
+    StaticTree.build(StaticBoxes.data(), StaticBodies.data(), StaticBodies.size(), StaticProxies.data());
+    for (size_t k = 0; k < StaticBodies.size(); ++k)
+        Proxies[StaticBodies[k]] = StaticProxies[k];
+}
+
+} // namespace nyx
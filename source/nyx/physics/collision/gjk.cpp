@@ -0,0 +1,584 @@
+#include "nyx/physics/collision/gjk.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+constexpr uint32_t kGjkMaxIterations = 32;
+// Stop once a support point gets v this much closer, relative to |v|^2
+constexpr real_t kGjkRelativeTolerance = 1e-5f;
+// |v|^2 below this fraction of the simplex's squared extent counts as touching
+constexpr real_t kGjkOverlapTolerance = 1e-8f;
+// Squared tetrahedron volume below this fraction of its longest edge^6 counts as flat
+constexpr real_t kFlatTolerance = 1e-10f;
+
+constexpr uint32_t kEpaMaxVertices = 64;
+constexpr uint32_t kEpaMaxFaces = 128;
+constexpr uint32_t kEpaMaxIterations = 48;
+constexpr real_t kEpaTolerance = 1e-4f;
+constexpr real_t kDegenerateTolerance = 1e-6f;
+
+NYX_FORCEINLINE GjkVertex supportVertex(const GjkProxy& a, const GjkProxy& b, const Vec3& direction) {
+    const Vec3 pa = a.support(direction);
+    const Vec3 pb = b.support(-direction);
+    return GjkVertex{pa - pb, pa, pb};
+}
+
+// Barycentric weights of the point of segment ab closest to the origin
+NYX_FORCEINLINE void closestOnSegment(const Vec3& a, const Vec3& b, real_t weights[2]) {
+    const Vec3 ab = b - a;
+    const real_t t = -dot(a, ab);
+    const real_t denom = dot(ab, ab);
+    if (t <= 0.0f || denom <= 0.0f) {
+        weights[0] = 1.0f; weights[1] = 0.0f;
+    } else if (t >= denom) {
+        weights[0] = 0.0f; weights[1] = 1.0f;
+    } else {
+        weights[1] = t / denom;
+        weights[0] = 1.0f - weights[1];
+    }
+}
+
+// Barycentric weights of the point of triangle abc closest to the origin, by Voronoi regions
+void closestOnTriangle(const Vec3& a, const Vec3& b, const Vec3& c, real_t weights[3]) {
+    const Vec3 ab = b - a, ac = c - a;
+
+    const real_t d1 = -dot(ab, a), d2 = -dot(ac, a);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        weights[0] = 1.0f; weights[1] = 0.0f; weights[2] = 0.0f;
+        return;
+    }
+
+    const real_t d3 = -dot(ab, b), d4 = -dot(ac, b);
+    if (d3 >= 0.0f && d4 <= d3) {
+        weights[0] = 0.0f; weights[1] = 1.0f; weights[2] = 0.0f;
+        return;
+    }
+
+    const real_t vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        const real_t v = d1 / (d1 - d3);
+        weights[0] = 1.0f - v; weights[1] = v; weights[2] = 0.0f;
+        return;
+    }
+
+    const real_t d5 = -dot(ab, c), d6 = -dot(ac, c);
+    if (d6 >= 0.0f && d5 <= d6) {
+        weights[0] = 0.0f; weights[1] = 0.0f; weights[2] = 1.0f;
+        return;
+    }
+
+    const real_t vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        const real_t w = d2 / (d2 - d6);
+        weights[0] = 1.0f - w; weights[1] = 0.0f; weights[2] = w;
+        return;
+    }
+
+    const real_t va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        const real_t w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        weights[0] = 0.0f; weights[1] = 1.0f - w; weights[2] = w;
+        return;
+    }
+
+    const real_t sum = va + vb + vc;
+    if (sum <= 0.0f) {
+        // Degenerate triangle; its longest edge covers it
+        const Vec3 bc = c - b;
+        const real_t lab = dot(ab, ab), lac = dot(ac, ac), lbc = dot(bc, bc);
+        real_t edge[2];
+        weights[0] = weights[1] = weights[2] = 0.0f;
+        if (lab >= lac && lab >= lbc) {
+            closestOnSegment(a, b, edge);
+            weights[0] = edge[0]; weights[1] = edge[1];
+        } else if (lac >= lbc) {
+            closestOnSegment(a, c, edge);
+            weights[0] = edge[0]; weights[2] = edge[1];
+        } else {
+            closestOnSegment(b, c, edge);
+            weights[1] = edge[0]; weights[2] = edge[1];
+        }
+        return;
+    }
+
+    const real_t inv = 1.0f / sum;
+    weights[1] = vb * inv;
+    weights[2] = vc * inv;
+    weights[0] = 1.0f - weights[1] - weights[2];
+}
+
+// Drops the vertices that do not support the closest point
+void compactSimplex(GjkSimplex& simplex) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < simplex.Count; ++i) {
+        if (simplex.Weights[i] > 0.0f) {
+            simplex.Vertices[count] = simplex.Vertices[i];
+            simplex.Weights[count] = simplex.Weights[i];
+            ++count;
+        }
+    }
+    simplex.Count = count;
+}
+
+// Reduces the simplex to the feature closest to the origin. Returns false when
+// the tetrahedron contains the origin.
+bool solveSimplex(GjkSimplex& simplex) {
+    GjkVertex* v = simplex.Vertices;
+    real_t* weights = simplex.Weights;
+
+    switch (simplex.Count) {
+    case 1:
+        weights[0] = 1.0f;
+        break;
+    case 2:
+        closestOnSegment(v[0].W, v[1].W, weights);
+        break;
+    case 3:
+        closestOnTriangle(v[0].W, v[1].W, v[2].W, weights);
+        break;
+    case 4: {
+        static constexpr uint32_t kFaces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+        real_t bestDistance = std::numeric_limits<real_t>::max();
+        real_t bestWeights[4] = {};
+        bool outside = false;
+
+        // A nearly flat tetrahedron has no reliable sides, so every face is tried
+        real_t extent = 0.0f;
+        for (uint32_t i = 1; i < 4; ++i)
+            extent = std::max(extent, dot(v[i].W - v[0].W, v[i].W - v[0].W));
+        const real_t volume = dot(cross(v[1].W - v[0].W, v[2].W - v[0].W), v[3].W - v[0].W);
+        const bool flat = volume * volume <= kFlatTolerance * extent * extent * extent;
+
+        for (const uint32_t* face : kFaces) {
+            const Vec3& a = v[face[0]].W;
+            const Vec3 n = cross(v[face[1]].W - a, v[face[2]].W - a);
+
+            // The origin only needs this face if it lies on the other side of it than the fourth vertex
+            if (!flat && -dot(n, a) * dot(n, v[face[3]].W - a) >= 0.0f)
+                continue;
+
+            real_t faceWeights[3];
+            closestOnTriangle(a, v[face[1]].W, v[face[2]].W, faceWeights);
+            const Vec3 p = a * faceWeights[0] + v[face[1]].W * faceWeights[1] + v[face[2]].W * faceWeights[2];
+            const real_t distance = dot(p, p);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                std::fill(bestWeights, bestWeights + 4, 0.0f);
+                for (uint32_t i = 0; i < 3; ++i)
+                    bestWeights[face[i]] = faceWeights[i];
+            }
+            outside = true;
+        }
+
+        if (!outside)
+            return false;
+        std::copy(bestWeights, bestWeights + 4, weights);
+        break;
+    }
+    default:
+        break;
+    }
+
+    compactSimplex(simplex);
+    return true;
+}
+
+NYX_FORCEINLINE Vec3 closestPoint(const GjkSimplex& simplex) {
+    Vec3 p(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < simplex.Count; ++i)
+        p += simplex.Vertices[i].W * simplex.Weights[i];
+    return p;
+}
+
+// Polytope faces as lanes, so finding the closest face and the faces a new
+// vertex sees are four faces per instruction. Removed faces, and the padding
+// up to the next multiple of four, have an infinite offset and distance: no
+// point is in front of them and they are never the closest.
+struct EpaFaces {
+    alignas(16) real_t NormalX[kEpaMaxFaces];
+    alignas(16) real_t NormalY[kEpaMaxFaces];
+    alignas(16) real_t NormalZ[kEpaMaxFaces];
+    alignas(16) real_t Offset[kEpaMaxFaces];   // dot(normal, first vertex)
+    alignas(16) real_t Distance[kEpaMaxFaces]; // offset clamped to 0, real_t max for slivers
+    uint32_t Index[kEpaMaxFaces][3];
+    uint32_t Count = 0;
+};
+
+constexpr real_t kRemovedFace = std::numeric_limits<real_t>::infinity();
+
+NYX_FORCEINLINE void removeFace(EpaFaces& faces, uint32_t f) {
+    faces.NormalX[f] = faces.NormalY[f] = faces.NormalZ[f] = 0.0f;
+    faces.Offset[f] = faces.Distance[f] = kRemovedFace;
+}
+
+NYX_FORCEINLINE bool isRemoved(const EpaFaces& faces, uint32_t f) {
+    return faces.Distance[f] == kRemovedFace;
+}
+
+// First face with the smallest distance
+uint32_t closestFaceScalar(const EpaFaces& faces) {
+    uint32_t best = 0;
+    for (uint32_t f = 1; f < faces.Count; ++f) {
+        if (faces.Distance[f] < faces.Distance[best])
+            best = f;
+    }
+    return best;
+}
+
+// Faces w lies in front of, ascending; returns how many
+uint32_t visibleFacesScalar(const EpaFaces& faces, const Vec3& w, uint32_t* visible) {
+    uint32_t count = 0;
+    for (uint32_t f = 0; f < faces.Count; ++f) {
+        if (faces.NormalX[f] * w.X + faces.NormalY[f] * w.Y + faces.NormalZ[f] * w.Z > faces.Offset[f])
+            visible[count++] = f;
+    }
+    return count;
+}
+
+#if defined(NYX_SIMD_DISPATCH)
+NYX_TARGET_SSE4 uint32_t closestFaceSse4(const EpaFaces& faces) {
+    __m128 bestDistance = _mm_set1_ps(kRemovedFace);
+    __m128i bestIndex = _mm_setzero_si128();
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+    for (uint32_t f = 0; f < faces.Count; f += 4) {
+        const __m128 d = _mm_load_ps(faces.Distance + f);
+        const __m128 closer = _mm_cmplt_ps(d, bestDistance);
+        bestDistance = _mm_blendv_ps(bestDistance, d, closer);
+        bestIndex = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(bestIndex), _mm_castsi128_ps(index), closer));
+        index = _mm_add_epi32(index, step);
+    }
+
+    alignas(16) float distances[4];
+    alignas(16) uint32_t indices[4];
+    _mm_store_ps(distances, bestDistance);
+    _mm_store_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+    uint32_t best = 0;
+    for (uint32_t lane = 1; lane < 4; ++lane) {
+        if (distances[lane] < distances[best] || (distances[lane] == distances[best] && indices[lane] < indices[best]))
+            best = lane;
+    }
+    return indices[best];
+}
+
+NYX_TARGET_SSE4 uint32_t visibleFacesSse4(const EpaFaces& faces, const Vec3& w, uint32_t* visible) {
+    const __m128 wx = _mm_set1_ps(w.X), wy = _mm_set1_ps(w.Y), wz = _mm_set1_ps(w.Z);
+    uint32_t count = 0;
+    for (uint32_t f = 0; f < faces.Count; f += 4) {
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(faces.NormalX + f), wx), _mm_mul_ps(_mm_load_ps(faces.NormalY + f), wy)),
+                                    _mm_mul_ps(_mm_load_ps(faces.NormalZ + f), wz));
+        uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(d, _mm_load_ps(faces.Offset + f))));
+        for (; bits; bits &= bits - 1)
+            visible[count++] = f + std::countr_zero(bits);
+    }
+    return count;
+}
+#endif
+
+struct EpaEdge {
+    uint32_t A, B;
+};
+
+// Grows a lower dimensional simplex into a tetrahedron so EPA has a volume to expand
+bool completeSimplex(const GjkProxy& a, const GjkProxy& b, GjkVertex* vertices, uint32_t& count) {
+    static const Vec3 kAxes[6] = {Vec3(1, 0, 0), Vec3(-1, 0, 0), Vec3(0, 1, 0), Vec3(0, -1, 0), Vec3(0, 0, 1), Vec3(0, 0, -1)};
+
+    if (count == 1) {
+        for (const Vec3& axis : kAxes) {
+            const GjkVertex w = supportVertex(a, b, axis);
+            const Vec3 d = w.W - vertices[0].W;
+            if (dot(d, d) > kDegenerateTolerance * kDegenerateTolerance) {
+                vertices[count++] = w;
+                break;
+            }
+        }
+        if (count < 2) return false;
+    }
+
+    if (count == 2) {
+        const Vec3 d = vertices[1].W - vertices[0].W;
+        const Vec3 ad(std::abs(d.X), std::abs(d.Y), std::abs(d.Z));
+        const Vec3 axis = ad.X <= ad.Y && ad.X <= ad.Z ? Vec3(1, 0, 0) : (ad.Y <= ad.Z ? Vec3(0, 1, 0) : Vec3(0, 0, 1));
+        const Vec3 n1 = cross(d, axis);
+        const Vec3 n2 = cross(d, n1);
+        for (const Vec3& direction : {n1, -n1, n2, -n2}) {
+            const GjkVertex w = supportVertex(a, b, direction);
+            const Vec3 offLine = cross(d, w.W - vertices[0].W);
+            if (dot(offLine, offLine) > kDegenerateTolerance * kDegenerateTolerance * dot(d, d)) {
+                vertices[count++] = w;
+                break;
+            }
+        }
+        if (count < 3) return false;
+    }
+
+    if (count == 3) {
+        const Vec3 n = cross(vertices[1].W - vertices[0].W, vertices[2].W - vertices[0].W);
+        const real_t nLength = n.length();
+        for (const Vec3& direction : {n, -n}) {
+            const GjkVertex w = supportVertex(a, b, direction);
+            if (std::abs(dot(n, w.W - vertices[0].W)) > kDegenerateTolerance * nLength) {
+                vertices[count++] = w;
+                break;
+            }
+        }
+        if (count < 4) return false;
+    }
+
+    const real_t volume = dot(cross(vertices[1].W - vertices[0].W, vertices[2].W - vertices[0].W), vertices[3].W - vertices[0].W);
+    return std::abs(volume) > kDegenerateTolerance * kDegenerateTolerance * kDegenerateTolerance;
+}
+
+} // namespace
+
+GjkProxy::GjkProxy(const ShapeStore& shapes, ShapeHandle shape, const ShapeTransform& xf)
+    : Shapes(&shapes), Shape(shape), Xf(xf), Radius(0.0f) {
+    if (shape.Type == ShapeType::Sphere)
+        Radius = shapes.getSphere(shape.Index).Radius;
+    else if (shape.Type == ShapeType::Capsule)
+        Radius = shapes.getCapsule(shape.Index).Radius;
+}
+
+Vec3 GjkProxy::support(const Vec3& direction) const {
+    switch (Shape.Type) {
+    case ShapeType::Box: {
+        const Vec3& e = Shapes->getBox(Shape.Index).HalfExtents;
+        const Vec3 d = Xf.inverseRotate(direction);
+        return Xf.toWorld(Vec3(d.X >= 0.0f ? e.X : -e.X, d.Y >= 0.0f ? e.Y : -e.Y, d.Z >= 0.0f ? e.Z : -e.Z));
+    }
+    case ShapeType::Capsule: {
+        const real_t h = Shapes->getCapsule(Shape.Index).HalfHeight;
+        return Xf.Position + Xf.Axis[1] * (dot(Xf.Axis[1], direction) >= 0.0f ? h : -h);
+    }
+    case ShapeType::Convex:
+        return Xf.toWorld(Shapes->hullSupport(Shapes->getConvex(Shape.Index), Xf.inverseRotate(direction)));
+    default:
+        return Xf.Position; // spheres are a point
+    }
+}
+
+bool gjkClosestPoints(const GjkProxy& a, const GjkProxy& b, GjkSimplex& simplex, Vec3& pointA, Vec3& pointB) {
+    Vec3 direction = b.Xf.Position - a.Xf.Position;
+    if (dot(direction, direction) == 0.0f)
+        direction = Vec3(1.0f, 0.0f, 0.0f);
+
+    simplex.Vertices[0] = supportVertex(a, b, direction);
+    simplex.Weights[0] = 1.0f;
+    simplex.Count = 1;
+    Vec3 v = simplex.Vertices[0].W;
+
+    for (uint32_t iteration = 0; iteration < kGjkMaxIterations; ++iteration) {
+        const real_t vv = dot(v, v);
+
+        real_t extent = 0.0f;
+        for (uint32_t i = 0; i < simplex.Count; ++i)
+            extent = std::max(extent, dot(simplex.Vertices[i].W, simplex.Vertices[i].W));
+        if (vv <= kGjkOverlapTolerance * extent)
+            return false;
+
+        const GjkVertex w = supportVertex(a, b, -v);
+        if (vv - dot(v, w.W) <= kGjkRelativeTolerance * vv)
+            break;
+
+        bool repeated = false;
+        for (uint32_t i = 0; i < simplex.Count; ++i)
+            repeated |= simplex.Vertices[i].W == w.W;
+        if (repeated)
+            break;
+
+        simplex.Vertices[simplex.Count++] = w;
+        if (!solveSimplex(simplex))
+            return false;
+
+        const Vec3 next = closestPoint(simplex);
+        const bool progressed = dot(next, next) < vv;
+        v = next;
+        if (!progressed)
+            break;
+    }
+
+    pointA = Vec3(0.0f, 0.0f, 0.0f);
+    pointB = Vec3(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < simplex.Count; ++i) {
+        pointA += simplex.Vertices[i].A * simplex.Weights[i];
+        pointB += simplex.Vertices[i].B * simplex.Weights[i];
+    }
+    return true;
+}
+
+bool epaPenetration(const GjkProxy& a, const GjkProxy& b, const GjkSimplex& simplex,
+                    Vec3& normal, real_t& depth, Vec3& pointA, Vec3& pointB) {
+    GjkVertex vertices[kEpaMaxVertices];
+    uint32_t vertexCount = simplex.Count;
+    std::copy(simplex.Vertices, simplex.Vertices + simplex.Count, vertices);
+    if (!completeSimplex(a, b, vertices, vertexCount))
+        return false;
+
+#if defined(NYX_SIMD_DISPATCH)
+    const bool sse4 = getSimdLevel() >= SimdLevel::Sse4;
+    auto closestFace = [&](const EpaFaces& faces) { return sse4 ? closestFaceSse4(faces) : closestFaceScalar(faces); };
+    auto visibleFaces = [&](const EpaFaces& faces, const Vec3& w, uint32_t* visible) {
+        return sse4 ? visibleFacesSse4(faces, w, visible) : visibleFacesScalar(faces, w, visible);
+    };
+#else
+    auto closestFace = [](const EpaFaces& faces) { return closestFaceScalar(faces); };
+    auto visibleFaces = [](const EpaFaces& faces, const Vec3& w, uint32_t* visible) { return visibleFacesScalar(faces, w, visible); };
+#endif
+
+    // The polytope only grows, so the first tetrahedron's centre stays inside and orients every face
+    const Vec3 interior = (vertices[0].W + vertices[1].W + vertices[2].W + vertices[3].W) * 0.25f;
+
+    EpaFaces faces;
+    auto makeFace = [&](uint32_t f, uint32_t i0, uint32_t i1, uint32_t i2) {
+        const Vec3& p0 = vertices[i0].W;
+        Vec3 n = cross(vertices[i1].W - p0, vertices[i2].W - p0);
+        if (dot(n, p0 - interior) < 0.0f) {
+            std::swap(i1, i2);
+            n = -n;
+        }
+        faces.Index[f][0] = i0; faces.Index[f][1] = i1; faces.Index[f][2] = i2;
+
+        const real_t length = n.length();
+        if (length <= 0.0f) {
+            // A sliver can never be the closest face, nor be seen
+            faces.NormalX[f] = faces.NormalY[f] = faces.NormalZ[f] = 0.0f;
+            faces.Offset[f] = 0.0f;
+            faces.Distance[f] = std::numeric_limits<real_t>::max();
+            return;
+        }
+        n = n * (1.0f / length);
+        faces.NormalX[f] = n.X; faces.NormalY[f] = n.Y; faces.NormalZ[f] = n.Z;
+        faces.Offset[f] = dot(n, p0);
+        faces.Distance[f] = std::max(faces.Offset[f], real_t(0));
+    };
+
+    faces.Count = 4;
+    makeFace(0, 0, 1, 2);
+    makeFace(1, 0, 3, 1);
+    makeFace(2, 0, 2, 3);
+    makeFace(3, 1, 3, 2);
+
+    uint32_t visible[kEpaMaxFaces];
+    EpaEdge horizon[kEpaMaxFaces * 3];
+    for (uint32_t iteration = 0; iteration < kEpaMaxIterations; ++iteration) {
+        const uint32_t closest = closestFace(faces);
+        if (faces.Distance[closest] >= std::numeric_limits<real_t>::max())
+            return false;
+
+        const Vec3 direction(faces.NormalX[closest], faces.NormalY[closest], faces.NormalZ[closest]);
+        const GjkVertex w = supportVertex(a, b, direction);
+        if (dot(w.W, direction) - faces.Distance[closest] <= kEpaTolerance || vertexCount == kEpaMaxVertices)
+            break;
+
+        const uint32_t newIndex = vertexCount;
+        vertices[vertexCount++] = w;
+
+        // Remove every face the new vertex sees; the edges they share with kept faces form the horizon
+        const uint32_t visibleCount = visibleFaces(faces, w.W, visible);
+        uint32_t edgeCount = 0;
+        for (uint32_t k = 0; k < visibleCount; ++k) {
+            const uint32_t f = visible[k];
+            removeFace(faces, f);
+
+            for (uint32_t e = 0; e < 3; ++e) {
+                const EpaEdge edge{faces.Index[f][e], faces.Index[f][(e + 1) % 3]};
+                bool shared = false;
+                for (uint32_t h = 0; h < edgeCount; ++h) {
+                    if (horizon[h].A == edge.B && horizon[h].B == edge.A) {
+                        horizon[h] = horizon[--edgeCount];
+                        shared = true;
+                        break;
+                    }
+                }
+                if (!shared)
+                    horizon[edgeCount++] = edge;
+            }
+        }
+
+        bool full = false;
+        uint32_t slot = 0;
+        for (uint32_t h = 0; h < edgeCount; ++h) {
+            while (slot < faces.Count && !isRemoved(faces, slot))
+                ++slot;
+            if (slot == faces.Count) {
+                if (faces.Count == kEpaMaxFaces) {
+                    full = true;
+                    break;
+                }
+                // Starting a new group of four: its padding must read as removed
+                if (faces.Count % 4 == 0) {
+                    for (uint32_t f = faces.Count; f < faces.Count + 4; ++f)
+                        removeFace(faces, f);
+                }
+                ++faces.Count;
+            }
+            makeFace(slot, horizon[h].A, horizon[h].B, newIndex);
+        }
+        if (full)
+            break;
+    }
+
+    const uint32_t closest = closestFace(faces);
+    if (faces.Distance[closest] >= std::numeric_limits<real_t>::max())
+        return false;
+
+    // Witness points from the barycentric coordinates of the origin's projection onto the face
+    const GjkVertex& v0 = vertices[faces.Index[closest][0]];
+    const GjkVertex& v1 = vertices[faces.Index[closest][1]];
+    const GjkVertex& v2 = vertices[faces.Index[closest][2]];
+    normal = Vec3(faces.NormalX[closest], faces.NormalY[closest], faces.NormalZ[closest]);
+    depth = faces.Distance[closest];
+    const Vec3 p = normal * depth;
+    const Vec3 e0 = v1.W - v0.W, e1 = v2.W - v0.W, e2 = p - v0.W;
+    const real_t d00 = dot(e0, e0), d01 = dot(e0, e1), d11 = dot(e1, e1);
+    const real_t d20 = dot(e2, e0), d21 = dot(e2, e1);
+    const real_t denom = d00 * d11 - d01 * d01;
+
+    real_t u = 1.0f, v = 0.0f, w = 0.0f;
+    if (denom > 0.0f) {
+        v = (d11 * d20 - d01 * d21) / denom;
+        w = (d00 * d21 - d01 * d20) / denom;
+        u = 1.0f - v - w;
+    }
+
+    pointA = v0.A * u + v1.A * v + v2.A * w;
+    pointB = v0.B * u + v1.B * v + v2.B * w;
+    return true;
+}
+
+bool collideConvex(const GjkProxy& a, const GjkProxy& b, Contact& contact) {
+    GjkSimplex simplex;
+    Vec3 pointA, pointB;
+    const real_t radius = a.Radius + b.Radius;
+
+    if (gjkClosestPoints(a, b, simplex, pointA, pointB)) {
+        const Vec3 d = pointB - pointA;
+        const real_t distanceSq = dot(d, d);
+        if (distanceSq > radius * radius || distanceSq == 0.0f)
+            return false;
+
+        const real_t distance = nyx::sqrt(distanceSq);
+        contact.Normal = d * (1.0f / distance);
+        contact.Depth = radius - distance;
+    } else if (!epaPenetration(a, b, simplex, contact.Normal, contact.Depth, pointA, pointB)) {
+        return false;
+    } else {
+        contact.Depth += radius;
+    }
+
+    contact.PointA = pointA + contact.Normal * a.Radius;
+    contact.PointB = pointB - contact.Normal * b.Radius;
+    return true;
+}
+
+} // namespace nyx
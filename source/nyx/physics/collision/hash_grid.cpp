@@ -0,0 +1,171 @@
+#include "nyx/physics/collision/hash_grid.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+
+namespace nyx {
+
+namespace {
+
+constexpr size_t kMinBodiesPerSlice = 2048;
+constexpr size_t kMinBuckets = 16;
+// Keeps neighbour offsets of cell coordinates far away from int32 overflow
+constexpr real_t kMaxCellCoord = real_t(1 << 30);
+
+// Half of the 26 neighbours, so every pair of adjacent cells is visited once
+constexpr int32_t kForwardNeighbours[13][3] = {
+    { 1,  0,  0},
+    {-1,  1,  0}, { 0,  1,  0}, { 1,  1,  0},
+    {-1, -1,  1}, { 0, -1,  1}, { 1, -1,  1},
+    {-1,  0,  1}, { 0,  0,  1}, { 1,  0,  1},
+    {-1,  1,  1}, { 0,  1,  1}, { 1,  1,  1},
+};
+
+NYX_FORCEINLINE int32_t cellCoord(real_t position, real_t invCellSize) {
+    const real_t cell = std::floor(position * invCellSize);
+    return static_cast<int32_t>(std::clamp(cell, -kMaxCellCoord, kMaxCellCoord));
+}
+
+} // namespace
+
+void HashGridBroadphase::update(const RigidbodyData& data, JobSystem* jobs) {
+    const size_t count = data.getPositions().size();
+
+    binBodies(data, jobs);
+
+    parallelCollect(jobs, count, kMinBodiesPerSlice, SlicePairs, Pairs, [&](size_t begin, size_t end, std::vector<BodyPair>& out) {
+        findPairs(begin, end, out);
+    });
+}
+
+void HashGridBroadphase::binBodies(const RigidbodyData& data, JobSystem* jobs) {
+    const LaneVector<Vec3>& positions = data.getPositions();
+    const AabbLanes& bounds = data.getBounds();
+    const size_t count = positions.size();
+
+    UsedCellSize = CellSize;
+    if (UsedCellSize <= 0.0f) {
+        const LaneVector<real_t>& radii = data.getBoundingRadii();
+        const real_t maxRadius = count ? *std::max_element(radii.begin(), radii.end()) : 0.0f;
+        UsedCellSize = maxRadius > 0.0f ? 2.0f * maxRadius : 1.0f;
+    }
+    const real_t invCellSize = 1.0f / UsedCellSize;
+
+    // Twice as many buckets as bodies keeps most buckets down to a single cell
+    const size_t bucketCount = std::max(kMinBuckets, std::bit_ceil(2 * count));
+    BucketMask = static_cast<uint32_t>(bucketCount - 1);
+    BucketCount.resize(bucketCount);
+    BucketStart.resize(bucketCount + 1);
+    BodyBucket.resize(count);
+    Sorted.resize(count);
+    SortedCellX.resize(count);
+    SortedCellY.resize(count);
+    SortedCellZ.resize(count);
+    SortedBounds.resize(count);
+    SortedAwake.resize(count);
+
+    parallelFor(jobs, bucketCount, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        std::fill(BucketCount.begin() + begin, BucketCount.begin() + end, 0u);
+    });
+
+    // Histogram
+    parallelFor(jobs, count, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3& p = positions[i];
+            const uint32_t bucket = bucketOf(cellCoord(p.X, invCellSize), cellCoord(p.Y, invCellSize), cellCoord(p.Z, invCellSize));
+            BodyBucket[i] = bucket;
+            std::atomic_ref<uint32_t>(BucketCount[bucket]).fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Exclusive prefix sum in blocks: local totals, a serial scan over the blocks, then local scans
+    const size_t blockCount = std::min<size_t>(bucketCount / kMinBuckets, (jobs ? jobs->getThreadCount() : 1) * 4);
+    BlockOffsets.resize(blockCount + 1);
+    parallelFor(jobs, blockCount, 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            uint32_t total = 0;
+            for (size_t b = block * bucketCount / blockCount; b < (block + 1) * bucketCount / blockCount; ++b)
+                total += BucketCount[b];
+            BlockOffsets[block + 1] = total;
+        }
+    });
+    BlockOffsets[0] = 0;
+    for (size_t block = 0; block < blockCount; ++block)
+        BlockOffsets[block + 1] += BlockOffsets[block];
+    parallelFor(jobs, blockCount, 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            uint32_t offset = BlockOffsets[block];
+            for (size_t b = block * bucketCount / blockCount; b < (block + 1) * bucketCount / blockCount; ++b) {
+                BucketStart[b] = offset;
+                offset += BucketCount[b];
+            }
+        }
+    });
+    BucketStart[bucketCount] = static_cast<uint32_t>(count);
+
+    // Scatter. The counts run back down to zero, handing out the slots of each bucket.
+    parallelFor(jobs, count, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t bucket = BodyBucket[i];
+            const uint32_t slot = std::atomic_ref<uint32_t>(BucketCount[bucket]).fetch_sub(1, std::memory_order_relaxed) - 1;
+            Sorted[BucketStart[bucket] + slot] = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Slots were taken in whatever order the threads got there; sorting each
+    // bucket by body index makes the layout, and so the pair order, deterministic
+    parallelFor(jobs, bucketCount, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            if (BucketStart[b + 1] - BucketStart[b] > 1)
+                std::sort(Sorted.begin() + BucketStart[b], Sorted.begin() + BucketStart[b + 1]);
+        }
+    });
+
+    parallelFor(jobs, count, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = Sorted[k];
+            const Vec3& p = positions[i];
+            SortedCellX[k] = cellCoord(p.X, invCellSize);
+            SortedCellY[k] = cellCoord(p.Y, invCellSize);
+            SortedCellZ[k] = cellCoord(p.Z, invCellSize);
+            SortedBounds.MinX[k] = bounds.MinX[i];
+            SortedBounds.MinY[k] = bounds.MinY[i];
+            SortedBounds.MinZ[k] = bounds.MinZ[i];
+            SortedBounds.MaxX[k] = bounds.MaxX[i];
+            SortedBounds.MaxY[k] = bounds.MaxY[i];
+            SortedBounds.MaxZ[k] = bounds.MaxZ[i];
+            SortedAwake[k] = data.isAwake(i);
+        }
+    });
+}
+
+void HashGridBroadphase::findPairs(size_t begin, size_t end, std::vector<BodyPair>& out) const {
+    for (size_t k = begin; k < end; ++k) {
+        const int32_t x = SortedCellX[k], y = SortedCellY[k], z = SortedCellZ[k];
+        const bool awakeK = SortedAwake[k];
+
+        // Different cells can share a bucket, so candidates are matched on their cell coordinates
+        auto testRange = [&](size_t first, size_t last, int32_t cx, int32_t cy, int32_t cz) {
+            for (size_t m = first; m < last; ++m) {
+                if (SortedCellX[m] != cx || SortedCellY[m] != cy || SortedCellZ[m] != cz) continue;
+                if (!awakeK && !SortedAwake[m]) continue;
+                if (!SortedBounds.overlaps(k, m)) continue;
+                out.push_back(makeBodyPair(Sorted[k], Sorted[m]));
+            }
+        };
+
+        // Own cell: only the bodies after k, so each pair is found once
+        testRange(k + 1, BucketStart[bucketOf(x, y, z) + 1], x, y, z);
+
+        for (const int32_t* offset : kForwardNeighbours) {
+            const int32_t cx = x + offset[0], cy = y + offset[1], cz = z + offset[2];
+            const uint32_t bucket = bucketOf(cx, cy, cz);
+            testRange(BucketStart[bucket], BucketStart[bucket + 1], cx, cy, cz);
+        }
+    }
+}
+
+} // namespace nyx
@@ -0,0 +1,269 @@
+#include "nyx/physics/collision/manifold_cache.h"
+#include "nyx/physics/collision/shapes.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace nyx {
+
+namespace {
+
+constexpr size_t kMinRunsPerChunk = 64;
+
+// Twice the squared area of the largest quad the four points span, in any order
+NYX_FORCEINLINE real_t quadArea(const Vec3& p0, const Vec3& p1, const Vec3& p2, const Vec3& p3) {
+    const Vec3 a = cross(p0 - p1, p2 - p3);
+    const Vec3 b = cross(p0 - p2, p1 - p3);
+    const Vec3 c = cross(p0 - p3, p1 - p2);
+    return std::max({dot(a, a), dot(b, b), dot(c, c)});
+}
+
+} // namespace
+
+void ManifoldCache::update(const std::vector<Contact>& contacts, const RigidbodyData& data, JobSystem* jobs) {
+    ++Step;
+    if (Slots.empty())
+        rehash(kMinSlots);
+
+    // Lookups and insertions touch the table, so they run serially, once per
+    // run of contacts from the same pair
+    Runs.clear();
+    for (size_t c = 0; c < contacts.size(); ++c) {
+        if (c == 0 || contacts[c].A != contacts[c - 1].A || contacts[c].B != contacts[c - 1].B)
+            Runs.push_back({static_cast<uint32_t>(c), findOrInsert(contacts[c].A, contacts[c].B)});
+    }
+
+    // Every manifold gets exactly one run per step, so the merges are independent
+    parallelFor(jobs, Runs.size(), kMinRunsPerChunk, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            const size_t first = Runs[r].First;
+            const size_t last = r + 1 < Runs.size() ? Runs[r + 1].First : contacts.size();
+            ContactManifold& manifold = Manifolds[Runs[r].Manifold];
+            manifold.LastSeen = Step;
+            manifold.Normal = contacts[first].Normal;
+            refresh(manifold, data);
+            for (size_t c = first; c < last; ++c)
+                addPoint(manifold, contacts[c], data);
+        }
+    });
+
+    // Walking backwards, swap-and-pop only ever moves manifolds that were already checked.
+    // Pairs with no awake body are not reported at all; their manifolds are kept for
+    // when the bodies wake.
+    for (size_t m = Manifolds.size(); m-- > 0;) {
+        const ContactManifold& manifold = Manifolds[m];
+        if (manifold.LastSeen != Step && (data.isAwake(manifold.A) || data.isAwake(manifold.B)))
+            remove(static_cast<uint32_t>(m));
+    }
+}
+
+void ManifoldCache::clear() {
+    Manifolds.clear();
+    std::fill(Slots.begin(), Slots.end(), kEmptySlot);
+}
+
+void ManifoldCache::restored() {
+    Runs.clear();
+    rehash(std::bit_ceil(Manifolds.size() * 2));
+}
+
+bool ManifoldCache::isConsistent(size_t bodies) const {
+    return std::all_of(Manifolds.begin(), Manifolds.end(), [bodies](const ContactManifold& manifold) {
+        return manifold.A < manifold.B && manifold.B < bodies && manifold.PointCount <= kMaxManifoldPoints;
+    });
+}
+
+void ManifoldCache::removeBody(uint32_t body, uint32_t last) {
+    for (size_t m = 0; m < Manifolds.size();) {
+        ContactManifold& manifold = Manifolds[m];
+        if (manifold.A == body || manifold.B == body) {
+            manifold = Manifolds.back();
+            Manifolds.pop_back();
+            continue;
+        }
+
+        if (manifold.A == last || manifold.B == last) {
+            (manifold.A == last ? manifold.A : manifold.B) = body;
+            // Pairs are keyed with A < B; swapping the sides flips the normal, and
+            // the tangent basis built from it, so only the normal impulses carry over
+            if (manifold.A > manifold.B) {
+                std::swap(manifold.A, manifold.B);
+                manifold.Normal = -manifold.Normal;
+                for (uint32_t p = 0; p < manifold.PointCount; ++p) {
+                    ManifoldPoint& point = manifold.Points[p];
+                    std::swap(point.LocalA, point.LocalB);
+                    std::swap(point.PointA, point.PointB);
+                    point.TangentImpulse[0] = point.TangentImpulse[1] = 0.0f;
+                }
+            }
+        }
+        ++m;
+    }
+
+    // Keys changed all over the pool, so the table is rebuilt rather than patched
+    rehash(Slots.size());
+}
+
+ContactManifold* ManifoldCache::find(uint32_t a, uint32_t b) {
+    if (Slots.empty())
+        return nullptr;
+
+    const size_t mask = Slots.size() - 1;
+    for (size_t s = slotOf(a, b); Slots[s] != kEmptySlot; s = (s + 1) & mask) {
+        ContactManifold& manifold = Manifolds[Slots[s]];
+        if (manifold.A == a && manifold.B == b)
+            return &manifold;
+    }
+    return nullptr;
+}
+
+uint32_t ManifoldCache::findOrInsert(uint32_t a, uint32_t b) {
+    // At most half full keeps the probe sequences short
+    if ((Manifolds.size() + 1) * 2 > Slots.size())
+        rehash(Slots.size() * 2);
+
+    const size_t mask = Slots.size() - 1;
+    size_t s = slotOf(a, b);
+    for (; Slots[s] != kEmptySlot; s = (s + 1) & mask) {
+        const ContactManifold& manifold = Manifolds[Slots[s]];
+        if (manifold.A == a && manifold.B == b)
+            return Slots[s];
+    }
+
+    const uint32_t index = static_cast<uint32_t>(Manifolds.size());
+    Slots[s] = index;
+    ContactManifold& manifold = Manifolds.emplace_back();
+    manifold.A = a;
+    manifold.B = b;
+    manifold.PointCount = 0;
+    manifold.LastSeen = 0;
+    return index;
+}
+
+void ManifoldCache::remove(uint32_t index) {
+    const size_t mask = Slots.size() - 1;
+    auto slotHolding = [&](uint32_t manifold) {
+        size_t s = slotOf(Manifolds[manifold].A, Manifolds[manifold].B);
+        while (Slots[s] != manifold)
+            s = (s + 1) & mask;
+        return s;
+    };
+
+    // Backward shift: pull later entries of the probe run into the hole when
+    // that does not move them in front of their home slot
+    size_t hole = slotHolding(index);
+    for (size_t next = (hole + 1) & mask; Slots[next] != kEmptySlot; next = (next + 1) & mask) {
+        const ContactManifold& moved = Manifolds[Slots[next]];
+        const size_t home = slotOf(moved.A, moved.B);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            Slots[hole] = Slots[next];
+            hole = next;
+        }
+    }
+    Slots[hole] = kEmptySlot;
+
+    // Swap-and-pop keeps the pool dense for the solver
+    const uint32_t last = static_cast<uint32_t>(Manifolds.size() - 1);
+    if (index != last) {
+        Slots[slotHolding(last)] = index;
+        Manifolds[index] = Manifolds[last];
+    }
+    Manifolds.pop_back();
+}
+
+void ManifoldCache::rehash(size_t slotCount) {
+    Slots.assign(std::max(slotCount, kMinSlots), kEmptySlot);
+    const size_t mask = Slots.size() - 1;
+    for (uint32_t m = 0; m < Manifolds.size(); ++m) {
+        size_t s = slotOf(Manifolds[m].A, Manifolds[m].B);
+        while (Slots[s] != kEmptySlot)
+            s = (s + 1) & mask;
+        Slots[s] = m;
+    }
+}
+
+void ManifoldCache::refresh(ContactManifold& manifold, const RigidbodyData& data) const {
+    const ShapeTransform xfA(data.getPositions()[manifold.A], data.getOrientations()[manifold.A]);
+    const ShapeTransform xfB(data.getPositions()[manifold.B], data.getOrientations()[manifold.B]);
+
+    uint32_t kept = 0;
+    for (uint32_t p = 0; p < manifold.PointCount; ++p) {
+        ManifoldPoint point = manifold.Points[p];
+        point.PointA = xfA.toWorld(point.LocalA);
+        point.PointB = xfB.toWorld(point.LocalB);
+
+        const Vec3 d = point.PointA - point.PointB;
+        point.Depth = dot(d, manifold.Normal);
+        const Vec3 slide = d - manifold.Normal * point.Depth;
+        if (point.Depth < -BreakingDistance || dot(slide, slide) > BreakingDistance * BreakingDistance)
+            continue;
+        manifold.Points[kept++] = point;
+    }
+    manifold.PointCount = kept;
+}
+
+void ManifoldCache::addPoint(ContactManifold& manifold, const Contact& contact, const RigidbodyData& data) const {
+    const ShapeTransform xfA(data.getPositions()[manifold.A], data.getOrientations()[manifold.A]);
+    const ShapeTransform xfB(data.getPositions()[manifold.B], data.getOrientations()[manifold.B]);
+
+    ManifoldPoint point;
+    point.LocalA = xfA.toLocal(contact.PointA);
+    point.LocalB = xfB.toLocal(contact.PointB);
+    point.PointA = contact.PointA;
+    point.PointB = contact.PointB;
+    point.Depth = contact.Depth;
+    point.NormalImpulse = 0.0f;
+    point.TangentImpulse[0] = point.TangentImpulse[1] = 0.0f;
+
+    // A point that is still where a cached one was keeps that point's impulses
+    uint32_t match = kMaxManifoldPoints;
+    real_t matchDistance = MatchDistance * MatchDistance;
+    for (uint32_t p = 0; p < manifold.PointCount; ++p) {
+        const Vec3 d = manifold.Points[p].LocalA - point.LocalA;
+        if (dot(d, d) < matchDistance) {
+            matchDistance = dot(d, d);
+            match = p;
+        }
+    }
+    if (match != kMaxManifoldPoints) {
+        point.NormalImpulse = manifold.Points[match].NormalImpulse;
+        point.TangentImpulse[0] = manifold.Points[match].TangentImpulse[0];
+        point.TangentImpulse[1] = manifold.Points[match].TangentImpulse[1];
+        manifold.Points[match] = point;
+        return;
+    }
+
+    if (manifold.PointCount < kMaxManifoldPoints) {
+        manifold.Points[manifold.PointCount++] = point;
+        return;
+    }
+
+    // Full: keep the deepest point, and of the rest replace the one whose loss leaves the widest support
+    uint32_t deepest = kMaxManifoldPoints;
+    real_t maxDepth = point.Depth;
+    for (uint32_t p = 0; p < kMaxManifoldPoints; ++p) {
+        if (manifold.Points[p].Depth > maxDepth) {
+            maxDepth = manifold.Points[p].Depth;
+            deepest = p;
+        }
+    }
+
+    uint32_t replace = 0;
+    real_t bestArea = -1.0f;
+    for (uint32_t p = 0; p < kMaxManifoldPoints; ++p) {
+        if (p == deepest) continue;
+
+        Vec3 q[kMaxManifoldPoints];
+        for (uint32_t i = 0; i < kMaxManifoldPoints; ++i)
+            q[i] = i == p ? point.LocalA : manifold.Points[i].LocalA;
+        const real_t area = quadArea(q[0], q[1], q[2], q[3]);
+        if (area > bestArea) {
+            bestArea = area;
+            replace = p;
+        }
+    }
+    manifold.Points[replace] = point;
+}
+
+} // namespace nyx
@@ -0,0 +1,401 @@
+#include "nyx/physics/collision/narrowphase.h"
+#include "nyx/physics/collision/gjk.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace nyx {
+
+namespace {
+
+constexpr size_t kMinPairsPerSlice = 256;
+constexpr uint8_t kNoShape = 0xFF;
+// Edge axes have to beat the best face axis by this factor
+constexpr real_t kEdgeAxisBias = 1.05f;
+// Squared length of the cross product below which two edges count as parallel
+constexpr real_t kParallelTolerance = 1e-6f;
+
+NYX_FORCEINLINE real_t clamp01(real_t x) { return std::clamp(x, real_t(0), real_t(1)); }
+
+NYX_FORCEINLINE bool sphereContact(const Vec3& centerA, real_t radiusA, const Vec3& centerB, real_t radiusB, Contact& contact) {
+    const Vec3 d = centerB - centerA;
+    const real_t radius = radiusA + radiusB;
+    const real_t distanceSq = dot(d, d);
+    if (distanceSq > radius * radius)
+        return false;
+
+    const real_t distance = nyx::sqrt(distanceSq);
+    contact.Normal = distance > 0.0f ? d * (1.0f / distance) : Vec3(0.0f, 1.0f, 0.0f);
+    contact.PointA = centerA + contact.Normal * radiusA;
+    contact.PointB = centerB - contact.Normal * radiusB;
+    contact.Depth = radius - distance;
+    return true;
+}
+
+NYX_FORCEINLINE void capsuleSegment(const ShapeStore& shapes, const ShapeInstance& capsule, Vec3& p0, Vec3& p1) {
+    const Vec3 half = capsule.Xf.Axis[1] * shapes.getCapsule(capsule.Shape.Index).HalfHeight;
+    p0 = capsule.Xf.Position - half;
+    p1 = capsule.Xf.Position + half;
+}
+
+// Anything without a closed form goes through GJK/EPA
+template <ShapeType A, ShapeType B>
+bool collideShapes(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    return collideConvex(GjkProxy(shapes, a.Shape, a.Xf), GjkProxy(shapes, b.Shape, b.Xf), contact);
+}
+
+template <>
+bool collideShapes<ShapeType::Sphere, ShapeType::Sphere>(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    return sphereContact(a.Xf.Position, shapes.getSphere(a.Shape.Index).Radius,
+                         b.Xf.Position, shapes.getSphere(b.Shape.Index).Radius, contact);
+}
+
+template <>
+bool collideShapes<ShapeType::Sphere, ShapeType::Box>(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    const real_t radius = shapes.getSphere(a.Shape.Index).Radius;
+    const Vec3& e = shapes.getBox(b.Shape.Index).HalfExtents;
+
+    // In the box's frame, normal points from the box towards the sphere
+    const Vec3 center = b.Xf.toLocal(a.Xf.Position);
+    Vec3 closest(std::clamp(center.X, -e.X, e.X), std::clamp(center.Y, -e.Y, e.Y), std::clamp(center.Z, -e.Z, e.Z));
+    const Vec3 d = center - closest;
+    const real_t distanceSq = dot(d, d);
+    if (distanceSq > radius * radius)
+        return false;
+
+    Vec3 normal;
+    if (distanceSq > 0.0f) {
+        const real_t distance = nyx::sqrt(distanceSq);
+        normal = d * (1.0f / distance);
+        contact.Depth = radius - distance;
+    } else {
+        // Centre inside the box: push out through the nearest face
+        const real_t gaps[3] = {e.X - std::abs(center.X), e.Y - std::abs(center.Y), e.Z - std::abs(center.Z)};
+        const int axis = gaps[0] <= gaps[1] && gaps[0] <= gaps[2] ? 0 : (gaps[1] <= gaps[2] ? 1 : 2);
+        const real_t c[3] = {center.X, center.Y, center.Z};
+        const real_t side = c[axis] >= 0.0f ? 1.0f : -1.0f;
+        real_t n[3] = {0.0f, 0.0f, 0.0f};
+        n[axis] = side;
+        normal = Vec3(n[0], n[1], n[2]);
+        real_t p[3] = {center.X, center.Y, center.Z};
+        p[axis] = side * (axis == 0 ? e.X : (axis == 1 ? e.Y : e.Z));
+        closest = Vec3(p[0], p[1], p[2]);
+        contact.Depth = radius + gaps[axis];
+    }
+
+    contact.Normal = -b.Xf.rotate(normal);
+    contact.PointA = a.Xf.Position + contact.Normal * radius;
+    contact.PointB = b.Xf.toWorld(closest);
+    return true;
+}
+
+template <>
+bool collideShapes<ShapeType::Sphere, ShapeType::Capsule>(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    Vec3 p0, p1;
+    capsuleSegment(shapes, b, p0, p1);
+    const Vec3 segment = p1 - p0;
+    const real_t lengthSq = dot(segment, segment);
+    const real_t t = lengthSq > 0.0f ? clamp01(dot(a.Xf.Position - p0, segment) / lengthSq) : 0.0f;
+    return sphereContact(a.Xf.Position, shapes.getSphere(a.Shape.Index).Radius,
+                         p0 + segment * t, shapes.getCapsule(b.Shape.Index).Radius, contact);
+}
+
+template <>
+bool collideShapes<ShapeType::Capsule, ShapeType::Capsule>(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    Vec3 pa, qa, pb, qb;
+    capsuleSegment(shapes, a, pa, qa);
+    capsuleSegment(shapes, b, pb, qb);
+
+    // Closest points of two segments, clamping one parameter at a time
+    const Vec3 da = qa - pa, db = qb - pb, r = pa - pb;
+    const real_t aa = dot(da, da), bb = dot(db, db), f = dot(db, r);
+    real_t s = 0.0f, t = 0.0f;
+    if (aa <= 0.0f) {
+        t = bb > 0.0f ? clamp01(f / bb) : 0.0f;
+    } else {
+        const real_t c = dot(da, r);
+        if (bb <= 0.0f) {
+            s = clamp01(-c / aa);
+        } else {
+            const real_t ab = dot(da, db);
+            const real_t denom = aa * bb - ab * ab;
+            s = denom > 0.0f ? clamp01((ab * f - c * bb) / denom) : 0.0f;
+            t = (ab * s + f) / bb;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = clamp01(-c / aa);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = clamp01((ab - c) / aa);
+            }
+        }
+    }
+
+    return sphereContact(pa + da * s, shapes.getCapsule(a.Shape.Index).Radius,
+                         pb + db * t, shapes.getCapsule(b.Shape.Index).Radius, contact);
+}
+
+// Separating axes for two boxes. Face contacts clip the incident face against
+// the side planes of the reference face, which gives a resting box its whole
+// support polygon in one step; edge contacts give the closest points of the edges.
+uint32_t collideBoxes(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts) {
+    const ShapeTransform& xa = a.Xf;
+    const ShapeTransform& xb = b.Xf;
+    const Vec3& ea = shapes.getBox(a.Shape.Index).HalfExtents;
+    const Vec3& eb = shapes.getBox(b.Shape.Index).HalfExtents;
+    const real_t extentA[3] = {ea.X, ea.Y, ea.Z};
+    const real_t extentB[3] = {eb.X, eb.Y, eb.Z};
+    const Vec3 d = xb.Position - xa.Position;
+
+    auto projectA = [&](const Vec3& axis) {
+        return ea.X * std::abs(dot(xa.Axis[0], axis)) + ea.Y * std::abs(dot(xa.Axis[1], axis)) + ea.Z * std::abs(dot(xa.Axis[2], axis));
+    };
+    auto projectB = [&](const Vec3& axis) {
+        return eb.X * std::abs(dot(xb.Axis[0], axis)) + eb.Y * std::abs(dot(xb.Axis[1], axis)) + eb.Z * std::abs(dot(xb.Axis[2], axis));
+    };
+
+    // Axes 0-2 are A's faces, 3-5 B's faces, 6-14 the edge pairs
+    int bestAxis = -1;
+    real_t bestOverlap = std::numeric_limits<real_t>::max();
+    Vec3 normal;
+    auto testAxis = [&](int index, const Vec3& axis) {
+        const real_t overlap = projectA(axis) + projectB(axis) - std::abs(dot(d, axis));
+        if (overlap < 0.0f)
+            return false;
+        // Edge axes must win clearly, or face contacts would flicker to single points
+        const real_t bias = index >= 6 ? kEdgeAxisBias : 1.0f;
+        if (overlap * bias < bestOverlap) {
+            bestOverlap = overlap;
+            bestAxis = index;
+            normal = dot(d, axis) >= 0.0f ? axis : -axis;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 3; ++i)
+        if (!testAxis(i, xa.Axis[i])) return 0;
+    for (int i = 0; i < 3; ++i)
+        if (!testAxis(3 + i, xb.Axis[i])) return 0;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            const Vec3 axis = cross(xa.Axis[i], xb.Axis[j]);
+            const real_t lengthSq = dot(axis, axis);
+            if (lengthSq < kParallelTolerance) continue; // parallel edges, covered by the face axes
+            if (!testAxis(6 + i * 3 + j, axis * (1.0f / nyx::sqrt(lengthSq)))) return 0;
+        }
+    }
+
+    if (bestAxis >= 6) {
+        // Closest points of the two edges that reach furthest towards each other
+        const int i = (bestAxis - 6) / 3, j = (bestAxis - 6) % 3;
+        Vec3 pa = xa.Position, pb = xb.Position;
+        for (int k = 0; k < 3; ++k) {
+            if (k != i) pa += xa.Axis[k] * (dot(xa.Axis[k], normal) >= 0.0f ? extentA[k] : -extentA[k]);
+            if (k != j) pb += xb.Axis[k] * (dot(xb.Axis[k], normal) <= 0.0f ? extentB[k] : -extentB[k]);
+        }
+        const Vec3& da = xa.Axis[i];
+        const Vec3& db = xb.Axis[j];
+        const Vec3 r = pa - pb;
+        const real_t ab = dot(da, db), c = dot(da, r), f = dot(db, r);
+        const real_t denom = 1.0f - ab * ab;
+        const real_t s = denom > 0.0f ? std::clamp((ab * f - c) / denom, -extentA[i], extentA[i]) : 0.0f;
+        const real_t t = std::clamp(ab * s + f, -extentB[j], extentB[j]);
+
+        contacts[0].Normal = normal;
+        contacts[0].PointA = pa + da * s;
+        contacts[0].PointB = pb + db * t;
+        contacts[0].Depth = bestOverlap;
+        return 1;
+    }
+
+    // Reference face on the box that owns the axis, incident face on the other
+    const bool referenceIsA = bestAxis < 3;
+    const ShapeTransform& ref = referenceIsA ? xa : xb;
+    const ShapeTransform& inc = referenceIsA ? xb : xa;
+    const real_t* refExtent = referenceIsA ? extentA : extentB;
+    const real_t* incExtent = referenceIsA ? extentB : extentA;
+    const int refAxis = bestAxis % 3;
+    const Vec3 refNormal = referenceIsA ? normal : -normal; // out of the reference face
+
+    // The incident face is the one most opposed to the reference normal
+    int incAxis = 0;
+    real_t incDot = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        const real_t alignment = dot(inc.Axis[k], refNormal);
+        if (std::abs(alignment) > std::abs(incDot)) {
+            incDot = alignment;
+            incAxis = k;
+        }
+    }
+    const Vec3 incCenter = inc.Position + inc.Axis[incAxis] * (incDot > 0.0f ? -incExtent[incAxis] : incExtent[incAxis]);
+    const int iu = (incAxis + 1) % 3, iv = (incAxis + 2) % 3;
+    const Vec3 incU = inc.Axis[iu] * incExtent[iu];
+    const Vec3 incV = inc.Axis[iv] * incExtent[iv];
+
+    Vec3 polygon[8] = {incCenter + incU + incV, incCenter - incU + incV, incCenter - incU - incV, incCenter + incU - incV};
+    Vec3 clipped[8];
+    uint32_t count = 4;
+
+    // Sutherland-Hodgman against the four side planes of the reference face
+    const Vec3 refCenter = ref.Position + refNormal * refExtent[refAxis];
+    for (int side = 0; side < 4 && count > 0; ++side) {
+        const int axis = (refAxis + 1 + side / 2) % 3;
+        const Vec3 planeNormal = side % 2 == 0 ? ref.Axis[axis] : -ref.Axis[axis];
+        const real_t offset = dot(planeNormal, ref.Position) + refExtent[axis];
+
+        uint32_t kept = 0;
+        for (uint32_t k = 0; k < count; ++k) {
+            const Vec3& p = polygon[k];
+            const Vec3& q = polygon[(k + 1) % count];
+            const real_t dp = dot(planeNormal, p) - offset;
+            const real_t dq = dot(planeNormal, q) - offset;
+            // One test for both, so each plane adds at most one vertex
+            const bool insideP = dp <= 0.0f, insideQ = dq <= 0.0f;
+            if (insideP)
+                clipped[kept++] = p;
+            if (insideP != insideQ)
+                clipped[kept++] = p + (q - p) * (dp / (dp - dq));
+        }
+        std::copy(clipped, clipped + kept, polygon);
+        count = kept;
+    }
+
+    // Points of the incident face below the reference face are in contact
+    const real_t refOffset = dot(refNormal, refCenter);
+    Contact found[8]{}; // zeroed, so copying out never reads fields left unset
+    uint32_t foundCount = 0;
+    for (uint32_t k = 0; k < count; ++k) {
+        const real_t depth = refOffset - dot(refNormal, polygon[k]);
+        if (depth < 0.0f) continue;
+
+        Contact& contact = found[foundCount++];
+        const Vec3 onReference = polygon[k] + refNormal * depth;
+        contact.Normal = normal;
+        contact.PointA = referenceIsA ? onReference : polygon[k];
+        contact.PointB = referenceIsA ? polygon[k] : onReference;
+        contact.Depth = depth;
+    }
+
+    if (foundCount <= kMaxContactsPerPair) {
+        std::copy(found, found + foundCount, contacts);
+        return foundCount;
+    }
+
+    // Too many: the deepest point, the one furthest from it, then the widest triangle on either side
+    uint32_t pick[4] = {0, 0, 0, 0};
+    for (uint32_t k = 1; k < foundCount; ++k)
+        if (found[k].Depth > found[pick[0]].Depth) pick[0] = k;
+    real_t best = -1.0f;
+    for (uint32_t k = 0; k < foundCount; ++k) {
+        const Vec3 e = found[k].PointB - found[pick[0]].PointB;
+        if (dot(e, e) > best) { best = dot(e, e); pick[1] = k; }
+    }
+    const Vec3 edge = found[pick[1]].PointB - found[pick[0]].PointB;
+    real_t most = 0.0f, least = 0.0f;
+    pick[2] = pick[3] = pick[0];
+    for (uint32_t k = 0; k < foundCount; ++k) {
+        const real_t area = dot(cross(edge, found[k].PointB - found[pick[0]].PointB), normal);
+        if (area > most) { most = area; pick[2] = k; }
+        if (area < least) { least = area; pick[3] = k; }
+    }
+
+    uint32_t written = 0;
+    for (uint32_t k = 0; k < 4; ++k) {
+        if (std::find(pick, pick + k, pick[k]) == pick + k)
+            contacts[written++] = found[pick[k]];
+    }
+    return written;
+}
+
+// Routines with a single point of contact fill the first slot
+template <ShapeType A, ShapeType B>
+uint32_t collidePair(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts) {
+    return collideShapes<A, B>(shapes, a, b, contacts[0]) ? 1 : 0;
+}
+
+template <>
+uint32_t collidePair<ShapeType::Box, ShapeType::Box>(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts) {
+    return collideBoxes(shapes, a, b, contacts);
+}
+
+using enum ShapeType;
+
+// Indexed by [lower type][higher type]; pairs involving None never get here
+constexpr CollideFunction kCollide[kShapeTypeCount][kShapeTypeCount] = {
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+    {nullptr, collidePair<Sphere, Sphere>, collidePair<Sphere, Box>, collidePair<Sphere, Capsule>, collidePair<Sphere, Convex>},
+    {nullptr, nullptr, collidePair<Box, Box>, collidePair<Box, Capsule>, collidePair<Box, Convex>},
+    {nullptr, nullptr, nullptr, collidePair<Capsule, Capsule>, collidePair<Capsule, Convex>},
+    {nullptr, nullptr, nullptr, nullptr, collidePair<Convex, Convex>},
+};
+
+NYX_FORCEINLINE uint32_t dispatch(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts) {
+    const size_t typeA = static_cast<size_t>(a.Shape.Type);
+    const size_t typeB = static_cast<size_t>(b.Shape.Type);
+    if (typeA <= typeB)
+        return kCollide[typeA][typeB](shapes, a, b, contacts);
+
+    const uint32_t count = kCollide[typeB][typeA](shapes, b, a, contacts);
+    for (uint32_t c = 0; c < count; ++c) {
+        contacts[c].Normal = -contacts[c].Normal;
+        std::swap(contacts[c].PointA, contacts[c].PointB);
+    }
+    return count;
+}
+
+} // namespace
+
+uint32_t Narrowphase::collide(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact* contacts) {
+    if (a.Shape.Type == ShapeType::None || b.Shape.Type == ShapeType::None)
+        return 0;
+    return dispatch(shapes, a, b, contacts);
+}
+
+void Narrowphase::update(const std::vector<BodyPair>& pairs, const RigidbodyData& data, const ShapeStore& shapes, LinearArena& frameArena, JobSystem* jobs) {
+    const LaneVector<Vec3>& positions = data.getPositions();
+    const LaneVector<Quaternion>& orientations = data.getOrientations();
+
+    // Counting sort of the pairs by shape type pair, so each run of the batch shares a routine
+    uint32_t counts[kShapeTypeCount * kShapeTypeCount + 1] = {};
+    uint8_t* pairKeys = frameArena.allocateArray<uint8_t>(pairs.size()); // per pair, dispatch table slot or kNoShape
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        const size_t typeA = static_cast<size_t>(shapes.getShape(pairs[p].A).Type);
+        const size_t typeB = static_cast<size_t>(shapes.getShape(pairs[p].B).Type);
+        if (typeA == 0 || typeB == 0) {
+            pairKeys[p] = kNoShape;
+            continue;
+        }
+        const uint8_t key = static_cast<uint8_t>(std::min(typeA, typeB) * kShapeTypeCount + std::max(typeA, typeB));
+        pairKeys[p] = key;
+        ++counts[key + 1];
+    }
+    for (size_t key = 1; key <= kShapeTypeCount * kShapeTypeCount; ++key)
+        counts[key] += counts[key - 1];
+
+    const size_t count = counts[kShapeTypeCount * kShapeTypeCount];
+    uint32_t* batched = frameArena.allocateArray<uint32_t>(count); // pair indices grouped by key
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        if (pairKeys[p] != kNoShape)
+            batched[counts[pairKeys[p]]++] = static_cast<uint32_t>(p);
+    }
+
+    parallelCollect(jobs, count, kMinPairsPerSlice, SliceContacts, Contacts, [&](size_t begin, size_t end, std::vector<Contact>& out) {
+        for (size_t k = begin; k < end; ++k) {
+            const BodyPair& pair = pairs[batched[k]];
+            const ShapeInstance a{shapes.getShape(pair.A), ShapeTransform(positions[pair.A], orientations[pair.A])};
+            const ShapeInstance b{shapes.getShape(pair.B), ShapeTransform(positions[pair.B], orientations[pair.B])};
+
+            Contact contacts[kMaxContactsPerPair];
+            const uint32_t found = dispatch(shapes, a, b, contacts);
+            for (uint32_t c = 0; c < found; ++c) {
+                contacts[c].A = pair.A;
+                contacts[c].B = pair.B;
+                out.push_back(contacts[c]);
+            }
+        }
+    });
+}
+
+} // namespace nyx
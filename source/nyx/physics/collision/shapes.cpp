@@ -0,0 +1,199 @@
+#include "nyx/physics/collision/shapes.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+// Index of the first vertex furthest along direction
+uint32_t hullSupportScalar(const real_t* xs, const real_t* ys, const real_t* zs, uint32_t count, const Vec3& direction) {
+    uint32_t best = 0;
+    real_t bestDot = xs[0] * direction.X + ys[0] * direction.Y + zs[0] * direction.Z;
+    for (uint32_t v = 1; v < count; ++v) {
+        const real_t d = xs[v] * direction.X + ys[v] * direction.Y + zs[v] * direction.Z;
+        if (d > bestDot) {
+            bestDot = d;
+            best = v;
+        }
+    }
+    return best;
+}
+
+#if defined(NYX_SIMD_DISPATCH)
+// Four vertices per iteration, tracking the best dot product and its index per lane
+NYX_TARGET_SSE4 uint32_t hullSupportSse4(const real_t* xs, const real_t* ys, const real_t* zs, uint32_t count, const Vec3& direction) {
+    const __m128 dx = _mm_set1_ps(direction.X), dy = _mm_set1_ps(direction.Y), dz = _mm_set1_ps(direction.Z);
+    __m128 bestDot = _mm_set1_ps(-std::numeric_limits<float>::max());
+    __m128i bestIndex = _mm_setzero_si128();
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(kHullVertexBlock);
+    for (uint32_t v = 0; v < count; v += kHullVertexBlock) {
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(xs + v), dx), _mm_mul_ps(_mm_load_ps(ys + v), dy)),
+                                    _mm_mul_ps(_mm_load_ps(zs + v), dz));
+        const __m128 better = _mm_cmpgt_ps(d, bestDot);
+        bestDot = _mm_blendv_ps(bestDot, d, better);
+        bestIndex = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(bestIndex), _mm_castsi128_ps(index), better));
+        index = _mm_add_epi32(index, step);
+    }
+
+    alignas(16) float dots[4];
+    alignas(16) uint32_t indices[4];
+    _mm_store_ps(dots, bestDot);
+    _mm_store_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+    uint32_t best = 0;
+    for (uint32_t lane = 1; lane < 4; ++lane) {
+        if (dots[lane] > dots[best] || (dots[lane] == dots[best] && indices[lane] < indices[best]))
+            best = lane;
+    }
+    return indices[best];
+}
+#endif
+
+} // namespace
+
+ShapeHandle& ShapeStore::slot(size_t body, ShapeType type, size_t typeCount) {
+    if (BodyShapes.size() <= body)
+        BodyShapes.resize(body + 1);
+
+    ShapeHandle& handle = BodyShapes[body];
+    if (handle.Type == ShapeType::None)
+        ++ShapeCount;
+    if (handle.Type != type) {
+        release(handle);
+        // A free slot is below typeCount, so the setters only append for a new one
+        std::vector<uint32_t>& free = FreeSlots[static_cast<size_t>(type)];
+        uint32_t index = static_cast<uint32_t>(typeCount);
+        if (!free.empty()) {
+            index = free.back();
+            free.pop_back();
+        }
+        handle = ShapeHandle{type, index};
+    }
+    return handle;
+}
+
+void ShapeStore::release(ShapeHandle handle) {
+    if (handle.Type != ShapeType::None)
+        FreeSlots[static_cast<size_t>(handle.Type)].push_back(handle.Index);
+}
+
+void ShapeStore::removeBody(size_t body, size_t last) {
+    if (body >= BodyShapes.size())
+        return;
+
+    if (BodyShapes[body].Type != ShapeType::None) {
+        release(BodyShapes[body]);
+        --ShapeCount;
+    }
+
+    // Shapes are only stored up to the highest body that has one
+    if (last < BodyShapes.size()) {
+        BodyShapes[body] = BodyShapes[last];
+        BodyShapes.pop_back();
+    } else {
+        BodyShapes[body] = ShapeHandle{};
+    }
+}
+
+real_t ShapeStore::setSphere(size_t body, real_t radius) {
+    assert(radius >= 0.0f && "Sphere radius must not be negative");
+    const ShapeHandle& handle = slot(body, ShapeType::Sphere, Spheres.size());
+    if (handle.Index == Spheres.size())
+        Spheres.emplace_back();
+    Spheres[handle.Index] = SphereShape{radius};
+    return radius;
+}
+
+real_t ShapeStore::setBox(size_t body, const Vec3& halfExtents) {
+    assert(halfExtents.X >= 0.0f && halfExtents.Y >= 0.0f && halfExtents.Z >= 0.0f && "Box extents must not be negative");
+    const ShapeHandle& handle = slot(body, ShapeType::Box, Boxes.size());
+    if (handle.Index == Boxes.size())
+        Boxes.emplace_back();
+    Boxes[handle.Index] = BoxShape{halfExtents};
+    return halfExtents.length();
+}
+
+real_t ShapeStore::setCapsule(size_t body, real_t halfHeight, real_t radius) {
+    assert(halfHeight >= 0.0f && radius >= 0.0f && "Capsule dimensions must not be negative");
+    const ShapeHandle& handle = slot(body, ShapeType::Capsule, Capsules.size());
+    if (handle.Index == Capsules.size())
+        Capsules.emplace_back();
+    Capsules[handle.Index] = CapsuleShape{halfHeight, radius};
+    return halfHeight + radius;
+}
+
+real_t ShapeStore::setConvex(size_t body, const Vec3* points, size_t count) {
+    assert(count > 0 && "Convex shape needs at least one point");
+    const ShapeHandle& handle = slot(body, ShapeType::Convex, Convexes.size());
+    if (handle.Index == Convexes.size())
+        Convexes.emplace_back();
+
+    // New vertices always go to the end; a block aligned start keeps the SIMD loads aligned
+    const uint32_t first = static_cast<uint32_t>(HullX.size());
+    const uint32_t padded = static_cast<uint32_t>((count + kHullVertexBlock - 1) / kHullVertexBlock * kHullVertexBlock);
+    for (LaneVector<real_t>* lane : {&HullX, &HullY, &HullZ})
+        lane->resize(first + padded);
+
+    real_t radiusSq = 0.0f;
+    for (uint32_t v = 0; v < padded; ++v) {
+        const Vec3& p = points[std::min<size_t>(v, count - 1)];
+        HullX[first + v] = p.X;
+        HullY[first + v] = p.Y;
+        HullZ[first + v] = p.Z;
+        radiusSq = std::max(radiusSq, dot(p, p));
+    }
+
+    Convexes[handle.Index] = ConvexShape{first, padded};
+    return nyx::sqrt(radiusSq);
+}
+
+bool ShapeStore::isConsistent(size_t bodies) const {
+    const size_t counts[kShapeTypeCount] = {0, Spheres.size(), Boxes.size(), Capsules.size(), Convexes.size()};
+    if (BodyShapes.size() > bodies)
+        return false;
+    size_t used = 0;
+    for (const ShapeHandle& shape : BodyShapes) {
+        const size_t type = static_cast<size_t>(shape.Type);
+        if (type >= kShapeTypeCount || (shape.Type != ShapeType::None && shape.Index >= counts[type]))
+            return false;
+        used += shape.Type != ShapeType::None ? 1 : 0;
+    }
+    for (size_t type = 0; type < kShapeTypeCount; ++type) {
+        for (uint32_t index : FreeSlots[type]) {
+            if (index >= counts[type])
+                return false;
+        }
+    }
+
+    // Hulls are read a block at a time with aligned loads
+    if (HullY.size() != HullX.size() || HullZ.size() != HullX.size())
+        return false;
+    for (const ConvexShape& hull : Convexes) {
+        if (hull.VertexCount == 0 || hull.FirstVertex % kHullVertexBlock != 0 || hull.VertexCount % kHullVertexBlock != 0 ||
+            uint64_t(hull.FirstVertex) + hull.VertexCount > HullX.size())
+            return false;
+    }
+    return used == ShapeCount;
+}
+
+Vec3 ShapeStore::hullSupport(const ConvexShape& hull, const Vec3& direction) const {
+    const real_t* xs = HullX.data() + hull.FirstVertex;
+    const real_t* ys = HullY.data() + hull.FirstVertex;
+    const real_t* zs = HullZ.data() + hull.FirstVertex;
+#if defined(NYX_SIMD_DISPATCH)
+    const uint32_t best = getSimdLevel() >= SimdLevel::Sse4 ? hullSupportSse4(xs, ys, zs, hull.VertexCount, direction)
+                                                            : hullSupportScalar(xs, ys, zs, hull.VertexCount, direction);
+#else
+    const uint32_t best = hullSupportScalar(xs, ys, zs, hull.VertexCount, direction);
+#endif
+    return Vec3(xs[best], ys[best], zs[best]);
+}
+
+} // namespace nyx
@@ -0,0 +1,241 @@
+#include "nyx/physics/collision/sweep_and_prune.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+// Another axis must spread the bodies this much more before the order is rebuilt on it
+constexpr double kAxisSwitchRatio = 2.0;
+// More new bodies than count / kFullSortDivisor are cheaper to place with a full sort
+constexpr size_t kFullSortDivisor = 16;
+constexpr size_t kMinBodiesPerSlice = 2048;
+
+NYX_FORCEINLINE const LaneVector<real_t>& minLane(const AabbLanes& bounds, uint32_t axis) {
+    return axis == 0 ? bounds.MinX : (axis == 1 ? bounds.MinY : bounds.MinZ);
+}
+
+NYX_FORCEINLINE const LaneVector<real_t>& maxLane(const AabbLanes& bounds, uint32_t axis) {
+    return axis == 0 ? bounds.MaxX : (axis == 1 ? bounds.MaxY : bounds.MaxZ);
+}
+
+#if defined(NYX_SIMD_DISPATCH)
+// The arrays SweepAndPrune::sweep reads, all in sweep order
+struct SweepInput {
+    const real_t* Keys;
+    const real_t* Max;
+    const real_t* MinU;
+    const real_t* MaxU;
+    const real_t* MinV;
+    const real_t* MaxV;
+    const uint8_t* Awake;
+    const uint32_t* Order;
+    size_t Count;
+};
+
+// Tests eight later bodies at a time against k and writes the hits in order,
+// so the pairs come out exactly as the scalar sweep writes them
+NYX_TARGET_AVX2 void sweepAvx2(const SweepInput& in, size_t begin, size_t end, std::vector<BodyPair>& out) {
+    for (size_t k = begin; k < end; ++k) {
+        const real_t maxK = in.Max[k];
+        const __m256 vMaxK = _mm256_set1_ps(maxK);
+        const __m256 minU = _mm256_set1_ps(in.MinU[k]), maxU = _mm256_set1_ps(in.MaxU[k]);
+        const __m256 minV = _mm256_set1_ps(in.MinV[k]), maxV = _mm256_set1_ps(in.MaxV[k]);
+        const bool awakeK = in.Awake[k];
+
+        size_t m = k + 1;
+        bool done = false;
+        for (; m + 8 <= in.Count && !done; m += 8) {
+            // Keys are sorted, so the lanes still inside [min, max] of k are a prefix
+            const unsigned within = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(in.Keys + m), vMaxK, _CMP_LE_OQ)));
+            done = within != 0xFF;
+            // Not greater and not less, so NaNs compare as in the scalar sweep
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(in.MinU + m), maxU, _CMP_NGT_UQ),
+                                       _mm256_cmp_ps(_mm256_loadu_ps(in.MaxU + m), minU, _CMP_NLT_UQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(in.MinV + m), maxV, _CMP_NGT_UQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(in.MaxV + m), minV, _CMP_NLT_UQ));
+            unsigned bits = within & static_cast<unsigned>(_mm256_movemask_ps(hit));
+            if (!awakeK) {
+                const __m256i awake = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in.Awake + m)));
+                bits &= static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(awake, _mm256_setzero_si256()))));
+            }
+            for (; bits; bits &= bits - 1)
+                out.push_back(makeBodyPair(in.Order[k], in.Order[m + std::countr_zero(bits)]));
+        }
+        if (done)
+            continue;
+
+        for (; m < in.Count && in.Keys[m] <= maxK; ++m) {
+            if (!awakeK && !in.Awake[m]) continue;
+            if (in.MinU[m] > in.MaxU[k] || in.MaxU[m] < in.MinU[k]) continue;
+            if (in.MinV[m] > in.MaxV[k] || in.MaxV[m] < in.MinV[k]) continue;
+            out.push_back(makeBodyPair(in.Order[k], in.Order[m]));
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void SweepAndPrune::update(const RigidbodyData& data, JobSystem* jobs) {
+    const size_t count = data.getBounds().size();
+
+    chooseAxis(data);
+    sortOrder(data);
+    gatherSorted(data, jobs);
+
+    // The sweep is split into slices of the sorted order
+    parallelCollect(jobs, count, kMinBodiesPerSlice, SlicePairs, Pairs, [&](size_t begin, size_t end, std::vector<BodyPair>& out) {
+        sweep(begin, end, out);
+    });
+}
+
+void SweepAndPrune::chooseAxis(const RigidbodyData& data) {
+    const AabbLanes& bounds = data.getBounds();
+    const size_t count = bounds.size();
+    if (count < 2)
+        return;
+
+    double sum[3] = {0.0, 0.0, 0.0};
+    double sumSq[3] = {0.0, 0.0, 0.0};
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        const LaneVector<real_t>& mins = minLane(bounds, axis);
+        const LaneVector<real_t>& maxs = maxLane(bounds, axis);
+        for (size_t i = 0; i < count; ++i) {
+            const double center = 0.5 * (double(mins[i]) + double(maxs[i]));
+            sum[axis] += center;
+            sumSq[axis] += center * center;
+        }
+    }
+
+    double variance[3];
+    for (uint32_t axis = 0; axis < 3; ++axis)
+        variance[axis] = sumSq[axis] - sum[axis] * sum[axis] / double(count);
+
+    const uint32_t best = static_cast<uint32_t>(std::max_element(variance, variance + 3) - variance);
+    if (best != Axis && variance[best] > kAxisSwitchRatio * variance[Axis]) {
+        Axis = best;
+        OrderValid = false;
+    }
+}
+
+void SweepAndPrune::sortOrder(const RigidbodyData& data) {
+    const LaneVector<real_t>& mins = minLane(data.getBounds(), Axis);
+    const size_t count = mins.size();
+
+    // Order holds each index below its size once. Removed bodies were replaced by
+    // the last ones, so dropping the indices past the end leaves each moved body
+    // where the removed one was, for the insertion sort to repair.
+    if (Order.size() > count)
+        Order.erase(std::remove_if(Order.begin(), Order.end(), [&](uint32_t body) { return body >= count; }), Order.end());
+
+    const size_t displaced = count - Order.size() + Removed;
+    Removed = 0;
+    if (displaced > count / kFullSortDivisor) {
+        OrderValid = false;
+    } else if (Order.size() < count) {
+        // New bodies start at the end and are moved into place by the insertion sort
+        const size_t first = Order.size();
+        Order.resize(count);
+        std::iota(Order.begin() + first, Order.end(), static_cast<uint32_t>(first));
+    }
+
+    if (!OrderValid) {
+        Order.resize(count);
+        std::iota(Order.begin(), Order.end(), 0u);
+        std::sort(Order.begin(), Order.end(), [&](uint32_t a, uint32_t b) {
+            return mins[a] < mins[b] || (mins[a] == mins[b] && a < b);
+        });
+        Keys.resize(count);
+        for (size_t k = 0; k < count; ++k)
+            Keys[k] = mins[Order[k]];
+        OrderValid = true;
+        return;
+    }
+
+    Keys.resize(count);
+    for (size_t k = 0; k < count; ++k)
+        Keys[k] = mins[Order[k]];
+
+    // Insertion sort: bodies only swap with neighbours they actually passed since the last step
+    for (size_t k = 1; k < count; ++k) {
+        const real_t key = Keys[k];
+        if (Keys[k - 1] <= key)
+            continue;
+
+        const uint32_t body = Order[k];
+        size_t j = k;
+        do {
+            Keys[j] = Keys[j - 1];
+            Order[j] = Order[j - 1];
+            --j;
+        } while (j > 0 && Keys[j - 1] > key);
+        Keys[j] = key;
+        Order[j] = body;
+    }
+}
+
+void SweepAndPrune::gatherSorted(const RigidbodyData& data, JobSystem* jobs) {
+    const AabbLanes& bounds = data.getBounds();
+    const uint32_t u = (Axis + 1) % 3;
+    const uint32_t v = (Axis + 2) % 3;
+    const LaneVector<real_t>& maxs = maxLane(bounds, Axis);
+    const LaneVector<real_t>& minsU = minLane(bounds, u);
+    const LaneVector<real_t>& maxsU = maxLane(bounds, u);
+    const LaneVector<real_t>& minsV = minLane(bounds, v);
+    const LaneVector<real_t>& maxsV = maxLane(bounds, v);
+
+    const size_t count = Order.size();
+    for (LaneVector<real_t>* lane : {&SortedMax, &SortedMinU, &SortedMaxU, &SortedMinV, &SortedMaxV})
+        lane->resize(count);
+    SortedAwake.resize(count);
+
+    parallelFor(jobs, count, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = Order[k];
+            SortedMax[k] = maxs[i];
+            SortedMinU[k] = minsU[i];
+            SortedMaxU[k] = maxsU[i];
+            SortedMinV[k] = minsV[i];
+            SortedMaxV[k] = maxsV[i];
+            SortedAwake[k] = data.isAwake(i);
+        }
+    });
+}
+
+void SweepAndPrune::sweep(size_t begin, size_t end, std::vector<BodyPair>& out) const {
+    const size_t count = Order.size();
+#if defined(NYX_SIMD_DISPATCH)
+    if (getSimdLevel() >= SimdLevel::Avx2) {
+        const SweepInput in{Keys.data(), SortedMax.data(), SortedMinU.data(), SortedMaxU.data(), SortedMinV.data(), SortedMaxV.data(),
+                            SortedAwake.data(), Order.data(), count};
+        sweepAvx2(in, begin, end, out);
+        return;
+    }
+#endif
+    for (size_t k = begin; k < end; ++k) {
+        const real_t maxK = SortedMax[k];
+        const real_t minU = SortedMinU[k], maxU = SortedMaxU[k];
+        const real_t minV = SortedMinV[k], maxV = SortedMaxV[k];
+        const bool awakeK = SortedAwake[k];
+
+        // Every later body whose minimum lies inside [min, max] of k overlaps it on the sweep axis
+        for (size_t m = k + 1; m < count && Keys[m] <= maxK; ++m) {
+            if (!awakeK && !SortedAwake[m]) continue;
+            if (SortedMinU[m] > maxU || SortedMaxU[m] < minU) continue;
+            if (SortedMinV[m] > maxV || SortedMaxV[m] < minV) continue;
+            out.push_back(makeBodyPair(Order[k], Order[m]));
+        }
+    }
+}
+
+} // namespace nyx
@@ -1,80 +1,520 @@
 #include "nyx/physics/rigidbody/rigidbody_system.h"
+#include "nyx/core/cpu_features.h"
+#include "nyx/core/trace.h"
 #include "nyx/math/vec3_naive.h"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
 
 namespace nyx {
 
-RigidbodyData::RigidbodyData() {
-    Positions.reserve(kInitialEntityCount);
-    Velocities.reserve(kInitialEntityCount);
-    AngularVelocities.reserve(kInitialEntityCount);
-    Orientations.reserve(kInitialEntityCount);
-    Masses.reserve(kInitialEntityCount);
-    InvMasses.reserve(kInitialEntityCount);
-    Inertias.reserve(kInitialEntityCount);
-    InvInertias.reserve(kInitialEntityCount);
-    Active.reserve(kInitialEntityCount);
+namespace {
+
+// Spheres, boxes and anything else given in its principal frame only need the reciprocals
+NYX_FORCEINLINE SymMat3 invertInertia(const SymMat3& inertia) {
+    if (!inertia.isDiagonal())
+        return inertia.inverse();
+    return SymMat3(1.0f / inertia.XX, 1.0f / inertia.YY, 1.0f / inertia.ZZ, 0.0f, 0.0f, 0.0f);
 }
 
-RigidbodySystem::RigidbodySystem() {
-    // No additional initialization needed; RigidbodyData constructor handles it
+#if defined(NYX_SIMD_DISPATCH)
+NYX_FORCEINLINE NYX_TARGET_AVX2 __m256 minor(__m256 a, __m256 b, __m256 c, __m256 d) {
+    return _mm256_sub_ps(_mm256_mul_ps(a, b), _mm256_mul_ps(c, d));
 }
 
-size_t RigidbodySystem::addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
+// Whole batches of eight only; returns how many inertias it inverted. Batches
+// with any off-diagonal term run the cofactor inverse of SymMat3::inverse in AVX lanes.
+NYX_TARGET_AVX2 size_t invertInertiasAvx2(const SymMat3* inertias, SymMat3* inverses, size_t count) {
+    static_assert(sizeof(SymMat3) == 6 * sizeof(float), "SymMat3 must be six packed floats");
+    const __m256i stride = _mm256_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42);
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vMinDet = _mm256_set1_ps(1e-6f);
+    const __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        bool diagonal = true;
+        for (size_t k = 0; k < 8 && diagonal; ++k)
+            diagonal = inertias[i + k].isDiagonal();
+        if (diagonal) {
+            for (size_t k = 0; k < 8; ++k)
+                inverses[i + k] = invertInertia(inertias[i + k]);
+            continue;
+        }
+
+        // XX, YY, ZZ, XY, XZ, YZ
+        const float* base = &inertias[i].XX;
+        __m256 m[6];
+        for (int e = 0; e < 6; ++e)
+            m[e] = _mm256_i32gather_ps(base + e, stride, sizeof(float));
+
+        __m256 r[6];
+        r[0] = minor(m[1], m[2], m[5], m[5]);
+        r[1] = minor(m[0], m[2], m[4], m[4]);
+        r[2] = minor(m[0], m[1], m[3], m[3]);
+        r[3] = minor(m[4], m[5], m[3], m[2]);
+        r[4] = minor(m[3], m[5], m[4], m[1]);
+        r[5] = minor(m[4], m[3], m[0], m[5]);
+
+        // det = XX r0 - XY (XY ZZ - YZ XZ) + XZ r4, written as SymMat3::inverse expands it
+        const __m256 det = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(m[0], r[0]), _mm256_mul_ps(m[3], minor(m[3], m[2], m[5], m[4]))),
+                                         _mm256_mul_ps(m[4], r[4]));
+        const __m256 invDet = _mm256_div_ps(vOne, det);
+        // Singular tensors invert to the identity, like SymMat3::inverse
+        const __m256 singular = _mm256_cmp_ps(_mm256_and_ps(det, vAbs), vMinDet, _CMP_LT_OQ);
+        // Diagonal tensors in the batch take the reciprocals, like invertInertia
+        __m256 offDiagonal = vZero;
+        for (int e : {3, 4, 5})
+            offDiagonal = _mm256_or_ps(offDiagonal, _mm256_cmp_ps(m[e], vZero, _CMP_NEQ_UQ));
+
+        alignas(32) float out[6][8];
+        for (int e = 0; e < 6; ++e) {
+            const __m256 identity = e < 3 ? vOne : vZero;
+            const __m256 diagonal = e < 3 ? _mm256_div_ps(vOne, m[e]) : vZero;
+            const __m256 inverse = _mm256_blendv_ps(_mm256_mul_ps(r[e], invDet), identity, singular);
+            _mm256_store_ps(out[e], _mm256_blendv_ps(diagonal, inverse, offDiagonal));
+        }
+        for (size_t k = 0; k < 8; ++k)
+            inverses[i + k] = SymMat3(out[0][k], out[1][k], out[2][k], out[3][k], out[4][k], out[5][k]);
+    }
+    return i;
+}
+#endif
+
+// invertInertia over an array
+void invertInertias(const SymMat3* inertias, SymMat3* inverses, size_t count) {
+    size_t i = 0;
+#if defined(NYX_SIMD_DISPATCH)
+    if (getSimdLevel() >= SimdLevel::Avx2)
+        i = invertInertiasAvx2(inertias, inverses, count);
+#endif
+    for (; i < count; ++i)
+        inverses[i] = invertInertia(inertias[i]);
+}
+
+} // namespace
+
+RigidbodyData::RigidbodyData(size_t capacity) {
+    reserve(capacity);
+}
+
+void RigidbodyData::reserve(size_t count) {
+    Positions.reserve(count);
+    Velocities.reserve(count);
+    AngularVelocities.reserve(count);
+    Orientations.reserve(count);
+    Forces.reserve(count);
+    Torques.reserve(count);
+    Masses.reserve(count);
+    InvMasses.reserve(count);
+    Inertias.reserve(count);
+    InvInertias.reserve(count);
+    WorldInvInertias.reserve(count);
+    Active.reserve(count);
+    SleepTimes.reserve(count);
+    SleepIslands.reserve(count);
+    NextInIsland.reserve(count);
+    AwakeBodies.reserve(count);
+    AwakeSlots.reserve(count);
+    BoundingRadii.reserve(count);
+    Handles.reserve(count);
+    HandleSlots.reserve(count);
+    Bounds.reserve(count);
+}
+
+bool RigidbodyData::isConsistent() const {
+    const size_t count = Positions.size();
+    // Handle slots are sparse and free slots a stack; everything else is per body
+    const size_t sizes[] = {Velocities.size(), AngularVelocities.size(), Orientations.size(), Forces.size(), Torques.size(),
+                            Masses.size(), InvMasses.size(), Inertias.size(), InvInertias.size(), Active.size(), SleepTimes.size(),
+                            SleepIslands.size(), NextInIsland.size(), BoundingRadii.size(), Handles.size()};
+    if (std::any_of(std::begin(sizes), std::end(sizes), [count](size_t size) { return size != count; }))
+        return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        const RigidbodyHandle handle = Handles[i];
+        if (handle.Slot >= HandleSlots.size() || HandleSlots[handle.Slot].Body != i || HandleSlots[handle.Slot].Generation != handle.Generation)
+            return false;
+    }
+    for (uint32_t slot : FreeHandleSlots) {
+        if (slot >= HandleSlots.size())
+            return false;
+    }
+
+    // Islands are lists from a head naming itself, and no body is reached twice,
+    // so waking one walks a finite chain
+    std::vector<uint8_t> linked(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t island = SleepIslands[i], next = NextInIsland[i];
+        if (island != kNoIsland && (island >= count || SleepIslands[island] != island))
+            return false;
+        if (next == kNoIsland)
+            continue;
+        if (next >= count || island == kNoIsland || SleepIslands[next] != island || next == island || linked[next])
+            return false;
+        linked[next] = 1;
+    }
+    return true;
+}
+
+RigidbodySystem::RigidbodySystem(size_t capacity) : Data(capacity) {}
+
+RigidbodyHandle RigidbodySystem::addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
     assert(mass > 0.0f && "Mass must be positive");
     assert(inertia.isValid() && "Inertia tensor must be valid");
+    assert(inertia.isSymmetric() && "Inertia tensor must be symmetric");
 
     size_t index = Data.Positions.size();
     Data.Positions.push_back(pos);
     Data.Velocities.push_back(vel);
     Data.AngularVelocities.push_back(Vec3(0.0f, 0.0f, 0.0f));
     Data.Orientations.push_back(Quaternion::identity());
+    Data.Forces.push_back(Vec3(0.0f, 0.0f, 0.0f));
+    Data.Torques.push_back(Vec3(0.0f, 0.0f, 0.0f));
     Data.Masses.push_back(mass);
     Data.InvMasses.push_back(1.0f / mass);
-    Data.Inertias.push_back(inertia);
-    Data.InvInertias.push_back(inertia.inverse());
+    Data.Inertias.push_back(SymMat3(inertia));
+    Data.InvInertias.push_back(invertInertia(Data.Inertias.back()));
     Data.Active.push_back(1); // Active by default
+    Data.SleepTimes.push_back(0.0f);
+    Data.SleepIslands.push_back(RigidbodyData::kNoIsland);
+    Data.NextInIsland.push_back(RigidbodyData::kNoIsland);
+    Data.AwakeSlots.push_back(RigidbodyData::kNotAwake);
+    Data.BoundingRadii.push_back(RigidbodyData::kDefaultBoundingRadius);
+    Data.BoundsStale = true;
+    Data.AwakeStale = true;
+
+    const RigidbodyHandle handle = allocateHandle(index);
+    Data.Handles.push_back(handle);
+    return handle;
+}
+
+void RigidbodySystem::addRigidbodies(std::span<const RigidbodyDesc> bodies, RigidbodyHandle* handles) {
+    const size_t first = Data.size();
+    const size_t count = first + bodies.size();
+
+    // One exact allocation per array instead of repeated doubling
+    Data.Positions.resize(count);
+    Data.Velocities.resize(count);
+    Data.AngularVelocities.resize(count, Vec3(0.0f, 0.0f, 0.0f));
+    Data.Orientations.resize(count, Quaternion::identity());
+    Data.Forces.resize(count, Vec3(0.0f, 0.0f, 0.0f));
+    Data.Torques.resize(count, Vec3(0.0f, 0.0f, 0.0f));
+    Data.Masses.resize(count);
+    Data.InvMasses.resize(count);
+    Data.Inertias.resize(count);
+    Data.InvInertias.resize(count);
+    Data.Active.resize(count, 1);
+    Data.SleepTimes.resize(count, 0.0f);
+    Data.SleepIslands.resize(count, RigidbodyData::kNoIsland);
+    Data.NextInIsland.resize(count, RigidbodyData::kNoIsland);
+    Data.AwakeSlots.resize(count, RigidbodyData::kNotAwake);
+    Data.BoundingRadii.resize(count, RigidbodyData::kDefaultBoundingRadius);
+    Data.Handles.resize(count);
+
+    // Free slots are handed out in the same order as by addRigidbody
+    Data.HandleSlots.reserve(Data.HandleSlots.size() + bodies.size() - std::min(bodies.size(), Data.FreeHandleSlots.size()));
+    for (size_t i = first; i < count; ++i) {
+        Data.Handles[i] = allocateHandle(i);
+        if (handles)
+            handles[i - first] = Data.Handles[i];
+    }
+
+    parallelFor(Jobs, bodies.size(), kLaneWidth, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const RigidbodyDesc& body = bodies[k];
+            assert(body.Mass > 0.0f && "Mass must be positive");
+            assert(body.Inertia.isValid() && "Inertia tensor must be valid");
+            assert(body.Inertia.isSymmetric() && "Inertia tensor must be symmetric");
+
+            const size_t i = first + k;
+            Data.Positions[i] = body.Position;
+            Data.Velocities[i] = body.Velocity;
+            Data.Masses[i] = body.Mass;
+            Data.InvMasses[i] = 1.0f / body.Mass;
+            Data.Inertias[i] = SymMat3(body.Inertia);
+        }
+        invertInertias(Data.Inertias.data() + first + begin, Data.InvInertias.data() + first + begin, end - begin);
+    });
+
+    Data.BoundsStale = true;
+    Data.AwakeStale = true;
+}
+
+RigidbodyHandle RigidbodySystem::allocateHandle(size_t index) {
+    RigidbodyHandle handle;
+    if (Data.FreeHandleSlots.empty()) {
+        handle.Slot = static_cast<uint32_t>(Data.HandleSlots.size());
+        Data.HandleSlots.push_back({0, 0});
+    } else {
+        handle.Slot = Data.FreeHandleSlots.back();
+        Data.FreeHandleSlots.pop_back();
+    }
+    RigidbodyData::HandleSlot& slot = Data.HandleSlots[handle.Slot];
+    slot.Body = static_cast<uint32_t>(index);
+    handle.Generation = slot.Generation;
+    return handle;
+}
+
+void RigidbodySystem::removeRigidbody(RigidbodyHandle handle) {
+    const uint32_t body = static_cast<uint32_t>(Data.getIndex(handle));
+    const uint32_t last = static_cast<uint32_t>(Data.size() - 1);
+    wake(body);
+
+    // The last body keeps its place in its sleeping island under its new index
+    if (Data.SleepIslands[last] != RigidbodyData::kNoIsland && last != body) {
+        for (uint32_t other = Data.SleepIslands[last]; other != RigidbodyData::kNoIsland; other = Data.NextInIsland[other]) {
+            if (Data.SleepIslands[other] == last)
+                Data.SleepIslands[other] = body;
+            if (Data.NextInIsland[other] == last)
+                Data.NextInIsland[other] = body;
+        }
+    }
 
-    return index;
+    auto swapAndPop = [&](auto& v) {
+        v[body] = v[last];
+        v.pop_back();
+    };
+    swapAndPop(Data.Positions);
+    swapAndPop(Data.Velocities);
+    swapAndPop(Data.AngularVelocities);
+    swapAndPop(Data.Orientations);
+    swapAndPop(Data.Forces);
+    swapAndPop(Data.Torques);
+    swapAndPop(Data.Masses);
+    swapAndPop(Data.InvMasses);
+    swapAndPop(Data.Inertias);
+    swapAndPop(Data.InvInertias);
+    swapAndPop(Data.Active);
+    swapAndPop(Data.SleepTimes);
+    swapAndPop(Data.SleepIslands);
+    swapAndPop(Data.NextInIsland);
+    swapAndPop(Data.AwakeSlots);
+    swapAndPop(Data.BoundingRadii);
+    swapAndPop(Data.Handles);
+    if (Data.Bounds.size() == last + 1) {
+        AabbLanes& b = Data.Bounds;
+        for (LaneVector<real_t>* lane : {&b.MinX, &b.MinY, &b.MinZ, &b.MaxX, &b.MaxY, &b.MaxZ})
+            swapAndPop(*lane);
+    }
+
+    // Old handles to the slot stop matching; the moved body's handle follows it
+    ++Data.HandleSlots[handle.Slot].Generation;
+    Data.FreeHandleSlots.push_back(handle.Slot);
+    if (body != last)
+        Data.HandleSlots[Data.Handles[body].Slot].Body = body;
+
+    // Indices in the awake list are out of date; it is rebuilt once by the
+    // next step however many bodies were removed
+    Data.AwakeStale = true;
+}
+
+void RigidbodySystem::restored() {
+    Woken.clear();
+    AwakeChanged = false;
+    Data.AwakeStale = true;
+    Data.BoundsStale = true;
+    Data.AwakeSlots.resize(Data.Active.size());
+    updateAwakeBodies();
+    updateBounds();
 }
 
 void RigidbodySystem::update(real_t dt) {
-    integrate(dt);
-    clearForces(); // Forces are typically cleared after integration
+    // Semi-implicit Euler: velocities first, then positions with the new velocities
+    integrateVelocities(dt);
+    integratePositions(dt);
+}
+
+void RigidbodySystem::integratePositions(real_t dt) {
+    {
+        NYX_PROFILE_SCOPE(Stats.Positions);
+        integrate(dt);
+        clearForces(); // Forces are typically cleared after integration
+    }
+
+    NYX_PROFILE_SCOPE(Stats.Bounds);
+    updateBounds();
 }
 
 void RigidbodySystem::applyImpulse(size_t index, const Vec3& impulse, const Vec3& contactVector) {
     assert(index < Data.Positions.size() && "Invalid rigidbody index");
     if (!Data.Active[index]) return;
+    wake(index);
 
     // Linear velocity change: v += impulse / mass
     Data.Velocities[index] += impulse * Data.InvMasses[index];
 
-    // Angular velocity change: ω += I⁻¹ * (r × impulse)
+    // Angular velocity change: ω += I⁻¹ * (r × impulse), I⁻¹ in world space
     Vec3 torque = cross(contactVector,  impulse);
-    Data.AngularVelocities[index] += Data.InvInertias[index] * torque;
+    Data.AngularVelocities[index] += applyWorldInvInertia(Data.Orientations[index], Data.InvInertias[index], torque);
 }
 
-void RigidbodySystem::integrate(real_t dt) {
-    for (size_t i = 0; i < Data.Positions.size(); ++i) {
-        if (!Data.Active[i]) continue;
+void RigidbodySystem::wake(size_t index) {
+    assert(index < Data.Positions.size() && "Invalid rigidbody index");
+    const uint32_t island = Data.SleepIslands[index];
+    if (island == RigidbodyData::kNoIsland)
+        return;
 
-        // Update position: p += v * dt
-        Data.Positions[i] += Data.Velocities[i] * dt;
+    for (uint32_t body = island; body != RigidbodyData::kNoIsland;) {
+        const uint32_t next = Data.NextInIsland[body];
+        Data.SleepIslands[body] = RigidbodyData::kNoIsland;
+        Data.NextInIsland[body] = RigidbodyData::kNoIsland;
+        Data.SleepTimes[body] = 0.0f;
+        if (Data.Active[body])
+            Woken.push_back(body);
+        body = next;
+    }
+}
+
+void RigidbodySystem::sleep(const uint32_t* bodies, size_t count) {
+    if (count == 0)
+        return;
+
+    // The island is a list threaded through NextInIsland, named by its first body
+    const uint32_t island = bodies[0];
+    for (size_t k = 0; k < count; ++k) {
+        const uint32_t body = bodies[k];
+        assert(Data.SleepIslands[body] == RigidbodyData::kNoIsland && "Body is already asleep");
+        Data.SleepIslands[body] = island;
+        Data.NextInIsland[body] = k + 1 < count ? bodies[k + 1] : RigidbodyData::kNoIsland;
+        Data.Velocities[body] = Vec3(0.0f, 0.0f, 0.0f);
+        Data.AngularVelocities[body] = Vec3(0.0f, 0.0f, 0.0f);
+    }
+    AwakeChanged = true;
+}
+
+void RigidbodySystem::updateAwakeBodies() {
+    LaneVector<uint32_t>& awake = Data.AwakeBodies;
+    LaneVector<uint32_t>& slots = Data.AwakeSlots;
 
-        // Update orientation: q += 0.5 * ω * q * dt
-        Quaternion omega(0.0f, Data.AngularVelocities[i].X, Data.AngularVelocities[i].Y, Data.AngularVelocities[i].Z);
-        Data.Orientations[i] += 0.5f * omega * Data.Orientations[i] * dt;
-        Data.Orientations[i].normalize();
+    if (Data.AwakeStale) {
+        awake.clear();
+        for (size_t i = 0; i < Data.Active.size(); ++i) {
+            slots[i] = RigidbodyData::kNotAwake;
+            if (Data.isAwake(i))
+                awake.push_back(static_cast<uint32_t>(i));
+        }
+    } else if (AwakeChanged || !Woken.empty()) {
+        // Drop the bodies that fell asleep, then merge the woken ones back in order
+        const auto asleep = std::remove_if(awake.begin(), awake.end(), [&](uint32_t body) {
+            if (Data.isAwake(body))
+                return false;
+            slots[body] = RigidbodyData::kNotAwake;
+            return true;
+        });
+        awake.erase(asleep, awake.end());
 
-        // Note: Velocities and angular velocities are not updated here (assume forces/impulses handle it)
+        const size_t kept = awake.size();
+        for (uint32_t body : Woken) {
+            if (Data.isAwake(body) && slots[body] == RigidbodyData::kNotAwake) {
+                slots[body] = 0; // claimed, so a body woken twice is added once
+                awake.push_back(body);
+            }
+        }
+        std::sort(awake.begin() + kept, awake.end());
+        std::inplace_merge(awake.begin(), awake.begin() + kept, awake.end());
+    } else {
+        return;
     }
+
+    for (size_t k = 0; k < awake.size(); ++k)
+        slots[awake[k]] = static_cast<uint32_t>(k);
+    Woken.clear();
+    AwakeChanged = false;
+    Data.AwakeStale = false;
+}
+
+void RigidbodySystem::setBoundingRadius(size_t index, real_t radius) {
+    assert(index < Data.Positions.size() && "Invalid rigidbody index");
+    assert(radius >= 0.0f && "Bounding radius must not be negative");
+    Data.BoundingRadii[index] = radius;
+    Data.BoundsStale = true;
+}
+
+void RigidbodySystem::integrateVelocities(real_t dt) {
+    {
+        NYX_PROFILE_SCOPE(Stats.AwakeList);
+        updateAwakeBodies();
+    }
+
+    NYX_PROFILE_SCOPE(Stats.Velocities);
+    Stats.Integrated = static_cast<uint32_t>(Data.AwakeBodies.size());
+
+    const Vec3 gravityStep = Gravity * dt;
+    const LaneVector<uint32_t>& awake = Data.AwakeBodies;
+    Data.WorldInvInertias.resize(awake.size());
+
+    parallelFor(Jobs, awake.size(), kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        NYX_TRACE_SCOPE("Integrate velocities");
+        // World tensors for the chunk first, kept for the solver
+        rotateTensors(Data.Orientations.data(), Data.InvInertias.data(), Data.WorldInvInertias.data() + begin, &awake[begin], end - begin);
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = awake[k];
+
+            // v += (F / m + g) * dt
+            Data.Velocities[i] += Data.Forces[i] * (Data.InvMasses[i] * dt) + gravityStep;
+
+            // ω += I⁻¹ * τ * dt
+            Data.AngularVelocities[i] += Data.WorldInvInertias[k] * (Data.Torques[i] * dt);
+        }
+    });
+}
+
+void RigidbodySystem::integrate(real_t dt) {
+    const LaneVector<uint32_t>& awake = Data.AwakeBodies;
+    parallelFor(Jobs, awake.size(), kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        NYX_TRACE_SCOPE("Integrate positions");
+        // Update position: p += v * dt
+        for (size_t k = begin; k < end; ++k)
+            Data.Positions[awake[k]] += Data.Velocities[awake[k]] * dt;
+
+        // Update orientation: q += 0.5 * ω * q * dt, several bodies at a time
+        integrateMany(Data.Orientations.data(), Data.AngularVelocities.data(), dt, &awake[begin], end - begin);
+    });
 }
 
 void RigidbodySystem::clearForces() {
-    // Currently, no accumulated forces are stored, so this is a no-op
-    // If forces are added later, reset them here
+    const LaneVector<uint32_t>& awake = Data.AwakeBodies;
+    parallelFor(Jobs, awake.size(), kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            Data.Forces[awake[k]] = Vec3(0.0f, 0.0f, 0.0f);
+            Data.Torques[awake[k]] = Vec3(0.0f, 0.0f, 0.0f);
+        }
+    });
+}
+
+void RigidbodySystem::updateBounds() {
+    auto refresh = [&](size_t i) {
+        AabbLanes& b = Data.Bounds;
+        const Vec3& p = Data.Positions[i];
+        const real_t r = Data.BoundingRadii[i];
+        b.MinX[i] = p.X - r; b.MinY[i] = p.Y - r; b.MinZ[i] = p.Z - r;
+        b.MaxX[i] = p.X + r; b.MaxY[i] = p.Y + r; b.MaxZ[i] = p.Z + r;
+    };
+
+    // Only awake bodies move, unless someone wrote positions or radii directly
+    if (Data.BoundsStale || Data.Bounds.size() != Data.Positions.size()) {
+        Data.Bounds.resize(Data.Positions.size());
+        parallelFor(Jobs, Data.Positions.size(), kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                refresh(i);
+        });
+        Data.BoundsStale = false;
+        return;
+    }
+
+    const LaneVector<uint32_t>& awake = Data.AwakeBodies;
+    parallelFor(Jobs, awake.size(), kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k)
+            refresh(awake[k]);
+    });
 }
 
-} // namespace nyx
\ No newline at end of file
+} // namespace nyx
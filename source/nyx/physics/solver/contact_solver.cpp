@@ -0,0 +1,536 @@
+#include "nyx/physics/solver/contact_solver.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+
+namespace nyx {
+
+namespace {
+
+constexpr size_t kMinBodiesPerChunk = 1024;
+constexpr size_t kMinBatchesPerChunk = 16;
+constexpr uint8_t kSkipped = 0xFF;
+constexpr uint32_t kPadding = ~0u;
+
+// kSolverWidth floats, one per manifold of a batch. Generic vectors rather than
+// intrinsics: the same code becomes AVX, SSE or plain instructions depending on
+// the target of the kernel it is inlined into, see BatchKernels.
+#if !defined(USE_DOUBLE_PRECISION)
+typedef float WideVector __attribute__((vector_size(kSolverWidth * sizeof(float))));
+typedef int32_t WideBits __attribute__((vector_size(kSolverWidth * sizeof(float))));
+
+struct Wide {
+    WideVector V;
+
+    static NYX_FORCEINLINE Wide load(const real_t* p) {
+        Wide w;
+        __builtin_memcpy(&w.V, p, sizeof(w.V));
+        return w;
+    }
+    static NYX_FORCEINLINE Wide set(real_t x) { return {WideVector{} + x}; }
+    NYX_FORCEINLINE void store(real_t* p) const { __builtin_memcpy(p, &V, sizeof(V)); }
+};
+
+NYX_FORCEINLINE Wide operator+(Wide a, Wide b) { return {a.V + b.V}; }
+NYX_FORCEINLINE Wide operator-(Wide a, Wide b) { return {a.V - b.V}; }
+NYX_FORCEINLINE Wide operator*(Wide a, Wide b) { return {a.V * b.V}; }
+NYX_FORCEINLINE Wide min(Wide a, Wide b) { return {a.V < b.V ? a.V : b.V}; }
+NYX_FORCEINLINE Wide max(Wide a, Wide b) { return {a.V > b.V ? a.V : b.V}; }
+NYX_FORCEINLINE Wide abs(Wide a) { return {reinterpret_cast<WideVector>(reinterpret_cast<WideBits>(a.V) & 0x7FFFFFFF)}; }
+#else
+// Reference path for double precision
+struct Wide {
+    real_t V;
+
+    static NYX_FORCEINLINE Wide load(const real_t* p) { return {*p}; }
+    static NYX_FORCEINLINE Wide set(real_t x) { return {x}; }
+    NYX_FORCEINLINE void store(real_t* p) const { *p = V; }
+};
+
+NYX_FORCEINLINE Wide operator+(Wide a, Wide b) { return {a.V + b.V}; }
+NYX_FORCEINLINE Wide operator-(Wide a, Wide b) { return {a.V - b.V}; }
+NYX_FORCEINLINE Wide operator*(Wide a, Wide b) { return {a.V * b.V}; }
+NYX_FORCEINLINE Wide min(Wide a, Wide b) { return {std::min(a.V, b.V)}; }
+NYX_FORCEINLINE Wide max(Wide a, Wide b) { return {std::max(a.V, b.V)}; }
+NYX_FORCEINLINE Wide abs(Wide a) { return {std::abs(a.V)}; }
+#endif
+
+struct Wide3 {
+    Wide X, Y, Z;
+
+    static NYX_FORCEINLINE Wide3 load(const real_t (*p)[kSolverWidth]) { return {Wide::load(p[0]), Wide::load(p[1]), Wide::load(p[2])}; }
+};
+
+NYX_FORCEINLINE Wide3 operator+(const Wide3& a, const Wide3& b) { return {a.X + b.X, a.Y + b.Y, a.Z + b.Z}; }
+NYX_FORCEINLINE Wide3 operator-(const Wide3& a, const Wide3& b) { return {a.X - b.X, a.Y - b.Y, a.Z - b.Z}; }
+NYX_FORCEINLINE Wide3 operator*(const Wide3& a, Wide s) { return {a.X * s, a.Y * s, a.Z * s}; }
+NYX_FORCEINLINE Wide dot(const Wide3& a, const Wide3& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+NYX_FORCEINLINE Wide3 cross(const Wide3& a, const Wide3& b) {
+    return {a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X};
+}
+
+// Symmetric 3x3 stored as xx yy zz xy xz yz
+struct WideSymmetric {
+    Wide M[6];
+
+    static NYX_FORCEINLINE WideSymmetric load(const real_t (*p)[kSolverWidth]) {
+        return {{Wide::load(p[0]), Wide::load(p[1]), Wide::load(p[2]), Wide::load(p[3]), Wide::load(p[4]), Wide::load(p[5])}};
+    }
+
+    NYX_FORCEINLINE Wide3 operator*(const Wide3& v) const {
+        return {M[0] * v.X + M[3] * v.Y + M[4] * v.Z,
+                M[3] * v.X + M[1] * v.Y + M[5] * v.Z,
+                M[4] * v.X + M[5] * v.Y + M[2] * v.Z};
+    }
+};
+
+NYX_FORCEINLINE Vec3 applySymmetric(const real_t (&m)[6], const Vec3& v) {
+    return Vec3(m[0] * v.X + m[3] * v.Y + m[4] * v.Z,
+                m[3] * v.X + m[1] * v.Y + m[5] * v.Z,
+                m[4] * v.X + m[5] * v.Y + m[2] * v.Z);
+}
+
+// Two unit vectors spanning the plane perpendicular to n
+NYX_FORCEINLINE void tangentBasis(const Vec3& n, Vec3& t0, Vec3& t1) {
+    if (std::abs(n.X) >= 0.57735f)
+        t0 = Vec3(n.Y, -n.X, 0.0f);
+    else
+        t0 = Vec3(0.0f, n.Z, -n.Y);
+    t0 *= 1.0f / t0.length();
+    t1 = cross(n, t0);
+}
+
+NYX_FORCEINLINE void storeLane(real_t (*dst)[kSolverWidth], uint32_t lane, const Vec3& v) {
+    dst[0][lane] = v.X;
+    dst[1][lane] = v.Y;
+    dst[2][lane] = v.Z;
+}
+
+// Velocities of the two bodies of every lane, loaded from and stored back to
+// the solver bodies. Lanes of a batch never share a moving body.
+struct BatchVelocities {
+    Wide3 VA, WA, VB, WB;
+
+    template <typename Batch, typename Body>
+    NYX_FORCEINLINE void gather(const Batch& b, const Body* bodies) {
+        alignas(kSolverWidth * sizeof(real_t)) real_t lanes[12][kSolverWidth];
+        for (uint32_t lane = 0; lane < kSolverWidth; ++lane) {
+            const Body& a = bodies[b.BodyA[lane]];
+            const Body& c = bodies[b.BodyB[lane]];
+            for (int k = 0; k < 3; ++k) {
+                lanes[k][lane] = a.V[k];
+                lanes[3 + k][lane] = a.W[k];
+                lanes[6 + k][lane] = c.V[k];
+                lanes[9 + k][lane] = c.W[k];
+            }
+        }
+        VA = Wide3::load(lanes);
+        WA = Wide3::load(lanes + 3);
+        VB = Wide3::load(lanes + 6);
+        WB = Wide3::load(lanes + 9);
+    }
+
+    template <typename Batch, typename Body>
+    NYX_FORCEINLINE void scatter(const Batch& b, Body* bodies) const {
+        alignas(kSolverWidth * sizeof(real_t)) real_t lanes[12][kSolverWidth];
+        const Wide3* parts[4] = {&VA, &WA, &VB, &WB};
+        for (int p = 0; p < 4; ++p) {
+            parts[p]->X.store(lanes[p * 3]);
+            parts[p]->Y.store(lanes[p * 3 + 1]);
+            parts[p]->Z.store(lanes[p * 3 + 2]);
+        }
+        // Body 0 is shared by every static side, so it is never written
+        for (uint32_t lane = 0; lane < kSolverWidth; ++lane) {
+            if (b.BodyA[lane]) {
+                Body& a = bodies[b.BodyA[lane]];
+                for (int k = 0; k < 3; ++k) { a.V[k] = lanes[k][lane]; a.W[k] = lanes[3 + k][lane]; }
+            }
+            if (b.BodyB[lane]) {
+                Body& c = bodies[b.BodyB[lane]];
+                for (int k = 0; k < 3; ++k) { c.V[k] = lanes[6 + k][lane]; c.W[k] = lanes[9 + k][lane]; }
+            }
+        }
+    }
+
+    // +impulse to B, -impulse to A at the point's offsets
+    NYX_FORCEINLINE void apply(const Wide3& impulse, const Wide3& ra, const Wide3& rb, Wide invMassA, Wide invMassB,
+                               const WideSymmetric& invInertiaA, const WideSymmetric& invInertiaB) {
+        VA = VA - impulse * invMassA;
+        WA = WA - invInertiaA * cross(ra, impulse);
+        VB = VB + impulse * invMassB;
+        WB = WB + invInertiaB * cross(rb, impulse);
+    }
+
+    NYX_FORCEINLINE Wide3 relative(const Wide3& ra, const Wide3& rb) const {
+        return VB + cross(WB, rb) - VA - cross(WA, ra);
+    }
+};
+
+template <typename Batch, typename Body>
+NYX_FORCEINLINE void warmStartBatch(const Batch& b, Body* bodies) {
+    BatchVelocities v;
+    v.gather(b, bodies);
+
+    const Wide invMassA = Wide::load(b.InvMassA), invMassB = Wide::load(b.InvMassB);
+    const WideSymmetric invInertiaA = WideSymmetric::load(b.InvInertiaA), invInertiaB = WideSymmetric::load(b.InvInertiaB);
+    const Wide3 n = Wide3::load(b.Normal);
+    const Wide3 t0 = Wide3::load(b.Tangent[0]), t1 = Wide3::load(b.Tangent[1]);
+
+    // Padding points have zero impulses and push nothing
+    for (const auto& p : b.Points) {
+        const Wide3 impulse = n * Wide::load(p.NormalImpulse) + t0 * Wide::load(p.TangentImpulse[0]) + t1 * Wide::load(p.TangentImpulse[1]);
+        v.apply(impulse, Wide3::load(p.RA), Wide3::load(p.RB), invMassA, invMassB, invInertiaA, invInertiaB);
+    }
+    v.scatter(b, bodies);
+}
+
+// One Gauss-Seidel pass over the points of every lane; returns the largest
+// change of a normal impulse
+template <typename Batch, typename Body>
+NYX_FORCEINLINE real_t solveBatch(Batch& b, Body* bodies, real_t friction) {
+    BatchVelocities v;
+    v.gather(b, bodies);
+
+    const Wide zero = Wide::set(0.0f);
+    const Wide invMassA = Wide::load(b.InvMassA), invMassB = Wide::load(b.InvMassB);
+    const WideSymmetric invInertiaA = WideSymmetric::load(b.InvInertiaA), invInertiaB = WideSymmetric::load(b.InvInertiaB);
+    const Wide3 n = Wide3::load(b.Normal);
+    const Wide3 tangents[2] = {Wide3::load(b.Tangent[0]), Wide3::load(b.Tangent[1])};
+    Wide delta = zero;
+
+    for (auto& p : b.Points) {
+        const Wide3 ra = Wide3::load(p.RA), rb = Wide3::load(p.RB);
+
+        // Friction first, bounded by the normal impulse of the previous pass
+        const Wide maxFriction = Wide::set(friction) * Wide::load(p.NormalImpulse);
+        const Wide minFriction = zero - maxFriction;
+        for (int t = 0; t < 2; ++t) {
+            const Wide vt = dot(v.relative(ra, rb), tangents[t]);
+            const Wide previous = Wide::load(p.TangentImpulse[t]);
+            const Wide accumulated = min(max(previous - vt * Wide::load(p.TangentMass[t]), minFriction), maxFriction);
+            accumulated.store(p.TangentImpulse[t]);
+            v.apply(tangents[t] * (accumulated - previous), ra, rb, invMassA, invMassB, invInertiaA, invInertiaB);
+        }
+
+        // The accumulated normal impulse may shrink, but never pull the bodies together
+        const Wide vn = dot(v.relative(ra, rb), n);
+        const Wide previous = Wide::load(p.NormalImpulse);
+        const Wide accumulated = max(previous + (Wide::load(p.Bias) - vn) * Wide::load(p.NormalMass), zero);
+        accumulated.store(p.NormalImpulse);
+        v.apply(n * (accumulated - previous), ra, rb, invMassA, invMassB, invInertiaA, invInertiaB);
+        delta = max(delta, abs(accumulated - previous));
+    }
+    v.scatter(b, bodies);
+
+    alignas(kSolverWidth * sizeof(real_t)) real_t lanes[kSolverWidth];
+    delta.store(lanes);
+    return *std::max_element(lanes, lanes + kSolverWidth);
+}
+
+// warmStartBatch and solveBatch compiled once per target, picked by SimdLevel
+template <typename Batch, typename Body>
+struct BatchKernels {
+    void (*WarmStart)(const Batch&, Body*);
+    real_t (*Solve)(Batch&, Body*, real_t);
+};
+
+template <typename Batch, typename Body>
+void warmStartBatchBase(const Batch& b, Body* bodies) { warmStartBatch(b, bodies); }
+template <typename Batch, typename Body>
+real_t solveBatchBase(Batch& b, Body* bodies, real_t friction) { return solveBatch(b, bodies, friction); }
+
+#if defined(NYX_SIMD_DISPATCH)
+template <typename Batch, typename Body>
+NYX_TARGET_SSE4 void warmStartBatchSse4(const Batch& b, Body* bodies) { warmStartBatch(b, bodies); }
+template <typename Batch, typename Body>
+NYX_TARGET_SSE4 real_t solveBatchSse4(Batch& b, Body* bodies, real_t friction) { return solveBatch(b, bodies, friction); }
+
+template <typename Batch, typename Body>
+NYX_TARGET_AVX2 void warmStartBatchAvx2(const Batch& b, Body* bodies) { warmStartBatch(b, bodies); }
+template <typename Batch, typename Body>
+NYX_TARGET_AVX2 real_t solveBatchAvx2(Batch& b, Body* bodies, real_t friction) { return solveBatch(b, bodies, friction); }
+#endif
+
+// Eight lanes fill an AVX register, so AVX-512 has nothing to add
+template <typename Batch, typename Body>
+BatchKernels<Batch, Body> selectBatchKernels() {
+#if defined(NYX_SIMD_DISPATCH)
+    switch (getSimdLevel()) {
+    case SimdLevel::Avx512:
+    case SimdLevel::Avx2:
+        return {warmStartBatchAvx2<Batch, Body>, solveBatchAvx2<Batch, Body>};
+    case SimdLevel::Sse4:
+        return {warmStartBatchSse4<Batch, Body>, solveBatchSse4<Batch, Body>};
+    default:
+        break;
+    }
+#endif
+    return {warmStartBatchBase<Batch, Body>, solveBatchBase<Batch, Body>};
+}
+
+} // namespace
+
+void ContactSolver::solve(RigidbodySystem& rb, ManifoldCache& manifolds, real_t dt, JobSystem* jobs) {
+    Stats = ContactSolverStats();
+    if (manifolds.empty())
+        return;
+
+    gatherBodies(rb, jobs);
+    color(rb, manifolds);
+    prepare(rb, manifolds, dt, jobs);
+    if (Batches.empty())
+        return;
+
+    const BatchKernels<ContactBatch, SolverBody> kernels = selectBatchKernels<ContactBatch, SolverBody>();
+    if (Settings.WarmStarting)
+        forEachColor(jobs, [&](size_t b) { kernels.WarmStart(Batches[b], Bodies.data()); });
+
+    for (uint32_t i = 0; i < Settings.Iterations; ++i) {
+        forEachColor(jobs, [&](size_t b) { BatchDelta[b] = kernels.Solve(Batches[b], Bodies.data(), Settings.Friction); });
+
+        const real_t delta = *std::max_element(BatchDelta.begin(), BatchDelta.end());
+        if (i == 0)
+            Stats.FirstImpulseDelta = delta;
+        Stats.LastImpulseDelta = delta;
+        Stats.Iterations = i + 1;
+        if (delta <= Settings.Tolerance)
+            break;
+    }
+    scatterResults(rb, manifolds, jobs);
+}
+
+void ContactSolver::gatherBodies(const RigidbodySystem& rb, JobSystem* jobs) {
+    const RigidbodyData& data = rb.getData();
+    const LaneVector<uint32_t>& awake = data.getAwakeBodies();
+
+    // Solver body k + 1 is awake body k; sleeping and inactive bodies all map to 0
+    Bodies.resize(awake.size() + 1);
+    Bodies[0] = SolverBody{};
+    parallelFor(jobs, awake.size(), kMinBodiesPerChunk, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const Vec3& v = data.getVelocities()[awake[k]];
+            const Vec3& w = data.getAngularVelocities()[awake[k]];
+            Bodies[k + 1] = SolverBody{{v.X, v.Y, v.Z}, {w.X, w.Y, w.Z}};
+        }
+    });
+}
+
+void ContactSolver::color(const RigidbodySystem& rb, const ManifoldCache& manifolds) {
+    const RigidbodyData& data = rb.getData();
+    const LaneVector<uint32_t>& slots = data.getAwakeSlots();
+    const std::vector<ContactManifold>& cached = manifolds.getManifolds();
+
+    // Greedy: each manifold takes the first color neither of its moving bodies
+    // has. Bodies that are not awake never move, so they do not constrain it.
+    BodyColors.assign(data.getAwakeBodies().size(), 0);
+    ManifoldColor.resize(cached.size());
+    uint32_t counts[kMaxColors + 1] = {};
+    for (size_t m = 0; m < cached.size(); ++m) {
+        const ContactManifold& manifold = cached[m];
+        const uint32_t slotA = slots[manifold.A], slotB = slots[manifold.B];
+        const bool movesA = slotA != RigidbodyData::kNotAwake, movesB = slotB != RigidbodyData::kNotAwake;
+        if ((!movesA && !movesB) || manifold.PointCount == 0) {
+            ManifoldColor[m] = kSkipped;
+            continue;
+        }
+
+        const uint64_t used = (movesA ? BodyColors[slotA] : 0) | (movesB ? BodyColors[slotB] : 0);
+        const uint32_t c = static_cast<uint32_t>(std::countr_one(used));
+        if (c < kMaxColors) {
+            if (movesA) BodyColors[slotA] |= uint64_t(1) << c;
+            if (movesB) BodyColors[slotB] |= uint64_t(1) << c;
+        }
+        ManifoldColor[m] = static_cast<uint8_t>(c);
+        ++counts[c];
+        Stats.Points += manifold.PointCount;
+    }
+
+    // Counting sort into color order; colored batches hold kSolverWidth
+    // manifolds, overflow batches a single one so they can run back to back
+    uint32_t offsets[kMaxColors + 1];
+    uint32_t total = 0;
+    ColorBatches.clear();
+    uint32_t batchCount = 0;
+    for (uint32_t c = 0; c <= kMaxColors; ++c) {
+        offsets[c] = total;
+        total += counts[c];
+        if (c < kMaxColors && counts[c]) {
+            ColorBatches.push_back(batchCount);
+            batchCount += (counts[c] + kSolverWidth - 1) / kSolverWidth;
+        }
+    }
+    ColorBatches.push_back(batchCount);
+    batchCount += counts[kMaxColors];
+
+    Ordered.resize(total);
+    for (size_t m = 0; m < cached.size(); ++m) {
+        if (ManifoldColor[m] != kSkipped)
+            Ordered[offsets[ManifoldColor[m]]++] = static_cast<uint32_t>(m);
+    }
+
+    // Lay the manifolds out in their batches, padding the last lanes of each color
+    Batches.resize(batchCount);
+    uint32_t next = 0;
+    uint32_t batch = 0;
+    for (uint32_t c = 0; c <= kMaxColors; ++c) {
+        const uint32_t width = c < kMaxColors ? kSolverWidth : 1;
+        for (uint32_t left = counts[c]; left > 0; ++batch) {
+            const uint32_t lanes = std::min(left, width);
+            for (uint32_t lane = 0; lane < kSolverWidth; ++lane)
+                Batches[batch].Manifold[lane] = lane < lanes ? Ordered[next + lane] : kPadding;
+            next += lanes;
+            left -= lanes;
+        }
+    }
+
+    Stats.Manifolds = total;
+    Stats.OverflowManifolds = counts[kMaxColors];
+    Stats.Colors = static_cast<uint32_t>(ColorBatches.size() - 1);
+    Stats.Batches = batchCount;
+}
+
+void ContactSolver::prepare(const RigidbodySystem& rb, const ManifoldCache& manifolds, real_t dt, JobSystem* jobs) {
+    const std::vector<ContactManifold>& cached = manifolds.getManifolds();
+    BatchDelta.resize(Batches.size());
+
+    parallelFor(jobs, Batches.size(), kMinBatchesPerChunk, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            ContactBatch& batch = Batches[b];
+            uint32_t indices[kSolverWidth];
+            std::copy(batch.Manifold, batch.Manifold + kSolverWidth, indices);
+
+            // Padding lanes stay zero: static bodies, no mass, no impulses
+            batch = ContactBatch{};
+            for (uint32_t lane = 0; lane < kSolverWidth; ++lane) {
+                batch.Manifold[lane] = indices[lane];
+                if (indices[lane] != kPadding)
+                    prepareLane(rb, cached[indices[lane]], batch, lane, dt);
+            }
+        }
+    });
+}
+
+void ContactSolver::prepareLane(const RigidbodySystem& rb, const ContactManifold& manifold, ContactBatch& batch, uint32_t lane, real_t dt) const {
+    const RigidbodyData& data = rb.getData();
+
+    // Bodies that are not awake do not move, which the solver sees as infinite mass
+    real_t invMass[2] = {0.0f, 0.0f};
+    real_t invInertia[2][6] = {};
+    const uint32_t bodies[2] = {manifold.A, manifold.B};
+    for (int side = 0; side < 2; ++side) {
+        const uint32_t body = bodies[side];
+        if (data.getAwakeSlots()[body] == RigidbodyData::kNotAwake)
+            continue;
+        invMass[side] = data.getInvMasses()[body];
+
+        // R * I⁻¹ * Rᵀ as integrateVelocities left it for this step
+        const SymMat3& w = data.getWorldInvInertias()[data.getAwakeSlots()[body]];
+        const real_t m[6] = {w.XX, w.YY, w.ZZ, w.XY, w.XZ, w.YZ};
+        std::copy(m, m + 6, invInertia[side]);
+    }
+
+    batch.BodyA[lane] = data.getAwakeSlots()[manifold.A] + 1; // kNotAwake wraps to 0
+    batch.BodyB[lane] = data.getAwakeSlots()[manifold.B] + 1;
+    batch.InvMassA[lane] = invMass[0];
+    batch.InvMassB[lane] = invMass[1];
+    for (int k = 0; k < 6; ++k) {
+        batch.InvInertiaA[k][lane] = invInertia[0][k];
+        batch.InvInertiaB[k][lane] = invInertia[1][k];
+    }
+
+    const Vec3 normal = manifold.Normal;
+    Vec3 tangents[2];
+    tangentBasis(normal, tangents[0], tangents[1]);
+    storeLane(batch.Normal, lane, normal);
+    storeLane(batch.Tangent[0], lane, tangents[0]);
+    storeLane(batch.Tangent[1], lane, tangents[1]);
+
+    const SolverBody& bodyA = Bodies[batch.BodyA[lane]];
+    const SolverBody& bodyB = Bodies[batch.BodyB[lane]];
+    const Vec3 va(bodyA.V[0], bodyA.V[1], bodyA.V[2]), wa(bodyA.W[0], bodyA.W[1], bodyA.W[2]);
+    const Vec3 vb(bodyB.V[0], bodyB.V[1], bodyB.V[2]), wb(bodyB.W[0], bodyB.W[1], bodyB.W[2]);
+
+    for (uint32_t p = 0; p < manifold.PointCount; ++p) {
+        const ManifoldPoint& point = manifold.Points[p];
+        ContactBatch::Point& out = batch.Points[p];
+
+        const Vec3 contact = (point.PointA + point.PointB) * 0.5f;
+        const Vec3 ra = contact - data.getPositions()[manifold.A];
+        const Vec3 rb = contact - data.getPositions()[manifold.B];
+        storeLane(out.RA, lane, ra);
+        storeLane(out.RB, lane, rb);
+
+        // 1 / (J M⁻¹ Jᵀ) along each axis
+        auto effectiveMass = [&](const Vec3& axis) {
+            const Vec3 rna = cross(ra, axis), rnb = cross(rb, axis);
+            const real_t k = invMass[0] + invMass[1] + dot(rna, applySymmetric(invInertia[0], rna)) + dot(rnb, applySymmetric(invInertia[1], rnb));
+            return k > 0.0f ? 1.0f / k : 0.0f;
+        };
+        out.NormalMass[lane] = effectiveMass(normal);
+        out.TangentMass[0][lane] = effectiveMass(tangents[0]);
+        out.TangentMass[1][lane] = effectiveMass(tangents[1]);
+
+        real_t bias = Settings.Baumgarte / dt * std::max(point.Depth - Settings.Slop, real_t(0));
+        const real_t approach = dot(vb + cross(wb, rb) - va - cross(wa, ra), normal);
+        if (-approach > Settings.RestitutionThreshold)
+            bias = std::max(bias, -Settings.Restitution * approach);
+        out.Bias[lane] = bias;
+
+        if (Settings.WarmStarting) {
+            out.NormalImpulse[lane] = point.NormalImpulse;
+            out.TangentImpulse[0][lane] = point.TangentImpulse[0];
+            out.TangentImpulse[1][lane] = point.TangentImpulse[1];
+        }
+    }
+}
+
+template <typename Fn>
+void ContactSolver::forEachColor(JobSystem* jobs, const Fn& fn) {
+    // A color's batches share no moving body; the next color waits for them
+    for (size_t c = 0; c + 1 < ColorBatches.size(); ++c) {
+        const size_t first = ColorBatches[c];
+        parallelFor(jobs, ColorBatches[c + 1] - first, kMinBatchesPerChunk, [&](size_t begin, size_t end) {
+            for (size_t b = first + begin; b < first + end; ++b)
+                fn(b);
+        });
+    }
+    for (size_t b = ColorBatches.back(); b < Batches.size(); ++b)
+        fn(b);
+}
+
+void ContactSolver::scatterResults(RigidbodySystem& rb, ManifoldCache& manifolds, JobSystem* jobs) {
+    std::vector<ContactManifold>& cached = manifolds.accessManifolds();
+    parallelFor(jobs, Batches.size(), kMinBatchesPerChunk, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            const ContactBatch& batch = Batches[b];
+            for (uint32_t lane = 0; lane < kSolverWidth; ++lane) {
+                if (batch.Manifold[lane] == kPadding)
+                    continue;
+                ContactManifold& manifold = cached[batch.Manifold[lane]];
+                for (uint32_t p = 0; p < manifold.PointCount; ++p) {
+                    manifold.Points[p].NormalImpulse = batch.Points[p].NormalImpulse[lane];
+                    manifold.Points[p].TangentImpulse[0] = batch.Points[p].TangentImpulse[0][lane];
+                    manifold.Points[p].TangentImpulse[1] = batch.Points[p].TangentImpulse[1][lane];
+                }
+            }
+        }
+    });
+
+    RigidbodyData& data = rb.accessData();
+    LaneVector<Vec3>& velocities = data.accessVelocities();
+    LaneVector<Vec3>& angularVelocities = data.accessAngularVelocities();
+    const LaneVector<uint32_t>& awake = data.getAwakeBodies();
+    parallelFor(jobs, awake.size(), kMinBodiesPerChunk, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const SolverBody& body = Bodies[k + 1];
+            velocities[awake[k]] = Vec3(body.V[0], body.V[1], body.V[2]);
+            angularVelocities[awake[k]] = Vec3(body.W[0], body.W[1], body.W[2]);
+        }
+    });
+}
+
+} // namespace nyx
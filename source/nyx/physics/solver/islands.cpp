@@ -0,0 +1,100 @@
+#include "nyx/physics/solver/islands.h"
+#include "nyx/physics/rigidbody/rigidbody_system.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace nyx {
+
+void IslandBuilder::update(RigidbodySystem& rb, const ManifoldCache& manifolds, real_t dt) {
+    IslandCount = 0;
+    if (!Settings.Enabled)
+        return;
+
+    rb.updateAwakeBodies();
+    RigidbodyData& data = rb.accessData();
+    const LaneVector<uint32_t>& awake = data.getAwakeBodies();
+    const LaneVector<uint32_t>& slots = data.getAwakeSlots();
+    const size_t count = awake.size();
+
+    // Sleep timers only run while a body stays below both thresholds
+    LaneVector<real_t>& sleepTimes = data.accessSleepTimes();
+    const real_t linearSq = Settings.LinearThreshold * Settings.LinearThreshold;
+    const real_t angularSq = Settings.AngularThreshold * Settings.AngularThreshold;
+    for (uint32_t body : awake) {
+        const Vec3& v = data.getVelocities()[body];
+        const Vec3& w = data.getAngularVelocities()[body];
+        const bool slow = dot(v, v) <= linearSq && dot(w, w) <= angularSq;
+        sleepTimes[body] = slow ? sleepTimes[body] + dt : 0.0f;
+    }
+
+    Parent.resize(count);
+    std::iota(Parent.begin(), Parent.end(), 0u);
+    Touched.clear();
+    for (const ContactManifold& manifold : manifolds.getManifolds()) {
+        if (manifold.PointCount == 0)
+            continue;
+        const uint32_t slotA = slots[manifold.A], slotB = slots[manifold.B];
+        const bool awakeA = slotA != RigidbodyData::kNotAwake, awakeB = slotB != RigidbodyData::kNotAwake;
+
+        if (awakeA && awakeB)
+            unite(slotA, slotB);
+        else if (awakeA && data.isSleeping(manifold.B))
+            Touched.insert(Touched.end(), {slotA, manifold.B});
+        else if (awakeB && data.isSleeping(manifold.A))
+            Touched.insert(Touched.end(), {slotB, manifold.A});
+    }
+
+    // Counting sort of the awake bodies by island, tracking each island's shortest timer
+    IslandSleepTime.assign(count, std::numeric_limits<real_t>::max());
+    IslandStart.assign(count + 1, 0);
+    for (uint32_t k = 0; k < count; ++k) {
+        const uint32_t root = find(k);
+        Parent[k] = root;
+        IslandSleepTime[root] = std::min(IslandSleepTime[root], sleepTimes[awake[k]]);
+        ++IslandStart[root + 1];
+        IslandCount += root == k;
+    }
+
+    // Islands touching sleeping bodies stay awake, and wake those bodies' islands
+    for (size_t t = 0; t < Touched.size(); t += 2) {
+        IslandSleepTime[Parent[Touched[t]]] = 0.0f;
+        rb.wake(Touched[t + 1]);
+    }
+
+    // Island k, when k is a root, is Members[IslandStart[k], IslandStart[k + 1])
+    std::partial_sum(IslandStart.begin(), IslandStart.end(), IslandStart.begin());
+    Cursor.assign(IslandStart.begin(), IslandStart.end() - 1);
+    Members.resize(count);
+    for (uint32_t k = 0; k < count; ++k)
+        Members[Cursor[Parent[k]]++] = awake[k];
+
+    for (uint32_t k = 0; k < count; ++k) {
+        if (Parent[k] == k && IslandSleepTime[k] >= Settings.TimeToSleep)
+            rb.sleep(Members.data() + IslandStart[k], IslandStart[k + 1] - IslandStart[k]);
+    }
+
+    rb.updateAwakeBodies();
+}
+
+uint32_t IslandBuilder::find(uint32_t slot) {
+    // Path halving
+    while (Parent[slot] != slot) {
+        Parent[slot] = Parent[Parent[slot]];
+        slot = Parent[slot];
+    }
+    return slot;
+}
+
+void IslandBuilder::unite(uint32_t a, uint32_t b) {
+    a = find(a);
+    b = find(b);
+    // The lower slot becomes the root, which keeps roots independent of manifold order
+    if (a < b)
+        Parent[b] = a;
+    else if (b < a)
+        Parent[a] = b;
+}
+
+} // namespace nyx
@@ -0,0 +1,245 @@
+#include "nyx/physics/scene/input_recording.h"
+#include "nyx/physics/scene/physics_world.h"
+
+#include <cstring>
+
+namespace nyx {
+
+bool InputRecorder::start(PhysicsWorld& world, const char* path, bool hashes) {
+    stop();
+    if (!Writer.open(path))
+        return false;
+
+    std::vector<std::byte> snapshot(world.getSnapshotSize());
+    world.saveSnapshot(snapshot.data(), snapshot.size());
+
+    InputRecordingHeader header{};
+    std::memcpy(header.Magic, kInputRecordingMagic, sizeof(header.Magic));
+    header.Version = kInputRecordingVersion;
+    header.RealSize = sizeof(real_t);
+    header.Hashes = hashes ? 1 : 0;
+    header.SnapshotSize = snapshot.size();
+    Writer.writeValue(header);
+    Writer.write(snapshot.data(), snapshot.size());
+
+    World = &world;
+    Hashes = hashes;
+    Steps = 0;
+    world.setInputRecorder(this);
+    return !Writer.hasFailed();
+}
+
+bool InputRecorder::stop() {
+    if (!World)
+        return true;
+    World->setInputRecorder(nullptr);
+    World = nullptr;
+    writeTag(InputRecord::End);
+    return Writer.close();
+}
+
+void InputRecorder::recordAddBodies(std::span<const RigidbodyDesc> bodies) {
+    writeTag(InputRecord::AddBodies);
+    Writer.writeValue(static_cast<uint32_t>(bodies.size()));
+    for (const RigidbodyDesc& body : bodies)
+        writeBody(body.Position, body.Velocity, body.Mass, body.Inertia);
+}
+
+void InputRecorder::recordConvex(RigidbodyHandle body, const Vec3* points, size_t count) {
+    writeTag(InputRecord::Convex);
+    Writer.writeValue(body);
+    Writer.writeValue(static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i)
+        writeVec3(points[i]);
+}
+
+void InputRecorder::recordStep(real_t dt, const PhysicsWorld& world) {
+    writeTag(InputRecord::Step);
+    Writer.writeValue(dt);
+    if (Hashes)
+        Writer.writeValue(world.getStateHash());
+    ++Steps;
+}
+
+void InputRecorder::writeBody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
+    writeVec3(pos);
+    writeVec3(vel);
+    Writer.writeValue(mass);
+    Writer.writeValue(inertia.m);
+}
+
+bool InputReplay::open(const char* path) {
+    Failed = false;
+    if (!File.openRead(path) || File.size() < sizeof(Header))
+        return false;
+    std::memcpy(&Header, File.data(), sizeof(Header));
+    if (std::memcmp(Header.Magic, kInputRecordingMagic, sizeof(Header.Magic)) != 0 || Header.Version != kInputRecordingVersion ||
+        Header.RealSize != sizeof(real_t) || Header.SnapshotSize > File.size() - sizeof(Header)) {
+        File.close();
+        return false;
+    }
+    Begin = sizeof(Header) + Header.SnapshotSize;
+    Cursor = Begin;
+    return true;
+}
+
+bool InputReplay::start(PhysicsWorld& world) {
+    Cursor = Begin;
+    Steps = 0;
+    FirstMismatch = kNoMismatch;
+    Failed = !File.data() || !world.loadSnapshot(File.data() + sizeof(Header), Header.SnapshotSize);
+    return !Failed;
+}
+
+template <typename T>
+bool InputReplay::read(T& value) {
+    if (File.size() - Cursor < sizeof(T))
+        return false;
+    std::memcpy(static_cast<void*>(&value), File.data() + Cursor, sizeof(T));
+    Cursor += sizeof(T);
+    return true;
+}
+
+bool InputReplay::readVec3(Vec3& v) {
+    real_t xyz[3];
+    if (!read(xyz))
+        return false;
+    v = Vec3(xyz[0], xyz[1], xyz[2]);
+    return true;
+}
+
+bool InputReplay::readBody(RigidbodyDesc& body) {
+    return readVec3(body.Position) && readVec3(body.Velocity) && read(body.Mass) && read(body.Inertia.m);
+}
+
+bool InputReplay::readHandle(const PhysicsWorld& world, RigidbodyHandle& body) {
+    return read(body) && world.isValid(body);
+}
+
+bool InputReplay::step(PhysicsWorld& world) {
+    if (Failed || !File.data())
+        return false;
+
+    // A record cut short or naming a body that is not there ends the replay as failed
+    auto fail = [&]() {
+        Failed = true;
+        return false;
+    };
+
+    for (;;) {
+        // A recording that was never stopped simply ends after its last record
+        InputRecord tag;
+        if (Cursor == File.size())
+            return false;
+        if (!read(tag))
+            return fail();
+
+        RigidbodyHandle body;
+        Vec3 v;
+        switch (tag) {
+        case InputRecord::Step: {
+            real_t dt;
+            uint64_t hash = 0;
+            if (!read(dt) || (Header.Hashes && !read(hash)))
+                return fail();
+            world.update(dt);
+            if (Header.Hashes && FirstMismatch == kNoMismatch && world.getStateHash() != hash)
+                FirstMismatch = Steps;
+            ++Steps;
+            return true;
+        }
+        case InputRecord::AddBody: {
+            RigidbodyDesc desc;
+            if (!readBody(desc))
+                return fail();
+            world.addRigidbody(desc.Position, desc.Velocity, desc.Mass, desc.Inertia);
+            break;
+        }
+        case InputRecord::AddBodies: {
+            uint32_t count;
+            if (!read(count) || count > File.size() - Cursor)
+                return fail();
+            Bodies.resize(count);
+            for (RigidbodyDesc& desc : Bodies) {
+                if (!readBody(desc))
+                    return fail();
+            }
+            world.addRigidbodies(Bodies);
+            break;
+        }
+        case InputRecord::RemoveBody:
+            if (!readHandle(world, body))
+                return fail();
+            world.removeRigidbody(body);
+            break;
+        case InputRecord::Force:
+            if (!readHandle(world, body) || !readVec3(v))
+                return fail();
+            world.addForce(body, v);
+            break;
+        case InputRecord::Torque:
+            if (!readHandle(world, body) || !readVec3(v))
+                return fail();
+            world.addTorque(body, v);
+            break;
+        case InputRecord::Impulse: {
+            Vec3 contactVector;
+            if (!readHandle(world, body) || !readVec3(v) || !readVec3(contactVector))
+                return fail();
+            world.applyImpulse(body, v, contactVector);
+            break;
+        }
+        case InputRecord::Gravity:
+            if (!readVec3(v))
+                return fail();
+            world.setGravity(v);
+            break;
+        case InputRecord::Sphere: {
+            real_t radius;
+            if (!readHandle(world, body) || !read(radius))
+                return fail();
+            world.setSphereShape(body, radius);
+            break;
+        }
+        case InputRecord::Box:
+            if (!readHandle(world, body) || !readVec3(v))
+                return fail();
+            world.setBoxShape(body, v);
+            break;
+        case InputRecord::Capsule: {
+            real_t halfHeight, radius;
+            if (!readHandle(world, body) || !read(halfHeight) || !read(radius))
+                return fail();
+            world.setCapsuleShape(body, halfHeight, radius);
+            break;
+        }
+        case InputRecord::Convex: {
+            uint32_t count;
+            if (!readHandle(world, body) || !read(count) || count > File.size() - Cursor)
+                return fail();
+            Points.resize(count);
+            for (Vec3& point : Points) {
+                if (!readVec3(point))
+                    return fail();
+            }
+            world.setConvexShape(body, Points.data(), Points.size());
+            break;
+        }
+        case InputRecord::End:
+            // Stay on the end marker so further calls keep returning false
+            Cursor -= sizeof(tag);
+            return false;
+        default:
+            return fail();
+        }
+    }
+}
+
+uint32_t InputReplay::run(PhysicsWorld& world) {
+    const uint32_t first = Steps;
+    while (step(world)) {
+    }
+    return Steps - first;
+}
+
+} // namespace nyx
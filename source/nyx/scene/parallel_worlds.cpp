@@ -0,0 +1,69 @@
+#include "nyx/physics/scene/parallel_worlds.h"
+#include "nyx/core/trace.h"
+
+#include <cassert>
+
+namespace nyx {
+
+ParallelWorlds::ParallelWorlds(const JobSystemSettings& jobSettings) : Jobs(jobSettings) {}
+
+uint32_t ParallelWorlds::addWorld(size_t capacity) {
+    Worlds.push_back(std::make_unique<Entry>(capacity));
+    return size() - 1;
+}
+
+uint32_t ParallelWorlds::addClone(uint32_t src) {
+    const uint32_t index = addWorld(getWorld(src).getRigidbodyData().size());
+    clone(src, index);
+    return index;
+}
+
+void ParallelWorlds::update(real_t dt) {
+    NYX_TRACE_SCOPE("ParallelWorlds::update");
+    // A world is small enough that splitting it further would cost more than it saves
+    parallelFor(&Jobs, Worlds.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            Worlds[i]->World.update(dt);
+    });
+}
+
+void ParallelWorlds::stepN(uint32_t n) {
+    NYX_TRACE_SCOPE("ParallelWorlds::stepN");
+    parallelFor(&Jobs, Worlds.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            Worlds[i]->World.stepN(n);
+    });
+}
+
+void ParallelWorlds::saveBaseline(uint32_t index) {
+    Entry& entry = *Worlds[index];
+    entry.Baseline.resize(entry.World.getSnapshotSize());
+    entry.World.saveSnapshot(entry.Baseline.data(), entry.Baseline.size());
+}
+
+bool ParallelWorlds::reset(uint32_t index) {
+    Entry& entry = *Worlds[index];
+    return !entry.Baseline.empty() && entry.World.loadSnapshot(entry.Baseline.data(), entry.Baseline.size());
+}
+
+void ParallelWorlds::resetAll() {
+    NYX_TRACE_SCOPE("ParallelWorlds::resetAll");
+    parallelFor(&Jobs, Worlds.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            reset(static_cast<uint32_t>(i));
+    });
+}
+
+void ParallelWorlds::clone(uint32_t src, uint32_t dst) {
+    if (src == dst)
+        return;
+    const PhysicsWorld& from = getWorld(src);
+    Scratch.resize(from.getSnapshotSize());
+    from.saveSnapshot(Scratch.data(), Scratch.size());
+    [[maybe_unused]] const bool loaded = accessWorld(dst).loadSnapshot(Scratch.data(), Scratch.size());
+    assert(loaded && "A snapshot of this build always loads");
+    accessWorld(dst).setFixedStepSettings(from.getFixedStepSettings());
+    Worlds[dst]->Baseline = Worlds[src]->Baseline;
+}
+
+} // namespace nyx
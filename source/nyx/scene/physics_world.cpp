@@ -1,15 +1,236 @@
 #include "nyx/physics/scene/physics_world.h"
+#include "nyx/core/trace.h"
+#include "nyx/physics/collision/aabb_tree.h"
+#include "nyx/physics/collision/hash_grid.h"
+#include "nyx/physics/collision/sweep_and_prune.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace nyx {
 
-PhysicsWorld::PhysicsWorld() = default;
+PhysicsWorld::PhysicsWorld() {
+    Rb.setJobSystem(Jobs);
+    setBroadphase(BroadphaseType::SweepAndPrune);
+}
+
+PhysicsWorld::PhysicsWorld(const JobSystemSettings& jobSettings, size_t capacity) : OwnedJobs(jobSettings), Rb(capacity) {
+    Rb.setJobSystem(Jobs);
+    setBroadphase(BroadphaseType::SweepAndPrune);
+}
+
+void PhysicsWorld::setJobSystem(JobSystem* jobs) {
+    Jobs = jobs ? jobs : &OwnedJobs;
+    Rb.setJobSystem(Jobs);
+}
 
-size_t PhysicsWorld::addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
+RigidbodyHandle PhysicsWorld::addRigidbody(const Vec3& pos, const Vec3& vel, real_t mass, const Mat3& inertia) {
+    if (Recorder)
+        Recorder->recordAddBody(pos, vel, mass, inertia);
     return Rb.addRigidbody(pos, vel, mass, inertia);
 }
 
-void PhysicsWorld::update(real_t dt) {
-    Rb.update(dt);
+void PhysicsWorld::removeRigidbody(RigidbodyHandle handle) {
+    if (Recorder)
+        Recorder->recordRemoveBody(handle);
+    const uint32_t body = static_cast<uint32_t>(getIndex(handle));
+    const uint32_t last = static_cast<uint32_t>(Rb.getData().size() - 1);
+
+    if (Bp)
+        Bp->removeBody(body, last);
+    Shapes.removeBody(body, last);
+    Manifolds.removeBody(body, last);
+    Rb.removeRigidbody(handle);
+}
+
+uint32_t PhysicsWorld::advance(real_t frameTime) {
+    assert(FixedStep.Dt > 0.0f && "The fixed step needs a positive Dt");
+    Accumulator += frameTime;
+    // Clamped before the conversion, a frame time of hours would not fit
+    uint32_t ticks = static_cast<uint32_t>(std::min(Accumulator / FixedStep.Dt, static_cast<real_t>(FixedStep.MaxSteps + 1)));
+    if (ticks > FixedStep.MaxSteps) {
+        Accumulator = std::fmod(Accumulator, FixedStep.Dt) + static_cast<real_t>(FixedStep.MaxSteps) * FixedStep.Dt;
+        ticks = FixedStep.MaxSteps;
+    }
+    Accumulator = std::max(Accumulator - static_cast<real_t>(ticks) * FixedStep.Dt, 0.0f);
+    stepN(ticks);
+    return ticks;
+}
+
+void PhysicsWorld::stepN(uint32_t n) {
+    NYX_TRACE_SCOPE("PhysicsWorld::stepN");
+    const uint32_t substeps = std::max(FixedStep.Substeps, 1u);
+    const real_t dt = FixedStep.Dt / static_cast<real_t>(substeps);
+    for (uint32_t tick = 0; tick < n; ++tick) {
+        // The second to last tick gives the last one its Previous poses
+        const bool publish = PublishTransforms && tick + 2 >= n;
+        for (uint32_t sub = 0; sub < substeps; ++sub)
+            step(dt, publish && sub + 1 == substeps ? FixedStep.Dt : 0.0f);
+    }
+}
+
+void PhysicsWorld::step(real_t dt, real_t publishDt) {
+    // A stage that does not run this step keeps no time from an earlier one
+    Stats = PhysicsStats{};
+    Stats.Frame = FrameCount++;
+    {
+        NYX_PROFILE_SCOPE(Stats.Step);
+        NYX_TRACE_SCOPE("PhysicsWorld::update");
+
+        // Contacts found at the end of the last step still describe the current poses,
+        // so they are resolved right after the forces and before anything moves
+        {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Velocities));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Velocities));
+            Rb.integrateVelocities(dt);
+        }
+        {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Solve));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Solve));
+            Solver.solve(Rb, Manifolds, dt, Jobs);
+        }
+        {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Positions));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Positions));
+            Rb.integratePositions(dt);
+        }
+
+        if (Bp) {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Broadphase));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Broadphase));
+            Bp->update(Rb.getData(), Jobs);
+        }
+
+        if (!Shapes.empty()) {
+            {
+                NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Narrowphase));
+                NYX_TRACE_SCOPE(getStageName(PhysicsStage::Narrowphase));
+                Np.update(getPairs(), Rb.getData(), Shapes, FrameArena, Jobs);
+            }
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Manifolds));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Manifolds));
+            Manifolds.update(Np.getContacts(), Rb.getData(), Jobs);
+        }
+
+        {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Islands));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Islands));
+            Islands.update(Rb, Manifolds, dt);
+        }
+
+        if (publishDt > 0.0f) {
+            NYX_PROFILE_SCOPE(Stats.accessStage(PhysicsStage::Publish));
+            NYX_TRACE_SCOPE(getStageName(PhysicsStage::Publish));
+            Transforms.publish(Rb.getData(), Stats.Frame, publishDt, Jobs);
+        }
+    }
+
+    FrameArena.reset();
+    recordStats();
+    if (Recorder)
+        Recorder->recordStep(dt, *this);
+}
+
+void PhysicsWorld::recordStats() {
+    const RigidbodyData& data = Rb.getData();
+    Stats.Rigidbodies = Rb.getStats();
+    Stats.Bodies = static_cast<uint32_t>(data.size());
+    Stats.AwakeBodies = Stats.Rigidbodies.Integrated;
+    Stats.Pairs = static_cast<uint32_t>(getPairs().size());
+    Stats.Contacts = Shapes.empty() ? 0 : static_cast<uint32_t>(Np.getContacts().size());
+    Stats.Manifolds = static_cast<uint32_t>(Manifolds.getManifolds().size());
+    Stats.SolverIterations = Solver.getStats().Iterations;
+    Stats.Islands = Islands.getIslandCount();
+    StatsHistory.push(Stats);
+}
+
+uint64_t PhysicsWorld::getStateHash() const {
+    const RigidbodyData& data = Rb.getData();
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&](const void* value, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(value);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    };
+
+    // Component by component: Vec3 and Quaternion have padding that holds anything
+    for (size_t i = 0; i < data.size(); ++i) {
+        const Vec3& p = data.getPositions()[i];
+        const Vec3& v = data.getVelocities()[i];
+        const Vec3& w = data.getAngularVelocities()[i];
+        const Quaternion& q = data.getOrientations()[i];
+        const real_t state[13] = {p.X, p.Y, p.Z, v.X, v.Y, v.Z, w.X, w.Y, w.Z, q.w, q.x, q.y, q.z};
+        const uint32_t sleep[2] = {data.getActive()[i], data.isSleeping(i) ? 1u : 0u};
+        mix(state, sizeof(state));
+        mix(sleep, sizeof(sleep));
+    }
+    return hash;
+}
+
+void PhysicsWorld::setBroadphase(BroadphaseType type) {
+    BpType = type;
+    switch (type) {
+    case BroadphaseType::None:
+        Bp.reset();
+        break;
+    case BroadphaseType::SweepAndPrune:
+        Bp = std::make_unique<SweepAndPrune>();
+        break;
+    case BroadphaseType::AabbTree:
+        Bp = std::make_unique<AabbTreeBroadphase>();
+        break;
+    case BroadphaseType::HashGrid:
+        Bp = std::make_unique<HashGridBroadphase>();
+        break;
+    }
+}
+
+const std::vector<BodyPair>& PhysicsWorld::getPairs() const {
+    static const std::vector<BodyPair> kNoPairs;
+    return Bp ? Bp->getPairs() : kNoPairs;
+}
+
+void PhysicsWorld::queryOverlap(const Aabb& box, std::vector<uint32_t>& bodies) const {
+    const AabbLanes& bounds = Rb.getData().getBounds();
+
+    if (BpType == BroadphaseType::AabbTree) {
+        static_cast<const AabbTreeBroadphase&>(*Bp).query(box, [&](uint32_t body) {
+            if (bounds.get(body).overlaps(box))
+                bodies.push_back(body);
+            return true;
+        });
+        return;
+    }
+
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        if (bounds.get(i).overlaps(box))
+            bodies.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+bool PhysicsWorld::raycast(const Vec3& origin, const Vec3& direction, real_t maxDistance, RaycastHit& hit) const {
+    const AabbLanes& bounds = Rb.getData().getBounds();
+    const Vec3 invDirection(1.0f / direction.X, 1.0f / direction.Y, 1.0f / direction.Z);
+    bool found = false;
+
+    auto testBody = [&](uint32_t body, real_t closest) {
+        real_t distance;
+        if (bounds.get(body).intersectRay(origin, invDirection, closest, distance)) {
+            hit = RaycastHit{body, distance};
+            found = true;
+            return distance;
+        }
+        return closest;
+    };
+
+    if (BpType == BroadphaseType::AabbTree) {
+        static_cast<const AabbTreeBroadphase&>(*Bp).raycast(origin, direction, maxDistance, testBody);
+        return found;
+    }
+
+    for (size_t i = 0; i < bounds.size(); ++i)
+        maxDistance = testBody(static_cast<uint32_t>(i), maxDistance);
+    return found;
 }
 
-} // namespace nyx
\ No newline at end of file
+} // namespace nyx
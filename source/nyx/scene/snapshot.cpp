@@ -0,0 +1,237 @@
+#include "nyx/physics/scene/physics_world.h"
+#include "nyx/physics/scene/snapshot.h"
+#include "nyx/core/mapped_file.h"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nyx {
+
+namespace {
+
+template <typename T>
+concept StateArray = requires(T& array) {
+    array.data();
+    array.size();
+    typename T::value_type;
+};
+
+template <typename T>
+constexpr uint32_t elementSize() {
+    if constexpr (StateArray<T>) {
+        static_assert(std::is_trivially_destructible_v<typename T::value_type>, "State arrays are copied as bytes");
+        return sizeof(typename T::value_type);
+    } else {
+        static_assert(std::is_trivially_destructible_v<T>, "State values are copied as bytes");
+        return sizeof(T);
+    }
+}
+
+NYX_FORCEINLINE uint64_t alignBlock(uint64_t offset) {
+    return (offset + kSnapshotAlignment - 1) & ~(kSnapshotAlignment - 1);
+}
+
+NYX_FORCEINLINE uint64_t firstBlock(uint32_t sections) {
+    return alignBlock(sizeof(SnapshotHeader) + uint64_t(sections) * sizeof(SnapshotSection));
+}
+
+template <typename Data, typename Shapes, typename Manifolds, typename Fn>
+void visitWorld(SnapshotWorldState& state, Data& data, Shapes& shapes, Manifolds& manifolds, Fn&& fn) {
+    fn(state);
+    data.visitState(fn);
+    shapes.visitState(fn);
+    manifolds.visitState(fn);
+}
+
+} // namespace
+
+size_t PhysicsWorld::getSnapshotSize() const {
+    SnapshotWorldState state{};
+    uint32_t sections = 0;
+    uint64_t bytes = 0;
+    visitWorld(state, Rb.getData(), Shapes, Manifolds, [&](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        ++sections;
+        if constexpr (StateArray<T>)
+            bytes = alignBlock(bytes + value.size() * elementSize<T>());
+        else
+            bytes = alignBlock(bytes + sizeof(T));
+    });
+    return static_cast<size_t>(firstBlock(sections) + bytes);
+}
+
+size_t PhysicsWorld::saveSnapshot(void* buffer, size_t size) const {
+    const size_t total = getSnapshotSize();
+    if (size < total)
+        return 0;
+
+    const ContactSolverSettings& solver = Solver.getSettings();
+    const SleepSettings& sleep = Islands.getSettings();
+    SnapshotWorldState state{};
+    state.Gravity = Rb.getGravity();
+    state.Broadphase = static_cast<uint32_t>(BpType);
+    state.SolverIterations = solver.Iterations;
+    state.Baumgarte = solver.Baumgarte;
+    state.Slop = solver.Slop;
+    state.Friction = solver.Friction;
+    state.Restitution = solver.Restitution;
+    state.RestitutionThreshold = solver.RestitutionThreshold;
+    state.Tolerance = solver.Tolerance;
+    state.SleepLinearThreshold = sleep.LinearThreshold;
+    state.SleepAngularThreshold = sleep.AngularThreshold;
+    state.TimeToSleep = sleep.TimeToSleep;
+    state.WarmStarting = solver.WarmStarting ? 1 : 0;
+    state.SleepEnabled = sleep.Enabled ? 1 : 0;
+
+    std::byte* out = static_cast<std::byte*>(buffer);
+    uint32_t sections = 0;
+    visitWorld(state, Rb.getData(), Shapes, Manifolds, [&](const auto&) { ++sections; });
+
+    SnapshotHeader header{};
+    std::memcpy(header.Magic, kSnapshotMagic, sizeof(header.Magic));
+    header.Version = kSnapshotVersion;
+    header.ByteOrder = kSnapshotByteOrder;
+    header.RealSize = sizeof(real_t);
+    header.SectionCount = sections;
+    header.Size = total;
+    header.Bodies = Rb.getData().size();
+    std::memcpy(out, &header, sizeof(header));
+
+    SnapshotSection* table = reinterpret_cast<SnapshotSection*>(out + sizeof(header));
+    uint64_t offset = firstBlock(sections);
+    uint32_t index = 0;
+    visitWorld(state, Rb.getData(), Shapes, Manifolds, [&](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        SnapshotSection section{};
+        section.Offset = offset;
+        section.ElementSize = elementSize<T>();
+        if constexpr (StateArray<T>) {
+            section.Count = value.size();
+            std::memcpy(out + offset, value.data(), value.size() * section.ElementSize);
+        } else {
+            section.Count = 1;
+            std::memcpy(out + offset, &value, sizeof(T));
+        }
+        std::memcpy(&table[index++], &section, sizeof(section));
+        offset = alignBlock(offset + section.Count * section.ElementSize);
+    });
+
+    // Padding between blocks is zeroed so equal worlds give equal snapshots
+    std::memset(out + sizeof(header) + sections * sizeof(SnapshotSection), 0,
+                firstBlock(sections) - sizeof(header) - sections * sizeof(SnapshotSection));
+    index = 0;
+    visitWorld(state, Rb.getData(), Shapes, Manifolds, [&](const auto&) {
+        SnapshotSection section;
+        std::memcpy(&section, &table[index++], sizeof(section));
+        const uint64_t end = section.Offset + section.Count * section.ElementSize;
+        const uint64_t next = index < sections ? alignBlock(end) : total;
+        std::memset(out + end, 0, next - end);
+    });
+    return total;
+}
+
+bool PhysicsWorld::saveSnapshot(const char* path) const {
+    MappedFile file;
+    if (!file.create(path, getSnapshotSize()))
+        return false;
+    const bool written = saveSnapshot(file.data(), file.size()) != 0;
+    return file.close() && written;
+}
+
+bool PhysicsWorld::loadSnapshot(const void* data, size_t size) {
+    const std::byte* in = static_cast<const std::byte*>(data);
+    SnapshotHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, in, sizeof(header));
+    if (std::memcmp(header.Magic, kSnapshotMagic, sizeof(header.Magic)) != 0 || header.Version != kSnapshotVersion
+        || header.ByteOrder != kSnapshotByteOrder || header.RealSize != sizeof(real_t) || header.Size > size)
+        return false;
+
+    // Everything is checked before anything is replaced
+    SnapshotWorldState state{};
+    uint32_t sections = 0;
+    bool valid = true;
+    visitWorld(state, Rb.getData(), Shapes, Manifolds, [&](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        const uint32_t index = sections++;
+        if (!valid || sections > header.SectionCount || firstBlock(sections) > header.Size) {
+            valid = false;
+            return;
+        }
+        SnapshotSection section;
+        std::memcpy(&section, in + sizeof(header) + index * sizeof(SnapshotSection), sizeof(section));
+        // The element size first, as the count check divides by it
+        valid = section.ElementSize == elementSize<T>() && section.Offset <= header.Size &&
+                section.Count <= (header.Size - section.Offset) / section.ElementSize && (StateArray<T> || section.Count == 1);
+    });
+    if (!valid || sections != header.SectionCount)
+        return false;
+
+    // Read into fresh containers, so data that does not hold together is
+    // rejected before anything is replaced
+    RigidbodyData bodies(0);
+    ShapeStore shapes;
+    ManifoldCache manifolds;
+    uint32_t index = 0;
+    visitWorld(state, bodies, shapes, manifolds, [&](auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        SnapshotSection section;
+        std::memcpy(&section, in + sizeof(header) + index++ * sizeof(SnapshotSection), sizeof(section));
+        if constexpr (StateArray<T>) {
+            value.resize(section.Count);
+            std::memcpy(static_cast<void*>(value.data()), in + section.Offset, section.Count * section.ElementSize);
+        } else {
+            std::memcpy(static_cast<void*>(&value), in + section.Offset, sizeof(T));
+        }
+    });
+    if (state.Broadphase > static_cast<uint32_t>(BroadphaseType::HashGrid) || state.WarmStarting > 1 || state.SleepEnabled > 1)
+        return false;
+    if (header.Bodies != bodies.size() || !bodies.isConsistent() || !shapes.isConsistent(bodies.size()) || !manifolds.isConsistent(bodies.size()))
+        return false;
+
+    // Both walks list the same values in the same order, so each one moves into
+    // its counterpart
+    std::vector<void*> loaded;
+    visitWorld(state, bodies, shapes, manifolds, [&](auto& value) { loaded.push_back(&value); });
+    SnapshotWorldState unused{};
+    index = 0;
+    visitWorld(unused, Rb.accessData(), Shapes, Manifolds, [&](auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        value = std::move(*static_cast<T*>(loaded[index++]));
+    });
+
+    ContactSolverSettings solver;
+    solver.Iterations = state.SolverIterations;
+    solver.Baumgarte = state.Baumgarte;
+    solver.Slop = state.Slop;
+    solver.Friction = state.Friction;
+    solver.Restitution = state.Restitution;
+    solver.RestitutionThreshold = state.RestitutionThreshold;
+    solver.Tolerance = state.Tolerance;
+    solver.WarmStarting = state.WarmStarting != 0;
+    SleepSettings sleep;
+    sleep.Enabled = state.SleepEnabled != 0;
+    sleep.LinearThreshold = state.SleepLinearThreshold;
+    sleep.AngularThreshold = state.SleepAngularThreshold;
+    sleep.TimeToSleep = state.TimeToSleep;
+
+    Rb.setGravity(state.Gravity);
+    Solver.setSettings(solver);
+    Islands.setSettings(sleep);
+    Rb.restored();
+    Manifolds.restored();
+    Np.clear();
+    Transforms.reset();
+    setBroadphase(static_cast<BroadphaseType>(state.Broadphase));
+    return true;
+}
+
+bool PhysicsWorld::loadSnapshot(const char* path) {
+    MappedFile file;
+    return file.openRead(path) && loadSnapshot(file.data(), file.size());
+}
+
+} // namespace nyx
@@ -0,0 +1,200 @@
+#include "nyx/physics/scene/transform_buffer.h"
+#include "nyx/core/cpu_features.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(NYX_SIMD_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace nyx {
+
+namespace {
+
+constexpr uint32_t kNoHistory = ~0u;
+
+size_t padToLaneWidth(size_t count) {
+    return (count + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+}
+
+void interpolateScalar(const TransformFrame& frame, real_t alpha, TransformLanes& out, size_t begin, size_t end) {
+    const TransformLanes& a = frame.Previous;
+    const TransformLanes& b = frame.Current;
+    for (size_t i = begin; i < end; ++i) {
+        out.PositionX[i] = a.PositionX[i] + (b.PositionX[i] - a.PositionX[i]) * alpha;
+        out.PositionY[i] = a.PositionY[i] + (b.PositionY[i] - a.PositionY[i]) * alpha;
+        out.PositionZ[i] = a.PositionZ[i] + (b.PositionZ[i] - a.PositionZ[i]) * alpha;
+
+        // q and -q are the same rotation; start from whichever is closer to the target
+        const real_t dot = (a.OrientationW[i] * b.OrientationW[i] + a.OrientationX[i] * b.OrientationX[i]) +
+                           (a.OrientationY[i] * b.OrientationY[i] + a.OrientationZ[i] * b.OrientationZ[i]);
+        const real_t s = dot < 0.0f ? -1.0f : 1.0f;
+        const real_t aw = a.OrientationW[i] * s, ax = a.OrientationX[i] * s, ay = a.OrientationY[i] * s, az = a.OrientationZ[i] * s;
+        real_t w = aw + (b.OrientationW[i] - aw) * alpha;
+        real_t x = ax + (b.OrientationX[i] - ax) * alpha;
+        real_t y = ay + (b.OrientationY[i] - ay) * alpha;
+        real_t z = az + (b.OrientationZ[i] - az) * alpha;
+
+        const real_t mag = std::sqrt((w * w + x * x) + (y * y + z * z));
+        if (mag > 0.0f) {
+            const real_t invMag = 1.0f / mag;
+            w *= invMag; x *= invMag; y *= invMag; z *= invMag;
+        }
+        out.OrientationW[i] = w; out.OrientationX[i] = x; out.OrientationY[i] = y; out.OrientationZ[i] = z;
+    }
+}
+
+#if defined(NYX_SIMD_DISPATCH)
+NYX_FORCEINLINE NYX_TARGET_AVX2 __m256 lerp8(const real_t* a, const real_t* b, __m256 alpha) {
+    const __m256 va = _mm256_load_ps(a);
+    return _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(b), va), alpha));
+}
+
+// 8 bodies per iteration, padding included
+NYX_TARGET_AVX2 void interpolateAvx2(const TransformFrame& frame, real_t alpha, TransformLanes& out, size_t begin, size_t end) {
+    const TransformLanes& a = frame.Previous;
+    const TransformLanes& b = frame.Current;
+    const __m256 vAlpha = _mm256_set1_ps(alpha);
+    const __m256 vSign = _mm256_set1_ps(-0.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+
+    for (size_t i = begin; i < end; i += 8) {
+        _mm256_store_ps(&out.PositionX[i], lerp8(&a.PositionX[i], &b.PositionX[i], vAlpha));
+        _mm256_store_ps(&out.PositionY[i], lerp8(&a.PositionY[i], &b.PositionY[i], vAlpha));
+        _mm256_store_ps(&out.PositionZ[i], lerp8(&a.PositionZ[i], &b.PositionZ[i], vAlpha));
+
+        const __m256 bw = _mm256_load_ps(&b.OrientationW[i]);
+        const __m256 bx = _mm256_load_ps(&b.OrientationX[i]);
+        const __m256 by = _mm256_load_ps(&b.OrientationY[i]);
+        const __m256 bz = _mm256_load_ps(&b.OrientationZ[i]);
+        __m256 aw = _mm256_load_ps(&a.OrientationW[i]);
+        __m256 ax = _mm256_load_ps(&a.OrientationX[i]);
+        __m256 ay = _mm256_load_ps(&a.OrientationY[i]);
+        __m256 az = _mm256_load_ps(&a.OrientationZ[i]);
+
+        // Flip the start onto the shorter arc by moving the sign bit of the dot product into it
+        const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(aw, bw), _mm256_mul_ps(ax, bx)),
+                                         _mm256_add_ps(_mm256_mul_ps(ay, by), _mm256_mul_ps(az, bz)));
+        const __m256 flip = _mm256_and_ps(dot, vSign);
+        aw = _mm256_xor_ps(aw, flip);
+        ax = _mm256_xor_ps(ax, flip);
+        ay = _mm256_xor_ps(ay, flip);
+        az = _mm256_xor_ps(az, flip);
+
+        const __m256 w = _mm256_add_ps(aw, _mm256_mul_ps(_mm256_sub_ps(bw, aw), vAlpha));
+        const __m256 x = _mm256_add_ps(ax, _mm256_mul_ps(_mm256_sub_ps(bx, ax), vAlpha));
+        const __m256 y = _mm256_add_ps(ay, _mm256_mul_ps(_mm256_sub_ps(by, ay), vAlpha));
+        const __m256 z = _mm256_add_ps(az, _mm256_mul_ps(_mm256_sub_ps(bz, az), vAlpha));
+
+        const __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w, w), _mm256_mul_ps(x, x)),
+                                          _mm256_add_ps(_mm256_mul_ps(y, y), _mm256_mul_ps(z, z)));
+        const __m256 nonZero = _mm256_cmp_ps(len2, vZero, _CMP_GT_OQ);
+        const __m256 invMag = _mm256_blendv_ps(vOne, _mm256_div_ps(vOne, _mm256_sqrt_ps(len2)), nonZero);
+
+        _mm256_store_ps(&out.OrientationW[i], _mm256_mul_ps(w, invMag));
+        _mm256_store_ps(&out.OrientationX[i], _mm256_mul_ps(x, invMag));
+        _mm256_store_ps(&out.OrientationY[i], _mm256_mul_ps(y, invMag));
+        _mm256_store_ps(&out.OrientationZ[i], _mm256_mul_ps(z, invMag));
+    }
+}
+#endif
+
+} // namespace
+
+void TransformLanes::resize(size_t count) {
+    const size_t padded = padToLaneWidth(count);
+    for (LaneVector<real_t>* lane : {&PositionX, &PositionY, &PositionZ, &OrientationW, &OrientationX, &OrientationY, &OrientationZ}) {
+        lane->resize(padded);
+        // The count shrinks and grows, so padding may hold lanes of earlier bodies
+        std::fill(lane->begin() + count, lane->end(), lane == &OrientationW ? 1.0f : 0.0f);
+    }
+    Count = count;
+}
+
+void TransformBuffer::publish(const RigidbodyData& data, uint64_t frame, real_t dt, JobSystem* jobs) {
+    const size_t count = data.size();
+    TransformFrame& f = Frames[Back];
+    f.Previous.resize(count);
+    f.Current.resize(count);
+    f.Handles.resize(count);
+    f.Frame = frame;
+    f.Dt = dt;
+
+    // The frame published last is not written again before this one is out;
+    // the reader may be looking at it, but only reading as well
+    const TransformLanes& old = Frames[Last].Current;
+    const LaneVector<RigidbodyHandle>& oldHandles = Frames[Last].Handles;
+    const size_t oldCount = HistoryCount;
+    HistorySlots.resize(data.getHandleSlotCount(), kNoHistory);
+
+    const LaneVector<Vec3>& positions = data.getPositions();
+    const LaneVector<Quaternion>& orientations = data.getOrientations();
+    parallelFor(jobs, count, kLaneWidth, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3& p = positions[i];
+            const Quaternion& q = orientations[i];
+            const RigidbodyHandle handle = data.getHandle(i);
+            f.Current.PositionX[i] = p.X;
+            f.Current.PositionY[i] = p.Y;
+            f.Current.PositionZ[i] = p.Z;
+            f.Current.OrientationW[i] = q.w;
+            f.Current.OrientationX[i] = q.x;
+            f.Current.OrientationY[i] = q.y;
+            f.Current.OrientationZ[i] = q.z;
+            f.Handles[i] = handle;
+
+            // The slot may have been reused since; the generation tells
+            const uint32_t j = HistorySlots[handle.Slot];
+            const bool known = j < oldCount && oldHandles[j] == handle;
+            const TransformLanes& src = known ? old : f.Current;
+            const size_t k = known ? j : i;
+            f.Previous.PositionX[i] = src.PositionX[k];
+            f.Previous.PositionY[i] = src.PositionY[k];
+            f.Previous.PositionZ[i] = src.PositionZ[k];
+            f.Previous.OrientationW[i] = src.OrientationW[k];
+            f.Previous.OrientationX[i] = src.OrientationX[k];
+            f.Previous.OrientationY[i] = src.OrientationY[k];
+            f.Previous.OrientationZ[i] = src.OrientationZ[k];
+        }
+    });
+    // Only after every lookup above is done; each body owns its slot
+    parallelFor(jobs, count, kBodiesPerCacheLine, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            HistorySlots[data.getHandle(i).Slot] = static_cast<uint32_t>(i);
+    });
+    HistoryCount = count;
+    Last = Back;
+
+    // Release makes the frame's contents visible before its index
+    const uint8_t latest = Latest.exchange(static_cast<uint8_t>(Back | kFresh), std::memory_order_acq_rel);
+    Back = latest & kIndexMask;
+}
+
+const TransformFrame& TransformBuffer::acquire() {
+    if (Latest.load(std::memory_order_relaxed) & kFresh) {
+        const uint8_t latest = Latest.exchange(Front, std::memory_order_acq_rel);
+        Front = latest & kIndexMask;
+    }
+    return Frames[Front];
+}
+
+void interpolateTransforms(const TransformFrame& frame, real_t alpha, TransformLanes& out) {
+    out.resize(frame.size());
+    interpolateTransforms(frame, alpha, out, 0, frame.size());
+}
+
+void interpolateTransforms(const TransformFrame& frame, real_t alpha, TransformLanes& out, size_t begin, size_t end) {
+    assert(out.paddedSize() == frame.Current.paddedSize() && "Resize the output to the frame first");
+#if defined(NYX_SIMD_DISPATCH)
+    if (getSimdLevel() >= SimdLevel::Avx2) {
+        interpolateAvx2(frame, alpha, out, begin, end);
+        return;
+    }
+#endif
+    interpolateScalar(frame, alpha, out, begin, end);
+}
+
+} // namespace nyx
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+std::vector<BodyPair> bruteForcePairs(const RigidbodyData& data) {
+    std::vector<BodyPair> pairs;
+    const AabbLanes& bounds = data.getBounds();
+    const auto& active = data.getActive();
+    for (uint32_t a = 0; a < bounds.size(); ++a) {
+        for (uint32_t b = a + 1; b < bounds.size(); ++b) {
+            if ((active[a] || active[b]) && bounds.overlaps(a, b))
+                pairs.push_back(BodyPair{a, b});
+        }
+    }
+    return pairs;
+}
+
+void fillWorld(PhysicsWorld& world, size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> velocity(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 1.0f);
+
+    Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    for (size_t i = 0; i < count; ++i) {
+        RigidbodyHandle id = world.addRigidbody(Vec3(position(rng), position(rng) * 0.2f, position(rng)),
+                                                Vec3(velocity(rng), velocity(rng), velocity(rng)), 1.0f, inertia);
+        world.setBoundingRadius(id, radius(rng));
+        if (i % 7 == 0)
+            world.accessRigidbodyData().accessActive()[world.getIndex(id)] = 0;
+    }
+}
+
+bool checkBroadphase(BroadphaseType type, const JobSystemSettings& jobSettings) {
+    PhysicsWorld world(jobSettings);
+    world.setBroadphase(type);
+    fillWorld(world, 2000, 42);
+
+    for (int step = 0; step < 30; ++step) {
+        // Bodies arriving mid-simulation must be picked up as well
+        if (step == 15)
+            fillWorld(world, 100, 7);
+
+        // Removing a body moves the last one into its index, which every broadphase
+        // has to follow; a few at a time are repaired in place, many force a rebuild
+        if (step == 10 || step == 12 || step == 15) {
+            const RigidbodyData& data = world.getRigidbodyData();
+            std::vector<RigidbodyHandle> removed;
+            for (size_t i = step; i < data.size(); i += step == 12 ? 400 : 4)
+                removed.push_back(data.getHandle(i));
+            for (RigidbodyHandle handle : removed)
+                world.removeRigidbody(handle);
+        }
+
+        // Bodies switching between active and inactive move between the tree broadphase's trees
+        if (step == 20) {
+            auto& active = world.accessRigidbodyData().accessActive();
+            for (size_t i = 0; i < active.size(); i += 5)
+                active[i] = !active[i];
+        }
+
+        // Inactive bodies moved by hand refit the static tree
+        if (step == 25) {
+            auto& data = world.accessRigidbodyData();
+            for (size_t i = 0; i < data.getActive().size(); ++i) {
+                if (!data.getActive()[i])
+                    data.accessPositions()[i] += Vec3(0.3f, 0.0f, -0.2f);
+            }
+        }
+
+        world.update(0.016f);
+
+        std::vector<BodyPair> pairs = world.getPairs();
+        std::sort(pairs.begin(), pairs.end());
+        if (std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end())
+            return false;
+        if (pairs != bruteForcePairs(world.getRigidbodyData()))
+            return false;
+    }
+    return true;
+}
+
+bool checkQueries(BroadphaseType type) {
+    PhysicsWorld world;
+    world.setBroadphase(type);
+    fillWorld(world, 2000, 3);
+    for (int step = 0; step < 5; ++step)
+        world.update(0.016f);
+
+    const AabbLanes& bounds = world.getRigidbodyData().getBounds();
+
+    const Aabb box{Vec3(-5.0f, -2.0f, -5.0f), Vec3(5.0f, 2.0f, 5.0f)};
+    std::vector<uint32_t> found;
+    world.queryOverlap(box, found);
+    std::sort(found.begin(), found.end());
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < bounds.size(); ++i) {
+        if (bounds.get(i).overlaps(box))
+            expected.push_back(i);
+    }
+    if (found != expected)
+        return false;
+
+    // The closest hit must match a linear scan along the ray
+    const Vec3 origin(-30.0f, 0.1f, 0.3f);
+    const Vec3 direction(1.0f, 0.0f, 0.0f);
+    const Vec3 invDirection(1.0f, 1.0f / 0.0f, 1.0f / 0.0f);
+    real_t closest = 100.0f;
+    bool expectHit = false;
+    for (uint32_t i = 0; i < bounds.size(); ++i) {
+        real_t distance;
+        if (bounds.get(i).intersectRay(origin, invDirection, closest, distance)) {
+            closest = distance;
+            expectHit = true;
+        }
+    }
+
+    RaycastHit hit;
+    const bool gotHit = world.raycast(origin, direction, 100.0f, hit);
+    return gotHit == expectHit && (!gotHit || hit.Distance == closest);
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("sweep and prune", checkBroadphase(BroadphaseType::SweepAndPrune, {}));
+    report("sweep and prune threaded", checkBroadphase(BroadphaseType::SweepAndPrune, JobSystemSettings{.WorkerCount = 3}));
+    report("aabb tree", checkBroadphase(BroadphaseType::AabbTree, {}));
+    report("aabb tree threaded", checkBroadphase(BroadphaseType::AabbTree, JobSystemSettings{.WorkerCount = 3}));
+    report("hash grid", checkBroadphase(BroadphaseType::HashGrid, {}));
+    report("hash grid threaded", checkBroadphase(BroadphaseType::HashGrid, JobSystemSettings{.WorkerCount = 3}));
+    report("aabb tree queries", checkQueries(BroadphaseType::AabbTree));
+    report("linear scan queries", checkQueries(BroadphaseType::SweepAndPrune));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+// Bulk creation must match adding the bodies one by one, for diagonal and rotated inertias
+bool checkBulkAdd() {
+    std::vector<RigidbodyDesc> bodies(1003);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const real_t f = static_cast<real_t>(i);
+        RigidbodyDesc& body = bodies[i];
+        body.Position = Vec3(f, 1.0f, -f);
+        body.Velocity = Vec3(0.0f, 0.1f * f, 0.0f);
+        body.Mass = 1.0f + 0.01f * f;
+        const real_t d = 0.4f + 0.001f * f;
+        const real_t o = i < 500 ? 0.0f : 0.05f; // off-diagonal terms in the second half
+        body.Inertia = Mat3(d, o, 0.0f, o, d * 2.0f, o, 0.0f, o, d * 3.0f);
+    }
+
+    PhysicsWorld single;
+    PhysicsWorld bulk(JobSystemSettings{.WorkerCount = 3});
+    single.addRigidbody(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    bulk.addRigidbody(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    for (const RigidbodyDesc& body : bodies)
+        single.addRigidbody(body.Position, body.Velocity, body.Mass, body.Inertia);
+    std::vector<RigidbodyHandle> handles(bodies.size());
+    bulk.addRigidbodies(bodies, handles.data());
+
+    const RigidbodyData& a = single.getRigidbodyData();
+    const RigidbodyData& b = bulk.getRigidbodyData();
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < handles.size(); ++k) {
+        if (bulk.getIndex(handles[k]) != k + 1 || b.getHandle(k + 1) != a.getHandle(k + 1))
+            return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.getPositions()[i].X != b.getPositions()[i].X || a.getVelocities()[i].Y != b.getVelocities()[i].Y ||
+            a.getInvMasses()[i] != b.getInvMasses()[i])
+            return false;
+        const Mat3 invA = a.getInvInertias()[i].toMat3(), invB = b.getInvInertias()[i].toMat3();
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                if (std::abs(invA.m[r][c] - invB.m[r][c]) > 1e-5f)
+                    return false;
+            }
+        }
+    }
+
+    // The new bodies are picked up by the next step like any others
+    bulk.update(0.016f);
+    return b.getAwakeBodies().size() == b.size() && b.getPositions()[2].Y != 1.0f;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("bulk add", checkBulkAdd());
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,390 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+
+Mat3 boxInertia(real_t mass, const Vec3& e) {
+    const real_t k = mass / 3.0f;
+    return Mat3(k * (e.Y * e.Y + e.Z * e.Z), 0.0f, 0.0f,
+                0.0f, k * (e.X * e.X + e.Z * e.Z), 0.0f,
+                0.0f, 0.0f, k * (e.X * e.X + e.Y * e.Y));
+}
+
+// Static ground whose top face is at y = 0
+RigidbodyHandle addGround(PhysicsWorld& world) {
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, Vec3(10.0f, 0.5f, 10.0f)));
+    world.setBoxShape(ground, Vec3(10.0f, 0.5f, 10.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+    return ground;
+}
+
+bool checkSphereRests(const JobSystemSettings& jobSettings) {
+    PhysicsWorld world(jobSettings);
+    world.setBroadphase(BroadphaseType::SweepAndPrune);
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+
+    const Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    const RigidbodyHandle ball = world.addRigidbody(Vec3(0.0f, 2.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, inertia);
+    world.setSphereShape(ball, 1.0f);
+
+    for (int step = 0; step < 240; ++step)
+        world.update(kDt);
+
+    const RigidbodyData& data = world.getRigidbodyData();
+    const size_t index = world.getIndex(ball);
+    return std::abs(data.getPositions()[index].Y - 1.0f) < 0.02f && data.getVelocities()[index].length() < 0.05f;
+}
+
+// Three boxes on top of each other must neither sink nor topple
+bool checkBoxStack(const JobSystemSettings& jobSettings) {
+    PhysicsWorld world(jobSettings);
+    world.setBroadphase(BroadphaseType::AabbTree);
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+
+    const Vec3 e(0.5f, 0.5f, 0.5f);
+    size_t boxes[3];
+    for (int i = 0; i < 3; ++i) {
+        const RigidbodyHandle box = world.addRigidbody(Vec3(0.0f, 0.5f + i * 1.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e));
+        world.setBoxShape(box, e);
+        boxes[i] = world.getIndex(box);
+    }
+
+    for (int step = 0; step < 300; ++step)
+        world.update(kDt);
+
+    const RigidbodyData& data = world.getRigidbodyData();
+    for (int i = 0; i < 3; ++i) {
+        const Vec3& p = data.getPositions()[boxes[i]];
+        if (std::abs(p.Y - (0.5f + i * 1.0f)) > 0.05f || std::abs(p.X) > 0.01f || std::abs(p.Z) > 0.01f)
+            return false;
+        if (data.getVelocities()[boxes[i]].length() > 0.05f)
+            return false;
+    }
+
+    // Each resting pair has its whole face in the manifold, holding the weight above it
+    const ContactManifold* bottom = world.getManifolds().find(0, static_cast<uint32_t>(boxes[0]));
+    if (!bottom || bottom->PointCount != 4)
+        return false;
+    real_t impulse = 0.0f;
+    for (uint32_t p = 0; p < bottom->PointCount; ++p)
+        impulse += bottom->Points[p].NormalImpulse;
+    return std::abs(impulse - 3.0f * 9.81f * kDt) < 0.1f * 3.0f * 9.81f * kDt;
+}
+
+// A wall of boxes; colors only ever hold manifolds with distinct moving bodies,
+// so the threaded solve must match the inline one exactly
+bool buildWall(PhysicsWorld& world) {
+    world.setBroadphase(BroadphaseType::HashGrid);
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+
+    const Vec3 e(0.25f, 0.25f, 0.25f);
+    for (int row = 0; row < 10; ++row) {
+        for (int column = 0; column < 20; ++column) {
+            for (int depth = 0; depth < 2; ++depth) {
+                const Vec3 position(column * 0.5f + (row % 2) * 0.25f, 0.25f + row * 0.5f, depth * 0.5f);
+                const RigidbodyHandle id = world.addRigidbody(position, Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e));
+                world.setBoxShape(id, e);
+            }
+        }
+    }
+    return true;
+}
+
+bool checkSolverStats() {
+    PhysicsWorld world;
+    buildWall(world);
+    for (int step = 0; step < 60; ++step)
+        world.update(kDt);
+
+    // Stats describe the manifolds at the start of the step, before the cache update
+    const ContactSolverStats& stats = world.getContactSolverStats();
+    if (stats.Manifolds == 0 || stats.Points < stats.Manifolds || stats.Iterations != world.getContactSolverSettings().Iterations)
+        return false;
+    if (stats.Colors < 2 || stats.Batches * kSolverWidth < stats.Manifolds - stats.OverflowManifolds)
+        return false;
+    if (!(stats.LastImpulseDelta < stats.FirstImpulseDelta))
+        return false;
+
+    // With a tolerance the solver stops as soon as it is reached
+    ContactSolverSettings settings = world.getContactSolverSettings();
+    settings.Iterations = 100;
+    settings.Tolerance = 0.01f;
+    world.setContactSolverSettings(settings);
+    world.update(kDt);
+    return world.getContactSolverStats().Iterations < 100 && world.getContactSolverStats().LastImpulseDelta <= 0.01f;
+}
+
+// Per step counters and timings, with the last kStatsHistory steps kept
+bool checkWorldStats() {
+    PhysicsWorld world;
+    buildWall(world);
+    world.setSleepSettings(SleepSettings{.Enabled = false});
+    world.setTransformPublishing(true); // so every stage runs
+    const int steps = static_cast<int>(PhysicsWorld::kStatsHistory) + 10;
+    for (int step = 0; step < steps; ++step)
+        world.update(kDt);
+
+    const PhysicsStats& stats = world.getStats();
+    if (stats.Frame != static_cast<uint64_t>(steps - 1) || stats.Bodies != 401 || stats.AwakeBodies != 400)
+        return false;
+    if (stats.Pairs == 0 || stats.Contacts == 0 || stats.Manifolds == 0)
+        return false;
+    if (stats.SolverIterations != world.getContactSolverSettings().Iterations)
+        return false;
+
+    const auto& history = world.getStatsHistory();
+    if (history.size() != PhysicsWorld::kStatsHistory || history.back().Frame != stats.Frame || history[0].Frame != stats.Frame + 1 - PhysicsWorld::kStatsHistory)
+        return false;
+
+#if defined(NYX_PROFILE)
+    uint64_t stages = 0;
+    for (uint32_t stage = 0; stage < kPhysicsStageCount; ++stage) {
+        if (stats.Stages[stage].Nanoseconds == 0)
+            return false;
+        stages += stats.Stages[stage].Nanoseconds;
+    }
+    return stages <= stats.Step.Nanoseconds && stats.Rigidbodies.Bounds.Nanoseconds <= stats.getStage(PhysicsStage::Positions).Nanoseconds;
+#else
+    return stats.Step.Nanoseconds == 0;
+#endif
+}
+
+bool checkThreadedMatchesInline() {
+    PhysicsWorld serial(JobSystemSettings{.WorkerCount = 0});
+    PhysicsWorld threaded(JobSystemSettings{.WorkerCount = 3});
+    buildWall(serial);
+    buildWall(threaded);
+    for (int step = 0; step < 60; ++step) {
+        serial.update(kDt);
+        threaded.update(kDt);
+    }
+
+    const LaneVector<Vec3>& a = serial.getRigidbodyData().getPositions();
+    const LaneVector<Vec3>& b = threaded.getRigidbodyData().getPositions();
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].X != b[i].X || a[i].Y != b[i].Y || a[i].Z != b[i].Z)
+            return false;
+    }
+    return true;
+}
+
+std::vector<RigidbodyHandle> addStack(PhysicsWorld& world, real_t x, int height) {
+    const Vec3 e(0.5f, 0.5f, 0.5f);
+    std::vector<RigidbodyHandle> boxes;
+    for (int i = 0; i < height; ++i) {
+        boxes.push_back(world.addRigidbody(Vec3(x, 0.5f + i * 1.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e)));
+        world.setBoxShape(boxes.back(), e);
+    }
+    return boxes;
+}
+
+// Resting stacks fall asleep island by island and stop moving entirely
+bool checkStacksSleep() {
+    PhysicsWorld world;
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+    const std::vector<RigidbodyHandle> left = addStack(world, -3.0f, 3);
+    const std::vector<RigidbodyHandle> right = addStack(world, 3.0f, 3);
+
+    // Boxes placed exactly touching only collide once they sink in a little
+    for (int step = 0; step < 10; ++step)
+        world.update(kDt);
+    if (world.getIslandCount() != 2)
+        return false;
+
+    for (int step = 0; step < 240; ++step)
+        world.update(kDt);
+
+    const RigidbodyData& data = world.getRigidbodyData();
+    if (!data.getAwakeBodies().empty())
+        return false;
+    for (size_t i = 0; i < 3; ++i) {
+        if (world.isAwake(left[i]) || world.isAwake(right[i]) || data.getVelocities()[world.getIndex(left[i])].length() != 0.0f)
+            return false;
+    }
+
+    // Nothing moves, and the manifolds of the sleeping pairs are kept
+    const LaneVector<Vec3> before = data.getPositions();
+    const size_t manifolds = world.getManifolds().getManifolds().size();
+    for (int step = 0; step < 10; ++step)
+        world.update(kDt);
+    for (size_t i = 0; i < before.size(); ++i) {
+        if (data.getPositions()[i].X != before[i].X || data.getPositions()[i].Y != before[i].Y)
+            return false;
+    }
+    return world.getManifolds().getManifolds().size() == manifolds && world.getContactSolverStats().Manifolds == 0;
+}
+
+// Something landing on a sleeping stack wakes all of it, not just the box it hits
+bool checkImpactWakesIsland() {
+    PhysicsWorld world;
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+    const std::vector<RigidbodyHandle> stack = addStack(world, 0.0f, 3);
+    for (int step = 0; step < 120; ++step)
+        world.update(kDt);
+    if (world.isAwake(stack[0]) || world.isAwake(stack[2]))
+        return false;
+
+    const Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    const RigidbodyHandle ball = world.addRigidbody(Vec3(0.0f, 3.6f, 0.0f), Vec3(0.0f, -3.0f, 0.0f), 1.0f, inertia);
+    world.setSphereShape(ball, 0.5f);
+
+    bool bottomWoke = false;
+    for (int step = 0; step < 30 && !bottomWoke; ++step) {
+        world.update(kDt);
+        bottomWoke = world.isAwake(stack[0]);
+    }
+    if (!bottomWoke || !world.isAwake(stack[1]) || !world.isAwake(stack[2]))
+        return false;
+
+    // The stack still stands and goes back to sleep with the ball on top
+    for (int step = 0; step < 240; ++step)
+        world.update(kDt);
+    const RigidbodyData& data = world.getRigidbodyData();
+    return !world.isAwake(ball) && !world.isAwake(stack[0]) && std::abs(data.getPositions()[world.getIndex(stack[2])].Y - 2.5f) < 0.05f;
+}
+
+// Forces wake sleeping bodies
+bool checkForceWakes() {
+    PhysicsWorld world;
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+    const std::vector<RigidbodyHandle> stack = addStack(world, 0.0f, 2);
+    for (int step = 0; step < 120; ++step)
+        world.update(kDt);
+    if (world.isAwake(stack[1]))
+        return false;
+
+    world.addForce(stack[1], Vec3(0.0f, 2000.0f, 0.0f));
+    world.update(kDt);
+    return world.isAwake(stack[1]) && world.isAwake(stack[0]) && world.getRigidbodyData().getVelocities()[world.getIndex(stack[1])].Y > 1.0f;
+}
+
+// Removing a box from a sleeping stack wakes it, and the boxes above drop onto the ground
+bool checkRemoveFromStack() {
+    PhysicsWorld world;
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    const RigidbodyHandle ground = addGround(world);
+    const std::vector<RigidbodyHandle> stack = addStack(world, 0.0f, 3);
+    for (int step = 0; step < 120; ++step)
+        world.update(kDt);
+    if (world.isAwake(stack[2]))
+        return false;
+
+    world.removeRigidbody(stack[0]);
+    if (world.isValid(stack[0]) || !world.isValid(stack[2]) || !world.isAwake(stack[1]) || !world.isAwake(stack[2]))
+        return false;
+
+    // The top box took the bottom one's index, along with its shape and manifolds
+    const RigidbodyData& data = world.getRigidbodyData();
+    if (data.size() != 3 || world.getIndex(stack[2]) != 1 || data.getHandle(1) != stack[2])
+        return false;
+    if (world.getShapes().getShape(world.getIndex(stack[2])).Type != ShapeType::Box)
+        return false;
+    for (const ContactManifold& manifold : world.getManifolds().getManifolds()) {
+        if (manifold.A >= manifold.B || manifold.B >= data.size())
+            return false;
+    }
+    const BodyPair pair = makeBodyPair(static_cast<uint32_t>(world.getIndex(stack[1])), static_cast<uint32_t>(world.getIndex(stack[2])));
+    if (!world.getManifolds().find(pair.A, pair.B))
+        return false;
+
+    for (int step = 0; step < 120; ++step)
+        world.update(kDt);
+    return std::abs(data.getPositions()[world.getIndex(stack[1])].Y - 0.5f) < 0.05f &&
+           std::abs(data.getPositions()[world.getIndex(stack[2])].Y - 1.5f) < 0.05f &&
+           data.getPositions()[world.getIndex(ground)].Y == -0.5f;
+}
+
+// Projectiles spawned and destroyed every step keep the arrays packed and reuse handle slots
+bool checkSpawnChurn() {
+    PhysicsWorld world;
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    addGround(world);
+
+    const Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    std::vector<RigidbodyHandle> live, removed;
+    for (int step = 0; step < 200; ++step) {
+        for (int i = 0; i < 20; ++i) {
+            const Vec3 position((i % 5) * 1.5f - 3.0f, 0.3f + (step % 3) * 0.5f, (i / 5) * 1.5f - 3.0f);
+            live.push_back(world.addRigidbody(position, Vec3(4.0f, 0.0f, 1.0f), 1.0f, inertia));
+            world.setSphereShape(live.back(), 0.25f);
+        }
+        // Oldest first, so removals hit the middle of the arrays as well as the end
+        while (live.size() > 100) {
+            world.removeRigidbody(live.front());
+            removed.push_back(live.front());
+            live.erase(live.begin());
+        }
+        world.update(kDt);
+    }
+
+    const RigidbodyData& data = world.getRigidbodyData();
+    if (data.size() != 101 || data.getAwakeBodies().size() > 100)
+        return false;
+    for (RigidbodyHandle handle : live) {
+        if (!world.isValid(handle) || data.getHandle(world.getIndex(handle)) != handle)
+            return false;
+    }
+    for (RigidbodyHandle handle : removed) {
+        if (world.isValid(handle))
+            return false;
+    }
+    for (const ContactManifold& manifold : world.getManifolds().getManifolds()) {
+        if (manifold.A >= manifold.B || manifold.B >= data.size())
+            return false;
+    }
+    return true;
+}
+
+// Manifolds of bodies that stop touching are dropped
+bool checkSeparation() {
+    PhysicsWorld world;
+    world.setBroadphase(BroadphaseType::SweepAndPrune);
+
+    const Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    const RigidbodyHandle a = world.addRigidbody(Vec3(-0.45f, 0.0f, 0.0f), Vec3(-2.0f, 0.0f, 0.0f), 1.0f, inertia);
+    const RigidbodyHandle b = world.addRigidbody(Vec3(0.45f, 0.0f, 0.0f), Vec3(2.0f, 0.0f, 0.0f), 1.0f, inertia);
+    world.setSphereShape(a, 0.5f);
+    world.setSphereShape(b, 0.5f);
+
+    world.update(kDt);
+    if (world.getManifolds().getManifolds().size() != 1)
+        return false;
+    for (int step = 0; step < 10; ++step)
+        world.update(kDt);
+    return world.getManifolds().empty();
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("sphere rests", checkSphereRests({}));
+    report("box stack", checkBoxStack({}));
+    report("box stack threaded", checkBoxStack(JobSystemSettings{.WorkerCount = 3}));
+    report("separation", checkSeparation());
+    report("solver stats", checkSolverStats());
+    report("world stats", checkWorldStats());
+    report("threaded matches inline", checkThreadedMatchesInline());
+    report("stacks sleep", checkStacksSleep());
+    report("impact wakes island", checkImpactWakesIsland());
+    report("force wakes", checkForceWakes());
+    report("remove from stack", checkRemoveFromStack());
+    report("spawn churn", checkSpawnChurn());
+
+    return failures == 0 ? 0 : 1;
+}
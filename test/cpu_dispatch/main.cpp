@@ -0,0 +1,269 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nyx/core/cpu_features.h"
+#include "nyx/physics/collision/gjk.h"
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+
+// Every level this CPU runs, scalar first
+std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels;
+    for (uint8_t i = 0; i <= static_cast<uint8_t>(getSupportedSimdLevel()); ++i)
+        levels.push_back(static_cast<SimdLevel>(i));
+    return levels;
+}
+
+Mat3 boxInertia(real_t mass, const Vec3& e) {
+    const real_t k = mass / 3.0f;
+    return Mat3(k * (e.Y * e.Y + e.Z * e.Z), 0.0f, 0.0f,
+                0.0f, k * (e.X * e.X + e.Z * e.Z), 0.0f,
+                0.0f, 0.0f, k * (e.X * e.X + e.Y * e.Y));
+}
+
+// A tensor with off-diagonal terms, as a box turned in its body frame has
+Mat3 skewedInertia(uint32_t seed) {
+    const real_t a = 0.01f * static_cast<real_t>(seed % 17);
+    return Mat3(0.5f, a, 0.02f,
+                a, 0.6f, -a,
+                0.02f, -a, 0.7f);
+}
+
+// Boxes, spheres and hulls tumbling onto the ground, so every kernel runs:
+// orientation integration, inertia inversion, the sweep, hull support and the solver
+void buildPile(PhysicsWorld& world) {
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    world.setBroadphase(BroadphaseType::SweepAndPrune);
+    world.setTransformPublishing(true);
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, Vec3(20.0f, 0.5f, 20.0f)));
+    world.setBoxShape(ground, Vec3(20.0f, 0.5f, 20.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+
+    const Vec3 hull[] = {Vec3(0.5f, 0.0f, 0.0f), Vec3(-0.5f, 0.0f, 0.0f), Vec3(0.0f, 0.5f, 0.0f),
+                         Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.5f), Vec3(0.0f, 0.0f, -0.5f)};
+    std::vector<RigidbodyDesc> bodies;
+    for (uint32_t i = 0; i < 120; ++i) {
+        RigidbodyDesc desc;
+        desc.Position = Vec3(static_cast<real_t>(i % 6) * 1.1f - 3.0f, 0.6f + static_cast<real_t>(i / 36) * 1.2f,
+                             static_cast<real_t>(i / 6 % 6) * 1.1f - 3.0f);
+        desc.Velocity = Vec3(0.1f * static_cast<real_t>(i % 3), 0.0f, -0.1f * static_cast<real_t>(i % 5));
+        desc.Inertia = i % 4 == 0 ? skewedInertia(i) : boxInertia(1.0f, Vec3(0.5f, 0.5f, 0.5f));
+        bodies.push_back(desc);
+    }
+    std::vector<RigidbodyHandle> handles(bodies.size());
+    world.addRigidbodies(bodies, handles.data());
+    for (uint32_t i = 0; i < handles.size(); ++i) {
+        world.accessRigidbodyData().accessAngularVelocities()[world.getIndex(handles[i])] = Vec3(0.3f, -0.2f * static_cast<real_t>(i % 4), 0.1f);
+        if (i % 3 == 0)
+            world.setBoxShape(handles[i], Vec3(0.5f, 0.5f, 0.5f));
+        else if (i % 3 == 1)
+            world.setSphereShape(handles[i], 0.5f);
+        else
+            world.setConvexShape(handles[i], hull, std::size(hull));
+    }
+}
+
+struct PileResult {
+    std::vector<real_t> State; // positions, orientations and inverse inertias
+    std::vector<std::vector<BodyPair>> Pairs;
+    std::vector<real_t> Interpolated;
+    uint64_t Hash = 0;
+};
+
+PileResult runPile(SimdLevel level, int steps) {
+    setSimdLevel(level);
+    PhysicsWorld world;
+    buildPile(world);
+    PileResult result;
+    for (int step = 0; step < steps; ++step) {
+        world.update(kDt);
+        result.Pairs.push_back(world.getPairs());
+    }
+
+    const RigidbodyData& data = world.getRigidbodyData();
+    for (size_t i = 0; i < data.size(); ++i) {
+        const Vec3& p = data.getPositions()[i];
+        const Quaternion& q = data.getOrientations()[i];
+        result.State.insert(result.State.end(), {p.X, p.Y, p.Z, q.w, q.x, q.y, q.z});
+        const SymMat3& inv = data.getInvInertias()[i];
+        result.State.insert(result.State.end(), {inv.XX, inv.YY, inv.ZZ, inv.XY, inv.XZ, inv.YZ});
+    }
+
+    TransformLanes lanes;
+    interpolateTransforms(world.acquireTransforms(), 0.3f, lanes);
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        result.Interpolated.insert(result.Interpolated.end(), {lanes.PositionX[i], lanes.PositionY[i], lanes.PositionZ[i], lanes.OrientationW[i],
+                                                               lanes.OrientationX[i], lanes.OrientationY[i], lanes.OrientationZ[i]});
+    }
+    result.Hash = world.getStateHash();
+    return result;
+}
+
+real_t maxDifference(const std::vector<real_t>& a, const std::vector<real_t>& b) {
+    if (a.size() != b.size())
+        return INFINITY;
+    real_t worst = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i)
+        worst = std::max(worst, std::fabs(a[i] - b[i]));
+    return worst;
+}
+
+// The detected level is one the CPU has, and setSimdLevel never goes past it
+bool checkDetect() {
+    const CpuFeatures& cpu = getCpuFeatures();
+    const SimdLevel supported = getSupportedSimdLevel();
+    if (supported >= SimdLevel::Sse4 && !cpu.Sse41)
+        return false;
+    if (supported >= SimdLevel::Avx2 && !(cpu.Avx2 && cpu.Fma))
+        return false;
+    if (supported >= SimdLevel::Avx512 && !cpu.Avx512F)
+        return false;
+    if (getSimdLevel() > supported || setSimdLevel(SimdLevel::Avx512) != supported || getSimdLevel() != supported)
+        return false;
+    if (setSimdLevel(SimdLevel::Scalar) != SimdLevel::Scalar || getSimdLevel() != SimdLevel::Scalar)
+        return false;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse4, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        SimdLevel parsed;
+        if (!parseSimdLevel(getSimdLevelName(level), parsed) || parsed != level)
+            return false;
+    }
+    SimdLevel parsed;
+    return !parseSimdLevel("sse2", parsed);
+}
+
+// Every level steps the pile to the same place. With NYX_DETERMINISTIC they
+// agree bit for bit for as long as they run; without it the compiler may fuse
+// multiply-adds differently per level, and a pile soon turns rounding into
+// visible differences, so they only agree closely over a few steps.
+bool checkLevels() {
+#if defined(NYX_DETERMINISTIC)
+    constexpr int kSteps = 90;
+#else
+    constexpr int kSteps = 20;
+#endif
+    const SimdLevel initial = getSimdLevel();
+    const PileResult reference = runPile(SimdLevel::Scalar, kSteps);
+    bool ok = true;
+    for (SimdLevel level : supportedLevels()) {
+        const PileResult result = runPile(level, kSteps);
+        const real_t state = maxDifference(result.State, reference.State);
+        const real_t interpolated = maxDifference(result.Interpolated, reference.Interpolated);
+        std::cout << "  " << getSimdLevelName(level) << ": state " << state << ", interpolated " << interpolated << "\n";
+#if defined(NYX_DETERMINISTIC)
+        ok = ok && result.Hash == reference.Hash;
+#endif
+        ok = ok && result.Pairs.front() == reference.Pairs.front() && state < 1e-3f && interpolated < 1e-3f;
+    }
+    setSimdLevel(initial);
+    return ok;
+}
+
+// The sweep alone, on bodies that never touch, so nothing but the pairs can differ
+bool checkSweep() {
+    const SimdLevel initial = getSimdLevel();
+    std::vector<std::vector<BodyPair>> reference;
+    bool ok = true;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+        PhysicsWorld world;
+        world.setBroadphase(BroadphaseType::SweepAndPrune);
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+        std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> radius(0.1f, 1.5f);
+        for (int i = 0; i < 3000; ++i) {
+            const RigidbodyHandle id = world.addRigidbody(Vec3(position(rng), position(rng) * 0.1f, position(rng)),
+                                                          Vec3(velocity(rng), velocity(rng), velocity(rng)), 1.0f, boxInertia(1.0f, Vec3(0.5f, 0.5f, 0.5f)));
+            world.setBoundingRadius(id, radius(rng));
+            if (i % 5 == 0)
+                world.accessRigidbodyData().accessActive()[world.getIndex(id)] = 0;
+        }
+
+        std::vector<std::vector<BodyPair>> pairs;
+        for (int step = 0; step < 20; ++step) {
+            world.update(kDt);
+            pairs.push_back(world.getPairs());
+        }
+        if (level == SimdLevel::Scalar)
+            reference = pairs;
+        ok = ok && pairs == reference && !pairs.back().empty();
+    }
+    setSimdLevel(initial);
+    return ok;
+}
+
+// EPA on overlapping hulls and boxes, where the closest face search and the
+// visible face test run per level. Bit for bit with NYX_DETERMINISTIC,
+// otherwise to within the EPA tolerance.
+bool checkEpa() {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<Vec3> points;
+    for (int i = 0; i < 14; ++i)
+        points.emplace_back(0.6f * unit(rng), 0.4f * unit(rng), 0.5f * unit(rng));
+    ShapeStore shapes;
+    shapes.setConvex(0, points.data(), points.size());
+    shapes.setBox(1, Vec3(0.5f, 0.3f, 0.4f));
+
+    std::vector<GjkProxy> pairs;
+    for (int i = 0; i < 500; ++i) {
+        Quaternion qa(unit(rng), unit(rng), unit(rng), unit(rng)), qb(unit(rng), unit(rng), unit(rng), unit(rng));
+        qa.normalize();
+        qb.normalize();
+        pairs.emplace_back(shapes, shapes.getShape(0), ShapeTransform(Vec3(0.0f, 0.0f, 0.0f), qa));
+        pairs.emplace_back(shapes, shapes.getShape(1), ShapeTransform(Vec3(0.4f * unit(rng), 0.4f * unit(rng), 0.4f * unit(rng)), qb));
+    }
+
+    const SimdLevel initial = getSimdLevel();
+    std::vector<Contact> reference;
+    bool ok = true;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+        std::vector<Contact> contacts;
+        for (size_t i = 0; i < pairs.size(); i += 2) {
+            Contact contact{};
+            if (collideConvex(pairs[i], pairs[i + 1], contact))
+                contacts.push_back(contact);
+        }
+        if (level == SimdLevel::Scalar) {
+            reference = contacts;
+            ok = ok && contacts.size() > 100;
+            continue;
+        }
+        ok = ok && contacts.size() == reference.size();
+        for (size_t i = 0; ok && i < contacts.size(); ++i) {
+#if defined(NYX_DETERMINISTIC)
+            const Vec3& n = contacts[i].Normal;
+            const Vec3& m = reference[i].Normal;
+            ok = n.X == m.X && n.Y == m.Y && n.Z == m.Z && contacts[i].Depth == reference[i].Depth;
+#else
+            ok = std::fabs(contacts[i].Depth - reference[i].Depth) < 1e-3f;
+#endif
+        }
+    }
+    setSimdLevel(initial);
+    return ok;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    std::cout << "simd level " << getSimdLevelName(getSimdLevel()) << " of " << getSimdLevelName(getSupportedSimdLevel()) << "\n";
+    report("detect", checkDetect());
+    report("levels", checkLevels());
+    report("sweep", checkSweep());
+    report("epa", checkEpa());
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+constexpr int kSteps = 60;
+constexpr const char* kRecordingPath = "/tmp/nyx_determinism_test.nyxrec";
+
+Mat3 boxInertia(real_t mass, const Vec3& e) {
+    const real_t k = mass / 3.0f;
+    return Mat3(k * (e.Y * e.Y + e.Z * e.Z), 0.0f, 0.0f,
+                0.0f, k * (e.X * e.X + e.Z * e.Z), 0.0f,
+                0.0f, 0.0f, k * (e.X * e.X + e.Y * e.Y));
+}
+
+// Layers of spheres, boxes and capsules dropped onto the ground, placed close
+// enough that neighbours touch from the first step
+void buildPile(PhysicsWorld& world, BroadphaseType broadphase) {
+    world.setBroadphase(broadphase);
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, Vec3(20.0f, 0.5f, 20.0f)));
+    world.setBoxShape(ground, Vec3(20.0f, 0.5f, 20.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+
+    const Vec3 e(0.5f, 0.5f, 0.5f);
+    for (int i = 0; i < 1600; ++i) {
+        const real_t x = static_cast<real_t>(i % 24) * 1.02f - 12.0f + 0.01f * static_cast<real_t>(i % 5);
+        const real_t z = static_cast<real_t>((i / 24) % 20) * 1.02f - 10.0f;
+        const real_t y = 0.6f + static_cast<real_t>(i / 480) * 1.1f;
+        const RigidbodyHandle body = world.addRigidbody(Vec3(x, y, z), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e));
+        world.accessRigidbodyData().accessAngularVelocities()[world.getIndex(body)] = Vec3(0.0f, 0.1f * static_cast<real_t>(i % 3), 0.0f);
+        if (i % 3 == 0)
+            world.setSphereShape(body, 0.5f);
+        else if (i % 3 == 1)
+            world.setBoxShape(body, e);
+        else
+            world.setCapsuleShape(body, 0.25f, 0.25f);
+    }
+}
+
+std::vector<uint64_t> recordHashes(uint32_t workers, BroadphaseType broadphase) {
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = workers});
+    buildPile(world, broadphase);
+    std::vector<uint64_t> hashes;
+    for (int step = 0; step < kSteps; ++step) {
+        world.update(kDt);
+        hashes.push_back(world.getStateHash());
+    }
+    return hashes;
+}
+
+// Every frame hashes the same for any worker count, on every broadphase
+bool checkWorkerCounts(BroadphaseType broadphase) {
+    const std::vector<uint64_t> reference = recordHashes(0, broadphase);
+    for (uint32_t workers : {1u, 3u, 7u}) {
+        const std::vector<uint64_t> hashes = recordHashes(workers, broadphase);
+        for (int step = 0; step < kSteps; ++step) {
+            if (hashes[step] != reference[step]) {
+                std::cout << "  " << workers << " workers diverge at step " << step << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The hash sees single bit changes, and padding inside the vectors does not reach it
+bool checkHash() {
+    PhysicsWorld a;
+    PhysicsWorld b;
+    buildPile(a, BroadphaseType::SweepAndPrune);
+    buildPile(b, BroadphaseType::SweepAndPrune);
+    if (a.getStateHash() != b.getStateHash())
+        return false;
+
+    Vec3& p = b.accessRigidbodyData().accessPositions()[400];
+    p.Y = std::nextafter(p.Y, 100.0f);
+    return a.getStateHash() != b.getStateHash();
+}
+
+// Inputs of every kind through the world, some of them on bodies added while recording
+std::vector<uint64_t> recordSession(PhysicsWorld& world) {
+    const Vec3 e(0.3f, 0.3f, 0.3f);
+    const Vec3 hull[4] = {Vec3(0.0f, 0.5f, 0.0f), Vec3(0.5f, -0.3f, 0.0f), Vec3(-0.5f, -0.3f, 0.3f), Vec3(0.0f, -0.3f, -0.5f)};
+    std::vector<RigidbodyHandle> spawned;
+    std::vector<uint64_t> hashes;
+    for (int step = 0; step < kSteps; ++step) {
+        if (step % 10 == 0) {
+            const real_t x = static_cast<real_t>(step) * 0.2f - 6.0f;
+            spawned.push_back(world.addRigidbody(Vec3(x, 8.0f, 0.0f), Vec3(0.0f, -2.0f, 0.0f), 1.0f, boxInertia(1.0f, e)));
+            if (step % 20 == 0)
+                world.setBoxShape(spawned.back(), e);
+            else
+                world.setConvexShape(spawned.back(), hull, 4);
+        }
+        if (step == 15) {
+            std::vector<RigidbodyDesc> bodies(8);
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                bodies[i].Position = Vec3(static_cast<real_t>(i) - 4.0f, 10.0f, 3.0f);
+                bodies[i].Inertia = boxInertia(1.0f, e);
+            }
+            std::vector<RigidbodyHandle> handles(bodies.size());
+            world.addRigidbodies(bodies, handles.data());
+            for (RigidbodyHandle body : handles)
+                world.setCapsuleShape(body, 0.2f, 0.3f);
+        }
+        if (step == 25)
+            world.setGravity(Vec3(0.5f, -9.81f, 0.0f));
+        if (step == 40)
+            world.removeRigidbody(spawned[1]);
+        world.addForce(spawned.front(), Vec3(0.0f, 5.0f, 1.0f));
+        world.addTorque(spawned.front(), Vec3(0.0f, 0.5f, 0.0f));
+        if (step % 7 == 3)
+            world.applyImpulse(spawned.back(), Vec3(0.5f, 0.0f, 0.0f), Vec3(0.0f, 0.2f, 0.0f));
+        world.update(kDt);
+        hashes.push_back(world.getStateHash());
+    }
+    return hashes;
+}
+
+// A replay on another worker count goes through the same states as the recorded session
+bool checkReplay() {
+    std::vector<uint64_t> recorded;
+    {
+        PhysicsWorld world;
+        buildPile(world, BroadphaseType::SweepAndPrune);
+        world.update(kDt); // before the recording, part of its initial state
+        InputRecorder recorder;
+        if (!recorder.start(world, kRecordingPath))
+            return false;
+        recorded = recordSession(world);
+        if (recorder.getStepCount() != kSteps || !recorder.stop())
+            return false;
+    }
+
+    InputReplay replay;
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = 3});
+    if (!replay.open(kRecordingPath) || !replay.start(world))
+        return false;
+    for (int step = 0; step < kSteps; ++step) {
+        if (!replay.step(world) || world.getStateHash() != recorded[step])
+            return false;
+    }
+    if (replay.step(world) || replay.hasFailed() || replay.getFirstMismatch() != InputReplay::kNoMismatch)
+        return false;
+
+    // From the start again, at full speed
+    PhysicsWorld again;
+    return replay.start(again) && replay.run(again) == kSteps && again.getStateHash() == recorded.back();
+}
+
+// A world that is not where the recording was shows up at the first step, and
+// a recording cut short replays up to the last whole record
+bool checkReplayMismatch() {
+    InputReplay replay;
+    PhysicsWorld world;
+    if (!replay.open(kRecordingPath) || !replay.start(world))
+        return false;
+    world.accessRigidbodyData().accessVelocities()[5].X += 1.0f;
+    if (replay.run(world) != kSteps || replay.getFirstMismatch() != 0)
+        return false;
+
+    std::vector<char> bytes;
+    {
+        std::ifstream in(kRecordingPath, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes.resize(bytes.size() - 100);
+    {
+        std::ofstream out(kRecordingPath, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    InputReplay cut;
+    PhysicsWorld partial;
+    if (!cut.open(kRecordingPath) || !cut.start(partial))
+        return false;
+    const uint32_t steps = cut.run(partial);
+    return steps > 0 && steps < kSteps && cut.getFirstMismatch() == InputReplay::kNoMismatch;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("state hash", checkHash());
+    report("sweep and prune", checkWorkerCounts(BroadphaseType::SweepAndPrune));
+    report("aabb tree", checkWorkerCounts(BroadphaseType::AabbTree));
+    report("hash grid", checkWorkerCounts(BroadphaseType::HashGrid));
+    report("replay", checkReplay());
+    report("replay mismatch", checkReplayMismatch());
+    std::remove(kRecordingPath);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "nyx/core/job_system.h"
+#include "nyx/core/trace.h"
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+// Runs every task inline on the caller, standing in for an engine's own scheduler
+class InlineScheduler : public TaskScheduler {
+public:
+    uint32_t getConcurrency() const override { return 4; }
+    void run(uint32_t count, TaskFunction task, void* context) override {
+        for (uint32_t i = 0; i < count; ++i)
+            task(context, i);
+        ++Runs;
+    }
+
+    uint32_t Runs = 0;
+};
+
+bool checkCoverage(JobSystem& jobs, size_t count, size_t granularity) {
+    std::vector<std::atomic<uint32_t>> hits(count);
+    std::atomic<bool> aligned{true};
+    jobs.parallelFor(count, granularity, [&](size_t begin, size_t end) {
+        if (begin % granularity != 0) aligned = false;
+        for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (hits[i].load() != 1) return false;
+    }
+    return aligned.load();
+}
+
+void fillWorld(PhysicsWorld& world, size_t count) {
+    Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    for (size_t i = 0; i < count; ++i) {
+        real_t f = static_cast<real_t>(i);
+        size_t id = world.getIndex(world.addRigidbody(Vec3(f, 0.0f, -f), Vec3(1.0f, 2.0f, 0.01f * f), 1.0f, inertia));
+        world.accessRigidbodyData().accessAngularVelocities()[id] = Vec3(0.001f * f, 1.0f, 0.0f);
+    }
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+}
+
+bool sameState(const PhysicsWorld& a, const PhysicsWorld& b) {
+    const auto& pa = a.getRigidbodyData().getPositions();
+    const auto& pb = b.getRigidbodyData().getPositions();
+    const auto& qa = a.getRigidbodyData().getOrientations();
+    const auto& qb = b.getRigidbodyData().getOrientations();
+    for (size_t i = 0; i < pa.size(); ++i) {
+        if (pa[i].X != pb[i].X || pa[i].Y != pb[i].Y || pa[i].Z != pb[i].Z) return false;
+        if (std::memcmp(&qa[i], &qb[i], sizeof(Quaternion)) != 0) return false;
+    }
+    return true;
+}
+
+// Zones from the caller and every worker end up in one Chrome trace
+bool checkTrace() {
+#if defined(NYX_PROFILE)
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = 3});
+    fillWorld(world, 20'000);
+
+    TraceRecorder recorder;
+    world.update(0.016f); // not recorded
+    recorder.start();
+    for (int step = 0; step < 5; ++step)
+        world.update(0.016f);
+    recorder.stop();
+    world.update(0.016f);
+
+    std::ostringstream out;
+    recorder.write(out);
+    const std::string json = out.str();
+    if (json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) != 0 || json.find("\n]}") == std::string::npos)
+        return false;
+    for (const char* name : {"\"PhysicsWorld::update\"", "\"Solve\"", "\"Integrate velocities\"", "\"Job\"", "\"Worker 1\""}) {
+        if (json.find(name) == std::string::npos)
+            return false;
+    }
+
+    size_t updates = 0;
+    for (size_t at = json.find("\"PhysicsWorld::update\""); at != std::string::npos; at = json.find("\"PhysicsWorld::update\"", at + 1))
+        ++updates;
+    if (updates != 5 || recorder.getDroppedCount() != 0)
+        return false;
+
+    // A full buffer drops zones instead of growing
+    TraceRecorder small(4);
+    small.start();
+    world.update(0.016f);
+    small.stop();
+    return small.getEventCount() <= 4u * 4u && small.getDroppedCount() > 0;
+#else
+    return true;
+#endif
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    JobSystem inlineJobs;
+    report("inline coverage", checkCoverage(inlineJobs, 1000, kBodiesPerCacheLine));
+
+    JobSystem jobs(JobSystemSettings{.WorkerCount = 3});
+    report("worker count", jobs.getThreadCount() == 4);
+    report("worker coverage", checkCoverage(jobs, 100'003, kBodiesPerCacheLine));
+    report("small range", checkCoverage(jobs, 5, kBodiesPerCacheLine));
+
+    std::atomic<size_t> nested{0};
+    jobs.parallelFor(64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            jobs.parallelFor(100, 1, [&](size_t b, size_t e) { nested.fetch_add(e - b); });
+        }
+    });
+    report("nested parallelFor", nested.load() == 6400);
+
+    InlineScheduler scheduler;
+    JobSystem external(JobSystemSettings{.Scheduler = &scheduler});
+    report("external scheduler", checkCoverage(external, 10'000, kBodiesPerCacheLine) && scheduler.Runs == 1);
+
+    report("trace", checkTrace());
+
+    // Body updates are independent, so the thread count must not change the result
+    PhysicsWorld serial;
+    PhysicsWorld threaded(JobSystemSettings{.WorkerCount = 3});
+    fillWorld(serial, 20'000);
+    fillWorld(threaded, 20'000);
+    for (int step = 0; step < 30; ++step) {
+        serial.update(0.016f);
+        threaded.update(0.016f);
+    }
+    report("threaded step", sameState(serial, threaded));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "nyx/core/arena.h"
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+// Every global new while counting is on, to prove a step touches no heap
+std::atomic<bool> gCountNew{false};
+std::atomic<uint64_t> gNewCount{0};
+
+void* operator new(size_t size) {
+    if (gCountNew.load(std::memory_order_relaxed))
+        gNewCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    std::abort();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (gCountNew.load(std::memory_order_relaxed))
+        gNewCount.fetch_add(1, std::memory_order_relaxed);
+    const size_t a = static_cast<size_t>(alignment);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a))
+        return p;
+    std::abort();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+// Forwards to new_delete_resource() and counts what passes through
+class CountingResource : public std::pmr::memory_resource {
+public:
+    uint64_t Allocations = 0;
+    uint64_t Live = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++Allocations;
+        ++Live;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        --Live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+bool isAligned(const void* p, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+bool checkArenaAlignment() {
+    LinearArena arena(256);
+    for (size_t alignment : {1u, 4u, 16u, 64u, 128u}) {
+        (void)arena.allocate(3, 1);
+        if (!isAligned(arena.allocate(40, alignment), alignment))
+            return false;
+    }
+    // Larger than a block gets a block of its own
+    return isAligned(arena.allocate(1000, 64), 64) && arena.getCapacity() >= 1000;
+}
+
+// A frame spilling over several blocks leaves a single block behind that holds
+// all of it, after which the same frame takes nothing from upstream
+bool checkArenaReset() {
+    CountingResource upstream;
+    LinearArena arena(1024, &upstream);
+    auto frame = [&] {
+        for (int i = 0; i < 50; ++i)
+            arena.allocateArray<Vec3>(17);
+        arena.reset();
+    };
+
+    frame();
+    if (arena.getBlockCount() != 1 || arena.getCapacity() < arena.getPeak())
+        return false;
+    const uint64_t allocations = upstream.Allocations;
+    for (int i = 0; i < 10; ++i)
+        frame();
+    const bool steady = upstream.Allocations == allocations && arena.getUsed() == 0;
+
+    arena.release();
+    return steady && upstream.Live == 0;
+}
+
+bool checkScratchScopes() {
+    LinearArena& arena = getScratchArena();
+    const size_t used = arena.getUsed();
+    {
+        ScratchScope outer;
+        uint32_t* a = outer.accessArena().allocateArray<uint32_t>(100);
+        {
+            ScratchScope inner;
+            inner.accessArena().allocateArray<uint32_t>(100'000); // spills into a new block
+        }
+        // The inner scope's memory comes back, the outer one's stays
+        uint32_t* b = outer.accessArena().allocateArray<uint32_t>(100);
+        if (b != a + 100)
+            return false;
+    }
+    return arena.getUsed() == used;
+}
+
+// Bodies resting on the ground after a fall, so contacts and pairs stay put
+void fillWorld(PhysicsWorld& world) {
+    world.setBroadphase(BroadphaseType::SweepAndPrune);
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+
+    const Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, inertia);
+    world.setBoxShape(ground, Vec3(50.0f, 0.5f, 50.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+
+    for (int x = 0; x < 20; ++x) {
+        for (int z = 0; z < 20; ++z) {
+            const RigidbodyHandle body = world.addRigidbody(Vec3(x * 2.0f - 20.0f, 1.5f, z * 2.0f - 20.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, inertia);
+            if ((x + z) % 2)
+                world.setSphereShape(body, 0.5f);
+            else
+                world.setBoxShape(body, Vec3(0.5f, 0.5f, 0.5f));
+        }
+    }
+}
+
+// Once warmed up, a step reuses the buffers of the last one
+bool checkSteadyState(const JobSystemSettings& jobSettings, const SleepSettings& sleep) {
+    PhysicsWorld world(jobSettings);
+    world.setSleepSettings(sleep);
+    fillWorld(world);
+    auto step = [&] { world.update(1.0f / 60.0f); };
+    for (int i = 0; i < 240; ++i)
+        step();
+
+    gNewCount = 0;
+    gCountNew = true;
+    for (int i = 0; i < 60; ++i)
+        step();
+    gCountNew = false;
+    // The narrowphase sorts its pairs in the frame arena, which is empty again after the step
+    return gNewCount.load() == 0 && world.accessFrameArena().getPeak() > 0 && world.accessFrameArena().getUsed() == 0;
+}
+
+// The per-body arrays take their memory from the persistent resource
+bool checkPersistentResource() {
+    CountingResource resource;
+    setPersistentResource(&resource);
+    bool ok;
+    {
+        PhysicsWorld world;
+        fillWorld(world);
+        const uint64_t reserved = resource.Allocations;
+        world.update(1.0f / 60.0f);
+
+        const RigidbodyData& data = world.getRigidbodyData();
+        ok = reserved > 0 && resource.Allocations > reserved
+            && data.getPositions().get_allocator().Resource == &resource
+            && data.getAwakeBodies().get_allocator().Resource == &resource
+            && isAligned(data.getPositions().data(), kCacheLineSize);
+    }
+    setPersistentResource(nullptr);
+    return ok && resource.Live == 0 && getPersistentResource() == std::pmr::new_delete_resource();
+}
+
+// Large blocks come back on a huge page boundary whatever alignment was asked
+// for, and every block, large or small, goes back the way it came
+bool checkHugePageResource() {
+    std::pmr::memory_resource* resource = getHugePageResource();
+    constexpr size_t kHuge = 2 * 1024 * 1024;
+    bool ok = true;
+    for (size_t alignment : {size_t(64), size_t(4096), kHuge}) {
+        for (size_t bytes : {size_t(1000), kHuge, kHuge * 3 + 100}) {
+            void* p = resource->allocate(bytes, alignment);
+            ok = ok && isAligned(p, bytes >= kHuge ? kHuge : alignment);
+            static_cast<char*>(p)[0] = 1;
+            static_cast<char*>(p)[bytes - 1] = 1;
+            resource->deallocate(p, bytes, alignment);
+        }
+    }
+    return ok;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("arena alignment", checkArenaAlignment());
+    report("arena reset", checkArenaReset());
+    report("scratch scopes", checkScratchScopes());
+
+    SleepSettings noSleep;
+    noSleep.Enabled = false;
+    report("steady state inline", checkSteadyState(JobSystemSettings{.WorkerCount = 0}, noSleep));
+    report("steady state threaded", checkSteadyState(JobSystemSettings{.WorkerCount = 3}, noSleep));
+    report("steady state sleeping", checkSteadyState(JobSystemSettings{.WorkerCount = 0}, SleepSettings{}));
+    report("persistent resource", checkPersistentResource());
+    report("huge page resource", checkHugePageResource());
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nyx/physics/collision/gjk.h"
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+Quaternion randomOrientation(std::mt19937& rng) {
+    std::normal_distribution<float> n(0.0f, 1.0f);
+    Quaternion q(n(rng), n(rng), n(rng), n(rng));
+    q.normalize();
+    return q;
+}
+
+Vec3 randomPoint(std::mt19937& rng, float extent) {
+    std::uniform_real_distribution<float> d(-extent, extent);
+    return Vec3(d(rng), d(rng), d(rng));
+}
+
+ShapeInstance instance(const ShapeStore& shapes, size_t body, const Vec3& position, const Quaternion& orientation) {
+    return ShapeInstance{shapes.getShape(body), ShapeTransform(position, orientation)};
+}
+
+bool gjkCollide(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, Contact& contact) {
+    return collideConvex(GjkProxy(shapes, a.Shape, a.Xf), GjkProxy(shapes, b.Shape, b.Xf), contact);
+}
+
+// The closed form routine and GJK/EPA must agree away from the touching boundary
+bool agrees(const ShapeStore& shapes, const ShapeInstance& a, const ShapeInstance& b, bool checkNormal) {
+    Contact contacts[kMaxContactsPerPair], gjk;
+    const bool hitClosed = Narrowphase::collide(shapes, a, b, contacts) > 0;
+    const Contact& closed = contacts[0];
+    const bool hitGjk = gjkCollide(shapes, a, b, gjk);
+    if (hitClosed != hitGjk)
+        return (hitClosed ? closed.Depth : gjk.Depth) < 1e-3f;
+    if (!hitClosed)
+        return true;
+    if (std::abs(closed.Depth - gjk.Depth) > 2e-3f)
+        return false;
+    return !checkNormal || closed.Depth < 1e-3f || dot(closed.Normal, gjk.Normal) > 0.99f;
+}
+
+bool checkSphereBox() {
+    ShapeStore shapes;
+    shapes.setSphere(0, 0.5f);
+    shapes.setBox(1, Vec3(1.0f, 0.5f, 0.75f));
+
+    std::mt19937 rng(3);
+    for (int i = 0; i < 2000; ++i) {
+        const ShapeInstance sphere = instance(shapes, 0, randomPoint(rng, 2.0f), Quaternion());
+        const ShapeInstance box = instance(shapes, 1, randomPoint(rng, 0.5f), randomOrientation(rng));
+
+        // Inside the box the nearest face can tie, so only the depth is compared there
+        const Vec3 local = box.Xf.toLocal(sphere.Xf.Position);
+        const bool outside = std::abs(local.X) > 1.0f || std::abs(local.Y) > 0.5f || std::abs(local.Z) > 0.75f;
+        if (!agrees(shapes, sphere, box, outside) || !agrees(shapes, box, sphere, outside))
+            return false;
+    }
+    return true;
+}
+
+bool checkCapsules() {
+    ShapeStore shapes;
+    shapes.setSphere(0, 0.4f);
+    shapes.setCapsule(1, 0.8f, 0.3f);
+    shapes.setCapsule(2, 0.5f, 0.45f);
+
+    std::mt19937 rng(5);
+    for (int i = 0; i < 2000; ++i) {
+        const ShapeInstance sphere = instance(shapes, 0, randomPoint(rng, 1.5f), Quaternion());
+        const ShapeInstance a = instance(shapes, 1, randomPoint(rng, 1.0f), randomOrientation(rng));
+        const ShapeInstance b = instance(shapes, 2, randomPoint(rng, 1.0f), randomOrientation(rng));
+        if (!agrees(shapes, sphere, a, true) || !agrees(shapes, a, b, false))
+            return false;
+    }
+    return true;
+}
+
+// A hull through the corners of a box is the box
+bool checkHullMatchesBox() {
+    const Vec3 e(0.6f, 0.3f, 0.9f);
+    std::vector<Vec3> corners;
+    for (int i = 0; i < 8; ++i)
+        corners.emplace_back(i & 1 ? e.X : -e.X, i & 2 ? e.Y : -e.Y, i & 4 ? e.Z : -e.Z);
+
+    ShapeStore shapes;
+    shapes.setSphere(0, 0.35f);
+    shapes.setBox(1, e);
+    shapes.setConvex(2, corners.data(), corners.size());
+
+    std::mt19937 rng(9);
+    for (int i = 0; i < 2000; ++i) {
+        const Vec3 spherePosition = randomPoint(rng, 1.5f);
+        const Vec3 position = randomPoint(rng, 0.3f);
+        const Quaternion orientation = randomOrientation(rng);
+
+        const ShapeInstance sphere = instance(shapes, 0, spherePosition, Quaternion());
+        Contact fromBox[kMaxContactsPerPair], fromHull[kMaxContactsPerPair];
+        const bool hitBox = Narrowphase::collide(shapes, sphere, instance(shapes, 1, position, orientation), fromBox) > 0;
+        const bool hitHull = Narrowphase::collide(shapes, sphere, instance(shapes, 2, position, orientation), fromHull) > 0;
+        if (hitBox != hitHull) {
+            if ((hitBox ? fromBox[0].Depth : fromHull[0].Depth) > 1e-3f)
+                return false;
+        } else if (hitBox && std::abs(fromBox[0].Depth - fromHull[0].Depth) > 2e-3f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkBoxStack() {
+    ShapeStore shapes;
+    shapes.setBox(0, Vec3(1.0f, 0.5f, 1.0f));
+    shapes.setBox(1, Vec3(0.5f, 0.5f, 0.5f));
+
+    // The upper box sinks 0.1 into the lower one and rests on all four corners
+    Contact contacts[kMaxContactsPerPair];
+    const ShapeInstance lower = instance(shapes, 0, Vec3(0.0f, 0.0f, 0.0f), Quaternion());
+    const ShapeInstance upper = instance(shapes, 1, Vec3(0.2f, 0.9f, -0.1f), Quaternion());
+    if (Narrowphase::collide(shapes, lower, upper, contacts) != 4)
+        return false;
+    for (const Contact& contact : contacts) {
+        if (std::abs(contact.Depth - 0.1f) > 1e-3f || contact.Normal.Y < 0.999f)
+            return false;
+        if (std::abs(contact.PointA.Y - 0.5f) > 1e-3f || std::abs(contact.PointB.Y - 0.4f) > 1e-3f)
+            return false;
+    }
+
+    // Swapping the pair flips the normal
+    Contact swapped[kMaxContactsPerPair];
+    if (Narrowphase::collide(shapes, upper, lower, swapped) != 4)
+        return false;
+    for (const Contact& contact : swapped) {
+        if (std::abs(contact.Depth - 0.1f) > 1e-3f || contact.Normal.Y > -0.999f || std::abs(contact.PointA.Y - 0.4f) > 1e-3f)
+            return false;
+    }
+
+    // Turned a quarter about Y over the edge of the lower box, the clipped polygon stays on its top face
+    const ShapeInstance turned = instance(shapes, 1, Vec3(0.9f, 0.9f, 0.0f), Quaternion(0.9238795f, 0.0f, 0.3826834f, 0.0f));
+    const uint32_t count = Narrowphase::collide(shapes, lower, turned, contacts);
+    if (count < 3)
+        return false;
+    for (uint32_t c = 0; c < count; ++c) {
+        if (contacts[c].PointA.X > 1.0f + 1e-4f || std::abs(contacts[c].Depth - 0.1f) > 1e-3f)
+            return false;
+    }
+    return true;
+}
+
+bool checkWorldContacts(const JobSystemSettings& jobSettings) {
+    PhysicsWorld world(jobSettings);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> size(0.2f, 0.6f);
+
+    Mat3 inertia(0.4f, 0.0f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f, 0.0f, 0.4f);
+    for (size_t i = 0; i < 1500; ++i) {
+        const RigidbodyHandle id = world.addRigidbody(randomPoint(rng, 8.0f), randomPoint(rng, 1.0f), 1.0f, inertia);
+        world.accessRigidbodyData().accessOrientations()[world.getIndex(id)] = randomOrientation(rng);
+        switch (i % 4) {
+        case 0: world.setSphereShape(id, size(rng)); break;
+        case 1: world.setBoxShape(id, Vec3(size(rng), size(rng), size(rng))); break;
+        case 2: world.setCapsuleShape(id, size(rng), size(rng) * 0.5f); break;
+        default: break; // no shape, never in a contact
+        }
+    }
+
+    for (int step = 0; step < 5; ++step) {
+        world.update(0.016f);
+
+        const RigidbodyData& data = world.getRigidbodyData();
+        const ShapeStore& shapes = world.getShapes();
+        std::vector<Contact> expected;
+        for (uint32_t a = 0; a < data.getPositions().size(); ++a) {
+            for (uint32_t b = a + 1; b < data.getPositions().size(); ++b) {
+                Contact contacts[kMaxContactsPerPair];
+                const uint32_t count = Narrowphase::collide(shapes, instance(shapes, a, data.getPositions()[a], data.getOrientations()[a]),
+                                                            instance(shapes, b, data.getPositions()[b], data.getOrientations()[b]), contacts);
+                for (uint32_t c = 0; c < count; ++c) {
+                    contacts[c].A = a;
+                    contacts[c].B = b;
+                    expected.push_back(contacts[c]);
+                }
+            }
+        }
+
+        std::vector<Contact> contacts = world.getContacts();
+        auto byPair = [](const Contact& x, const Contact& y) { return x.A < y.A || (x.A == y.A && x.B < y.B); };
+        // Stable, so the points of each pair keep their order
+        std::stable_sort(contacts.begin(), contacts.end(), byPair);
+        if (expected.empty() || contacts.size() != expected.size())
+            return false;
+        for (size_t c = 0; c < contacts.size(); ++c) {
+            if (contacts[c].A != expected[c].A || contacts[c].B != expected[c].B || contacts[c].Depth != expected[c].Depth)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("sphere box matches gjk", checkSphereBox());
+    report("capsules match gjk", checkCapsules());
+    report("hull matches box", checkHullMatchesBox());
+    report("box stack", checkBoxStack());
+    report("world contacts", checkWorldContacts({}));
+    report("world contacts threaded", checkWorldContacts(JobSystemSettings{.WorkerCount = 3}));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "nyx/physics/scene/parallel_worlds.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+constexpr uint32_t kWorlds = 200;
+
+Mat3 boxInertia(real_t mass, const Vec3& e) {
+    const real_t k = mass / 3.0f;
+    return Mat3(k * (e.Y * e.Y + e.Z * e.Z), 0.0f, 0.0f,
+                0.0f, k * (e.X * e.X + e.Z * e.Z), 0.0f,
+                0.0f, 0.0f, k * (e.X * e.X + e.Y * e.Y));
+}
+
+// A small stack on the ground, differing per seed in how many boxes and where
+void buildScene(PhysicsWorld& world, uint32_t seed) {
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, Vec3(10.0f, 0.5f, 10.0f)));
+    world.setBoxShape(ground, Vec3(10.0f, 0.5f, 10.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+    const Vec3 e(0.5f, 0.5f, 0.5f);
+    const uint32_t boxes = 5 + seed % 20;
+    for (uint32_t i = 0; i < boxes; ++i) {
+        const real_t x = static_cast<real_t>(i % 4) * 1.05f + 0.01f * static_cast<real_t>(seed % 7);
+        const RigidbodyHandle body = world.addRigidbody(Vec3(x, 0.6f + static_cast<real_t>(i / 4) * 1.1f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e));
+        if (i % 2)
+            world.setBoxShape(body, e);
+        else
+            world.setSphereShape(body, 0.5f);
+    }
+}
+
+// Stepping the worlds in parallel gives every world exactly what stepping it
+// alone does, and no world reserves room for more bodies than asked
+bool checkStep() {
+    ParallelWorlds worlds(JobSystemSettings{.WorkerCount = 3});
+    std::vector<uint64_t> expected;
+    for (uint32_t w = 0; w < kWorlds; ++w) {
+        buildScene(worlds.accessWorld(worlds.addWorld(32)), w);
+
+        PhysicsWorld alone;
+        buildScene(alone, w);
+        for (int step = 0; step < 30; ++step)
+            alone.update(kDt);
+        expected.push_back(alone.getStateHash());
+    }
+    for (int step = 0; step < 30; ++step)
+        worlds.update(kDt);
+
+    for (uint32_t w = 0; w < kWorlds; ++w) {
+        if (worlds.getWorld(w).getStateHash() != expected[w] || worlds.getWorld(w).getRigidbodyData().getPositions().capacity() > 32)
+            return false;
+    }
+    return worlds.size() == kWorlds;
+}
+
+// Resetting goes back to the baseline bit for bit, and the rollout after it repeats
+bool checkReset() {
+    ParallelWorlds worlds(JobSystemSettings{.WorkerCount = 2});
+    for (uint32_t w = 0; w < 16; ++w) {
+        const uint32_t index = worlds.addWorld();
+        buildScene(worlds.accessWorld(index), w);
+        worlds.saveBaseline(index);
+    }
+    const uint32_t plain = worlds.addWorld();
+    if (worlds.reset(plain) || worlds.hasBaseline(plain) || !worlds.hasBaseline(0))
+        return false;
+
+    std::vector<uint64_t> start;
+    for (uint32_t w = 0; w < 16; ++w)
+        start.push_back(worlds.getWorld(w).getStateHash());
+    worlds.stepN(20);
+    std::vector<uint64_t> rollout;
+    for (uint32_t w = 0; w < 16; ++w)
+        rollout.push_back(worlds.getWorld(w).getStateHash());
+
+    worlds.resetAll();
+    for (uint32_t w = 0; w < 16; ++w) {
+        if (worlds.getWorld(w).getStateHash() != start[w])
+            return false;
+    }
+    worlds.stepN(20);
+    for (uint32_t w = 0; w < 16; ++w) {
+        if (worlds.getWorld(w).getStateHash() != rollout[w])
+            return false;
+    }
+    return worlds.reset(3) && worlds.getWorld(3).getStateHash() == start[3];
+}
+
+// A clone branches off mid rollout and carries on exactly like its source
+bool checkClone() {
+    ParallelWorlds worlds;
+    const uint32_t src = worlds.addWorld();
+    buildScene(worlds.accessWorld(src), 11);
+    worlds.accessWorld(src).setFixedStepSettings(FixedStepSettings{.Dt = kDt, .Substeps = 2});
+    worlds.saveBaseline(src);
+    worlds.stepN(10);
+
+    const uint32_t copy = worlds.addClone(src);
+    const uint32_t other = worlds.addWorld();
+    buildScene(worlds.accessWorld(other), 3);
+    worlds.clone(src, other);
+    if (worlds.getWorld(copy).getStateHash() != worlds.getWorld(src).getStateHash() ||
+        worlds.getWorld(other).getStateHash() != worlds.getWorld(src).getStateHash())
+        return false;
+
+    worlds.stepN(15);
+    if (worlds.getWorld(copy).getStateHash() != worlds.getWorld(src).getStateHash() ||
+        worlds.getWorld(other).getStateHash() != worlds.getWorld(src).getStateHash())
+        return false;
+
+    // The baseline came along
+    worlds.reset(src);
+    return worlds.reset(copy) && worlds.getWorld(copy).getStateHash() == worlds.getWorld(src).getStateHash();
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("step", checkStep());
+    report("reset", checkReset());
+    report("clone", checkClone());
+
+    return failures == 0 ? 0 : 1;
+}
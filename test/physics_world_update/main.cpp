@@ -20,7 +20,7 @@ int main() {
                       0.0f, 0.0f, i);
 
     // Add rigidbody
-    size_t id = system.addRigidbody(initialPos, initialVel, mass, inertia);
+    size_t id = system.getData().getIndex(system.addRigidbody(initialPos, initialVel, mass, inertia));
 
     // Simulation parameters
     real_t dt = 0.016f; // ~60 FPS
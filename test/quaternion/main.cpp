@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nyx/core/cpu_features.h"
+#include "nyx/math/quaternion.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+// Not a multiple of 8 or 4, so every kernel finishes a tail one at a time
+constexpr size_t kCount = 1027;
+
+// Without NYX_DETERMINISTIC the compiler may fuse the scalar operators'
+// multiply-adds and not the kernels', so they only agree to rounding
+#if defined(NYX_DETERMINISTIC)
+constexpr real_t kTolerance = 0.0f;
+#else
+constexpr real_t kTolerance = 1e-5f;
+#endif
+
+std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels;
+    for (uint8_t i = 0; i <= static_cast<uint8_t>(getSupportedSimdLevel()); ++i)
+        levels.push_back(static_cast<SimdLevel>(i));
+    return levels;
+}
+
+struct Inputs {
+    Inputs() {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (size_t i = 0; i < kCount; ++i) {
+            Orientations.emplace_back(unit(rng), unit(rng), unit(rng), unit(rng));
+            Orientations.back().normalize();
+            Vectors.emplace_back(unit(rng) * 5.0f, unit(rng) * 5.0f, unit(rng) * 5.0f);
+            AngularVelocities.emplace_back(unit(rng) * 10.0f, unit(rng) * 10.0f, unit(rng) * 10.0f);
+        }
+        // A body at rest and a zero quaternion, which normalize() leaves alone
+        AngularVelocities[5] = Vec3(0.0f, 0.0f, 0.0f);
+        Orientations[9] = Quaternion(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    std::vector<Quaternion> Orientations;
+    std::vector<Vec3> Vectors;
+    std::vector<Vec3> AngularVelocities;
+};
+
+bool near(const Quaternion& a, const Quaternion& b) {
+    return std::fabs(a.w - b.w) <= kTolerance && std::fabs(a.x - b.x) <= kTolerance && std::fabs(a.y - b.y) <= kTolerance &&
+           std::fabs(a.z - b.z) <= kTolerance;
+}
+
+bool near(const Vec3& a, const Vec3& b, real_t tolerance) {
+    return std::fabs(a.X - b.X) <= tolerance && std::fabs(a.Y - b.Y) <= tolerance && std::fabs(a.Z - b.Z) <= tolerance;
+}
+
+// How RigidbodySystem::integrate stepped an orientation before integrateMany
+Quaternion integrateReference(Quaternion q, const Vec3& w, real_t dt) {
+    Quaternion omega(0.0f, w.X, w.Y, w.Z);
+    q += 0.5f * omega * q * dt;
+    q.normalize();
+    return q;
+}
+
+// The two cross product rotation agrees with q * (0, v) * q⁻¹
+bool checkRotate() {
+    const Inputs in;
+    for (size_t i = 0; i < kCount; ++i) {
+        const Quaternion& q = in.Orientations[i];
+        // Only unit quaternions rotate; the zero one is there for normalize()
+        if (q.w == 0.0f && q.x == 0.0f && q.y == 0.0f && q.z == 0.0f)
+            continue;
+        const Quaternion full = q * Quaternion(0.0f, in.Vectors[i]) * q.conjugate();
+        if (!near(q * in.Vectors[i], Vec3(full.x, full.y, full.z), 1e-5f))
+            return false;
+    }
+    return true;
+}
+
+// Every level's kernels give each element what the scalar operators do
+bool checkKernels() {
+    const SimdLevel initial = getSimdLevel();
+    const Inputs in;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < kCount; i += 3)
+        indices.push_back(i);
+
+    bool ok = true;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+
+        std::vector<Vec3> rotated(kCount);
+        rotateMany(in.Orientations.data(), in.Vectors.data(), rotated.data(), kCount);
+        std::vector<Vec3> inPlace = in.Vectors;
+        rotateMany(in.Orientations.data(), inPlace.data(), inPlace.data(), kCount);
+
+        std::vector<Quaternion> integrated = in.Orientations;
+        integrateMany(integrated.data(), in.AngularVelocities.data(), kDt, kCount);
+        std::vector<Quaternion> awake = in.Orientations;
+        integrateMany(awake.data(), in.AngularVelocities.data(), kDt, indices.data(), indices.size());
+
+        std::vector<Quaternion> normalized;
+        for (const Quaternion& q : in.Orientations)
+            normalized.push_back(q * 3.0f);
+        normalizeMany(normalized.data(), kCount);
+
+        for (size_t i = 0; i < kCount; ++i) {
+            const Vec3 r = in.Orientations[i] * in.Vectors[i];
+            const Quaternion step = integrateReference(in.Orientations[i], in.AngularVelocities[i], kDt);
+            Quaternion unit = in.Orientations[i] * 3.0f;
+            unit.normalize();
+            // Bodies left out of the index list are not touched
+            const Quaternion& expectedAwake = i % 3 == 0 ? step : in.Orientations[i];
+            ok = ok && near(rotated[i], r, kTolerance) && near(inPlace[i], r, kTolerance) && near(integrated[i], step) &&
+                 near(awake[i], expectedAwake) && near(normalized[i], unit);
+        }
+        std::cout << "  " << getSimdLevelName(level) << (ok ? " ok" : " differs") << "\n";
+    }
+    setSimdLevel(initial);
+    return ok;
+}
+
+// Spinning at a constant rate stays on unit length and turns by about ω * t
+bool checkSpin() {
+    std::vector<Quaternion> q(kCount);
+    const std::vector<Vec3> w(kCount, Vec3(0.0f, 1.0f, 0.0f));
+    for (int step = 0; step < 60; ++step)
+        integrateMany(q.data(), w.data(), kDt, kCount);
+
+    const real_t angle = 2.0f * std::atan2(q.back().y, q.back().w);
+    return std::all_of(q.begin(), q.end(), [](const Quaternion& r) { return std::fabs(r.w * r.w + r.x * r.x + r.y * r.y + r.z * r.z - 1.0f) < 1e-5f; }) &&
+           std::fabs(angle - 1.0f) < 1e-3f;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("rotate", checkRotate());
+    report("kernels", checkKernels());
+    report("spin", checkSpin());
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+#include "nyx/physics/scene/snapshot.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+constexpr const char* kSnapshotPath = "/tmp/nyx_snapshot_test.bin";
+
+Mat3 boxInertia(real_t mass, const Vec3& e) {
+    const real_t k = mass / 3.0f;
+    return Mat3(k * (e.Y * e.Y + e.Z * e.Z), 0.0f, 0.0f,
+                0.0f, k * (e.X * e.X + e.Z * e.Z), 0.0f,
+                0.0f, 0.0f, k * (e.X * e.X + e.Y * e.Y));
+}
+
+// A sleeping stack, a falling pile of mixed shapes and a removed body, so
+// islands, manifolds, shape slots and handle generations all hold something
+std::vector<RigidbodyHandle> buildScene(PhysicsWorld& world) {
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    world.setBroadphase(BroadphaseType::AabbTree);
+    const RigidbodyHandle ground = world.addRigidbody(Vec3(0.0f, -0.5f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, Vec3(20.0f, 0.5f, 20.0f)));
+    world.setBoxShape(ground, Vec3(20.0f, 0.5f, 20.0f));
+    world.accessRigidbodyData().accessActive()[world.getIndex(ground)] = 0;
+
+    const Vec3 e(0.5f, 0.5f, 0.5f);
+    std::vector<RigidbodyHandle> bodies;
+    for (int i = 0; i < 3; ++i) {
+        bodies.push_back(world.addRigidbody(Vec3(-6.0f, 0.5f + i * 1.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e)));
+        world.setBoxShape(bodies.back(), e);
+    }
+    for (int i = 0; i < 24; ++i) {
+        const real_t x = static_cast<real_t>(i % 4) * 1.1f;
+        const real_t z = static_cast<real_t>((i / 4) % 2) * 1.1f;
+        const RigidbodyHandle body = world.addRigidbody(Vec3(x, 1.0f + i / 8 * 1.2f, z), Vec3(0.0f, 0.0f, 0.0f), 1.0f, boxInertia(1.0f, e));
+        if (i % 3 == 0)
+            world.setSphereShape(body, 0.5f);
+        else if (i % 3 == 1)
+            world.setCapsuleShape(body, 0.25f, 0.25f);
+        else
+            world.setBoxShape(body, e);
+        bodies.push_back(body);
+    }
+
+    for (int step = 0; step < 150; ++step)
+        world.update(kDt);
+    world.removeRigidbody(bodies[5]);
+    for (int step = 0; step < 5; ++step)
+        world.update(kDt);
+    return bodies;
+}
+
+bool sameBodies(const PhysicsWorld& a, const PhysicsWorld& b) {
+    const RigidbodyData& da = a.getRigidbodyData();
+    const RigidbodyData& db = b.getRigidbodyData();
+    if (da.size() != db.size())
+        return false;
+    for (size_t i = 0; i < da.size(); ++i) {
+        if (std::memcmp(&da.getPositions()[i], &db.getPositions()[i], sizeof(Vec3)) != 0 ||
+            std::memcmp(&da.getVelocities()[i], &db.getVelocities()[i], sizeof(Vec3)) != 0 ||
+            std::memcmp(&da.getOrientations()[i], &db.getOrientations()[i], sizeof(Quaternion)) != 0 ||
+            da.getHandle(i) != db.getHandle(i) || da.isAwake(i) != db.isAwake(i))
+            return false;
+    }
+    return true;
+}
+
+// A restored world holds the same bodies, shapes, handles and settings, and
+// carries on exactly like the original once both rebuilt their derived state
+bool checkRoundTrip(bool throughFile) {
+    PhysicsWorld world;
+    const std::vector<RigidbodyHandle> bodies = buildScene(world);
+
+    std::vector<std::byte> buffer(world.getSnapshotSize());
+    if (throughFile) {
+        if (!world.saveSnapshot(kSnapshotPath))
+            return false;
+    } else if (world.saveSnapshot(buffer.data(), buffer.size()) != buffer.size()) {
+        return false;
+    }
+
+    PhysicsWorld restored;
+    restored.addRigidbody(Vec3(1.0f, 2.0f, 3.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3()); // replaced by the load
+    const bool loaded = throughFile ? restored.loadSnapshot(kSnapshotPath) : restored.loadSnapshot(buffer.data(), buffer.size());
+    if (!loaded || !sameBodies(world, restored))
+        return false;
+
+    if (restored.getBroadphaseType() != BroadphaseType::AabbTree || restored.getManifolds().getManifolds().size() != world.getManifolds().getManifolds().size() ||
+        restored.getContactSolverSettings().Iterations != world.getContactSolverSettings().Iterations)
+        return false;
+    for (size_t i = 0; i < world.getRigidbodyData().size(); ++i) {
+        if (restored.getShapes().getShape(i).Type != world.getShapes().getShape(i).Type || restored.getShapes().getShape(i).Index != world.getShapes().getShape(i).Index)
+            return false;
+    }
+    if (restored.isValid(bodies[5]) || !restored.isValid(bodies[6]) || restored.getIndex(bodies[6]) != world.getIndex(bodies[6]))
+        return false;
+    if (restored.isAwake(bodies[0]) || restored.getShapes().getShape(restored.getIndex(bodies[7])).Type != ShapeType::Capsule)
+        return false;
+
+    // The original drops its broadphase and contacts too, then both must step in lockstep
+    const bool reloaded = throughFile ? world.loadSnapshot(kSnapshotPath) : world.loadSnapshot(buffer.data(), buffer.size());
+    if (!reloaded)
+        return false;
+    world.addForce(bodies[10], Vec3(400.0f, 0.0f, 0.0f));
+    restored.addForce(bodies[10], Vec3(400.0f, 0.0f, 0.0f));
+    for (int step = 0; step < 60; ++step) {
+        world.update(kDt);
+        restored.update(kDt);
+    }
+    if (!sameBodies(world, restored) || !world.isAwake(bodies[10]))
+        return false;
+
+    // New bodies take the same handle slots in both
+    const RigidbodyHandle a = world.addRigidbody(Vec3(0.0f, 5.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    const RigidbodyHandle b = restored.addRigidbody(Vec3(0.0f, 5.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    return a == b && a.Slot == bodies[5].Slot;
+}
+
+// Settings come back field by field, the flags included
+bool checkSettings() {
+    PhysicsWorld world;
+    ContactSolverSettings solver;
+    solver.Iterations = 3;
+    solver.Friction = 0.3f;
+    solver.WarmStarting = false;
+    world.setContactSolverSettings(solver);
+    SleepSettings sleep;
+    sleep.Enabled = false;
+    sleep.TimeToSleep = 2.0f;
+    world.setSleepSettings(sleep);
+
+    std::vector<std::byte> buffer(world.getSnapshotSize());
+    world.saveSnapshot(buffer.data(), buffer.size());
+    PhysicsWorld restored;
+    if (!restored.loadSnapshot(buffer.data(), buffer.size()))
+        return false;
+    const ContactSolverSettings& loadedSolver = restored.getContactSolverSettings();
+    const SleepSettings& loadedSleep = restored.getSleepSettings();
+    return loadedSolver.Iterations == 3 && loadedSolver.Friction == 0.3f && !loadedSolver.WarmStarting &&
+           !loadedSleep.Enabled && loadedSleep.TimeToSleep == 2.0f;
+}
+
+// Equal worlds give byte-identical snapshots, padding included
+bool checkStable() {
+    PhysicsWorld world;
+    buildScene(world);
+    std::vector<std::byte> first(world.getSnapshotSize(), std::byte{0xAA});
+    std::vector<std::byte> second(world.getSnapshotSize(), std::byte{0x55});
+    world.saveSnapshot(first.data(), first.size());
+    world.saveSnapshot(second.data(), second.size());
+    return first == second && world.saveSnapshot(first.data(), first.size() - 1) == 0;
+}
+
+// Damaged or foreign data is refused before anything in the world changes
+bool checkRejects() {
+    PhysicsWorld world;
+    buildScene(world);
+    std::vector<std::byte> buffer(world.getSnapshotSize());
+    world.saveSnapshot(buffer.data(), buffer.size());
+
+    PhysicsWorld target;
+    const RigidbodyHandle body = target.addRigidbody(Vec3(1.0f, 2.0f, 3.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    auto untouched = [&]() {
+        return target.getRigidbodyData().size() == 1 && target.isValid(body) && target.getRigidbodyData().getPositions()[0].Y == 2.0f;
+    };
+
+    if (target.loadSnapshot(buffer.data(), buffer.size() / 2) || !untouched())
+        return false;
+
+    std::vector<std::byte> damaged = buffer;
+    damaged[0] = std::byte{'X'};
+    if (target.loadSnapshot(damaged.data(), damaged.size()) || !untouched())
+        return false;
+
+    damaged = buffer;
+    SnapshotHeader header;
+    std::memcpy(&header, damaged.data(), sizeof(header));
+    header.Version += 1;
+    std::memcpy(damaged.data(), &header, sizeof(header));
+    if (target.loadSnapshot(damaged.data(), damaged.size()) || !untouched())
+        return false;
+
+    // A section pointing past the end
+    damaged = buffer;
+    SnapshotSection section;
+    std::memcpy(&section, damaged.data() + sizeof(SnapshotHeader) + sizeof(SnapshotSection), sizeof(section));
+    section.Count = uint64_t(1) << 40;
+    std::memcpy(damaged.data() + sizeof(SnapshotHeader) + sizeof(SnapshotSection), &section, sizeof(section));
+    if (target.loadSnapshot(damaged.data(), damaged.size()) || !untouched())
+        return false;
+
+    // A zero element size, which must not be divided by
+    damaged = buffer;
+    std::memcpy(&section, damaged.data() + sizeof(SnapshotHeader) + sizeof(SnapshotSection), sizeof(section));
+    section.ElementSize = 0;
+    std::memcpy(damaged.data() + sizeof(SnapshotHeader) + sizeof(SnapshotSection), &section, sizeof(section));
+    if (target.loadSnapshot(damaged.data(), damaged.size()) || !untouched())
+        return false;
+
+    // A flag that is neither 0 nor 1
+    damaged = buffer;
+    std::memcpy(&section, damaged.data() + sizeof(SnapshotHeader), sizeof(section));
+    damaged[section.Offset + offsetof(SnapshotWorldState, SleepEnabled)] = std::byte{2};
+    if (target.loadSnapshot(damaged.data(), damaged.size()) || !untouched())
+        return false;
+
+    // Sections that fit the file but not each other: the header's body count,
+    // a per-body array one short, a manifold naming a body past the end and a
+    // sleeping island that loops back to its head
+    auto sectionAt = [](std::vector<std::byte>& bytes, uint32_t index) {
+        SnapshotSection result;
+        std::memcpy(&result, bytes.data() + sizeof(SnapshotHeader) + index * sizeof(SnapshotSection), sizeof(result));
+        return result;
+    };
+    auto rejected = [&](const std::vector<std::byte>& bytes) { return !target.loadSnapshot(bytes.data(), bytes.size()) && untouched(); };
+
+    damaged = buffer;
+    std::memcpy(&header, damaged.data(), sizeof(header));
+    header.Bodies += 1;
+    std::memcpy(damaged.data(), &header, sizeof(header));
+    if (!rejected(damaged))
+        return false;
+
+    damaged = buffer;
+    section = sectionAt(damaged, 2); // velocities
+    section.Count -= 1;
+    std::memcpy(damaged.data() + sizeof(SnapshotHeader) + 2 * sizeof(SnapshotSection), &section, sizeof(section));
+    if (!rejected(damaged))
+        return false;
+
+    damaged = buffer;
+    section = sectionAt(damaged, header.SectionCount - 2); // manifolds
+    const uint32_t pastEnd = static_cast<uint32_t>(world.getRigidbodyData().size());
+    if (section.Count == 0)
+        return false;
+    std::memcpy(damaged.data() + section.Offset + offsetof(ContactManifold, B), &pastEnd, sizeof(pastEnd));
+    if (!rejected(damaged))
+        return false;
+
+    damaged = buffer;
+    const SnapshotSection islands = sectionAt(damaged, 13), next = sectionAt(damaged, 14);
+    bool looped = false;
+    for (uint64_t i = 0; i < islands.Count && !looped; ++i) {
+        uint32_t island;
+        std::memcpy(&island, damaged.data() + islands.Offset + i * sizeof(uint32_t), sizeof(island));
+        if (island != RigidbodyData::kNoIsland && island != i) {
+            std::memcpy(damaged.data() + next.Offset + i * sizeof(uint32_t), &island, sizeof(island));
+            looped = true;
+        }
+    }
+    if (!looped || !rejected(damaged))
+        return false;
+
+    return !target.loadSnapshot("/tmp/nyx_snapshot_missing.bin") && untouched();
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("round trip buffer", checkRoundTrip(false));
+    report("round trip file", checkRoundTrip(true));
+    report("settings", checkSettings());
+    report("stable bytes", checkStable());
+    report("rejects bad data", checkRejects());
+    std::remove(kSnapshotPath);
+
+    return failures == 0 ? 0 : 1;
+}
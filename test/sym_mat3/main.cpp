@@ -0,0 +1,119 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nyx/core/cpu_features.h"
+#include "nyx/math/sym_mat3.h"
+
+using namespace nyx;
+
+// Not a multiple of 8, so the kernel finishes a tail one at a time
+constexpr size_t kCount = 1027;
+
+// Without NYX_DETERMINISTIC the compiler may fuse the scalar code's
+// multiply-adds and not the kernel's, so they only agree to rounding
+#if defined(NYX_DETERMINISTIC)
+constexpr real_t kTolerance = 0.0f;
+#else
+constexpr real_t kTolerance = 1e-5f;
+#endif
+
+std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels;
+    for (uint8_t i = 0; i <= static_cast<uint8_t>(getSupportedSimdLevel()); ++i)
+        levels.push_back(static_cast<SimdLevel>(i));
+    return levels;
+}
+
+// Inverse inertias and the orientations of the bodies they belong to
+struct Inputs {
+    Inputs() {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (size_t i = 0; i < kCount; ++i) {
+            Orientations.emplace_back(unit(rng), unit(rng), unit(rng), unit(rng));
+            Orientations.back().normalize();
+            // Diagonally dominant, so positive definite like a real tensor
+            Tensors.emplace_back(2.0f + unit(rng), 2.0f + unit(rng), 2.0f + unit(rng), unit(rng) * 0.5f, unit(rng) * 0.5f, unit(rng) * 0.5f);
+        }
+        // A sphere, which integrates with the diagonal alone
+        Tensors[4] = SymMat3(0.4f, 0.4f, 0.4f, 0.0f, 0.0f, 0.0f);
+    }
+
+    std::vector<Quaternion> Orientations;
+    std::vector<SymMat3> Tensors;
+};
+
+bool near(const SymMat3& a, const SymMat3& b, real_t tolerance) {
+    return std::fabs(a.XX - b.XX) <= tolerance && std::fabs(a.YY - b.YY) <= tolerance && std::fabs(a.ZZ - b.ZZ) <= tolerance &&
+           std::fabs(a.XY - b.XY) <= tolerance && std::fabs(a.XZ - b.XZ) <= tolerance && std::fabs(a.YZ - b.YZ) <= tolerance;
+}
+
+bool near(const Vec3& a, const Vec3& b, real_t tolerance) {
+    return std::fabs(a.X - b.X) <= tolerance && std::fabs(a.Y - b.Y) <= tolerance && std::fabs(a.Z - b.Z) <= tolerance;
+}
+
+// The six-cofactor inverse is Mat3::inverse of the full matrix, singular ones included
+bool checkInverse() {
+    const Inputs in;
+    std::vector<SymMat3> tensors = in.Tensors;
+    tensors.push_back(SymMat3(1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f));
+    for (const SymMat3& s : tensors) {
+        const Mat3 full = s.toMat3().inverse();
+        if (!full.isSymmetric() || !near(s.inverse(), SymMat3(full), kTolerance) || !near(s * Vec3(1.0f, 2.0f, 3.0f), s.toMat3() * Vec3(1.0f, 2.0f, 3.0f), kTolerance))
+            return false;
+    }
+    return true;
+}
+
+// R * s * Rᵀ applied to a vector is q * (s * (q⁻¹ * v)), as applyImpulse takes it
+bool checkRotate() {
+    const Inputs in;
+    const Vec3 axes[3] = {Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)};
+    for (size_t i = 0; i < kCount; ++i) {
+        const Quaternion& q = in.Orientations[i];
+        const SymMat3 world = rotateTensor(q, in.Tensors[i]);
+        for (const Vec3& v : axes) {
+            if (!near(world * v, q * (in.Tensors[i] * (q.conjugate() * v)), 1e-5f))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Every level's kernel gives each indexed body what rotateTensor does, packed
+bool checkKernels() {
+    const SimdLevel initial = getSimdLevel();
+    const Inputs in;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < kCount; i += 3)
+        indices.push_back(i);
+
+    bool ok = true;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+        std::vector<SymMat3> world(indices.size());
+        rotateTensors(in.Orientations.data(), in.Tensors.data(), world.data(), indices.data(), indices.size());
+        for (size_t k = 0; k < indices.size(); ++k)
+            ok = ok && near(world[k], rotateTensor(in.Orientations[indices[k]], in.Tensors[indices[k]]), kTolerance);
+        std::cout << "  " << getSimdLevelName(level) << (ok ? " ok" : " differs") << "\n";
+    }
+    setSimdLevel(initial);
+    return ok;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("inverse", checkInverse());
+    report("rotate", checkRotate());
+    report("kernels", checkKernels());
+
+    return failures == 0 ? 0 : 1;
+}
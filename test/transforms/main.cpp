@@ -0,0 +1,172 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "nyx/physics/scene/physics_world.h"
+
+using namespace nyx;
+
+constexpr real_t kDt = 1.0f / 60.0f;
+constexpr real_t kEpsilon = 1e-5f;
+
+bool near(real_t a, real_t b) { return std::fabs(a - b) <= kEpsilon; }
+
+bool samePose(const TransformLanes& lanes, size_t i, const Vec3& p, const Quaternion& q) {
+    return lanes.PositionX[i] == p.X && lanes.PositionY[i] == p.Y && lanes.PositionZ[i] == p.Z &&
+           lanes.OrientationW[i] == q.w && lanes.OrientationX[i] == q.x && lanes.OrientationY[i] == q.y && lanes.OrientationZ[i] == q.z;
+}
+
+// Bodies falling and spinning freely, no shapes
+std::vector<RigidbodyHandle> buildScene(PhysicsWorld& world, size_t count) {
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    std::vector<RigidbodyHandle> bodies;
+    for (size_t i = 0; i < count; ++i) {
+        bodies.push_back(world.addRigidbody(Vec3(static_cast<real_t>(i), 10.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f), 1.0f, Mat3()));
+        world.accessRigidbodyData().accessAngularVelocities()[i] = Vec3(0.0f, 1.0f + 0.1f * static_cast<real_t>(i), 0.0f);
+    }
+    return bodies;
+}
+
+// Each frame holds the poses after its update and after the one before, by
+// handle, also across a removal that moves a body to another index
+bool checkPublish() {
+    PhysicsWorld world;
+    std::vector<RigidbodyHandle> bodies = buildScene(world, 37);
+    world.update(kDt);
+    if (world.acquireTransforms().size() != 0)
+        return false;
+
+    world.setTransformPublishing(true);
+    world.update(kDt);
+    const TransformFrame& first = world.acquireTransforms();
+    const RigidbodyData& data = world.getRigidbodyData();
+    if (first.size() != data.size() || first.Frame != world.getStats().Frame || first.Dt != kDt)
+        return false;
+    for (size_t i = 0; i < data.size(); ++i) {
+        // Nothing to interpolate from yet
+        if (!samePose(first.Current, i, data.getPositions()[i], data.getOrientations()[i]) ||
+            !samePose(first.Previous, i, data.getPositions()[i], data.getOrientations()[i]) || first.Handles[i] != data.getHandle(i))
+            return false;
+    }
+
+    std::vector<Vec3> positions(data.getPositions().begin(), data.getPositions().end());
+    std::vector<Quaternion> orientations(data.getOrientations().begin(), data.getOrientations().end());
+    const RigidbodyHandle moved = bodies.back();
+    world.removeRigidbody(bodies[3]);
+    const RigidbodyHandle added = world.addRigidbody(Vec3(0.0f, 20.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    world.update(kDt);
+
+    const TransformFrame& second = world.acquireTransforms();
+    if (second.size() != data.size() || second.Frame != world.getStats().Frame)
+        return false;
+    for (size_t i = 0; i < data.size(); ++i) {
+        const RigidbodyHandle handle = data.getHandle(i);
+        if (second.Handles[i] != handle || !samePose(second.Current, i, data.getPositions()[i], data.getOrientations()[i]))
+            return false;
+        if (handle == added) {
+            if (!samePose(second.Previous, i, data.getPositions()[i], data.getOrientations()[i]))
+                return false;
+            continue;
+        }
+        const size_t before = handle == moved ? bodies.size() - 1 : i;
+        if (!samePose(second.Previous, i, positions[before], orientations[before]))
+            return false;
+    }
+    return world.getIndex(moved) == 3 && second.Current.PositionY[3] < second.Previous.PositionY[3];
+}
+
+// Alpha 0 and 1 give the two poses, in between stays on the shorter arc and unit length
+bool checkInterpolate() {
+    TransformFrame frame;
+    frame.Previous.resize(3);
+    frame.Current.resize(3);
+    const Quaternion a(1.0f, 0.0f, 0.0f, 0.0f);
+    const Quaternion b(std::cos(0.5f), 0.0f, std::sin(0.5f), 0.0f); // 1 radian about Y
+    for (size_t i = 0; i < 3; ++i) {
+        frame.Previous.PositionX[i] = 1.0f; frame.Previous.PositionY[i] = 2.0f; frame.Previous.PositionZ[i] = 3.0f;
+        frame.Current.PositionX[i] = 3.0f; frame.Current.PositionY[i] = 2.0f; frame.Current.PositionZ[i] = -1.0f;
+        frame.Previous.OrientationW[i] = a.w; frame.Previous.OrientationX[i] = a.x; frame.Previous.OrientationY[i] = a.y; frame.Previous.OrientationZ[i] = a.z;
+        frame.Current.OrientationW[i] = b.w; frame.Current.OrientationX[i] = b.x; frame.Current.OrientationY[i] = b.y; frame.Current.OrientationZ[i] = b.z;
+    }
+    // The same rotation as a, but on the far side
+    frame.Previous.OrientationW[2] = -1.0f;
+
+    TransformLanes out;
+    interpolateTransforms(frame, 0.0f, out);
+    if (out.size() != 3 || !near(out.PositionX[0], 1.0f) || !near(out.PositionZ[1], 3.0f) || !near(out.OrientationW[0], 1.0f))
+        return false;
+    interpolateTransforms(frame, 1.0f, out);
+    if (!near(out.PositionX[0], 3.0f) || !near(out.PositionZ[1], -1.0f) || !near(out.OrientationY[0], b.y))
+        return false;
+
+    interpolateTransforms(frame, 0.5f, out);
+    for (size_t i = 0; i < 3; ++i) {
+        const real_t len = std::sqrt(out.OrientationW[i] * out.OrientationW[i] + out.OrientationX[i] * out.OrientationX[i] +
+                                     out.OrientationY[i] * out.OrientationY[i] + out.OrientationZ[i] * out.OrientationZ[i]);
+        // Halfway along the arc by symmetry: half a radian about Y
+        if (!near(out.PositionX[i], 2.0f) || !near(out.PositionZ[i], 1.0f) || !near(len, 1.0f) ||
+            !near(out.OrientationW[i], std::cos(0.25f)) || !near(out.OrientationY[i], std::sin(0.25f)))
+            return false;
+    }
+    return true;
+}
+
+// A reader polling from another thread sees whole frames, in order, while the
+// world keeps stepping: all bodies fall alike, so a torn frame shows up as lanes
+// from different updates
+bool checkConcurrentReader() {
+    PhysicsWorld world(JobSystemSettings{.WorkerCount = 2});
+    world.setGravity(Vec3(0.0f, -9.81f, 0.0f));
+    for (int i = 0; i < 4000; ++i)
+        world.addRigidbody(Vec3(static_cast<real_t>(i % 64), 100.0f, static_cast<real_t>(i / 64)), Vec3(0.0f, 0.0f, 0.0f), 1.0f, Mat3());
+    world.setTransformPublishing(true);
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> ok{true};
+    std::atomic<uint32_t> frames{0};
+    std::thread reader([&]() {
+        uint64_t last = 0;
+        TransformLanes out;
+        while (!done.load(std::memory_order_acquire)) {
+            const TransformFrame& frame = world.acquireTransforms();
+            if (frame.size() == 0 || frame.Frame == last)
+                continue;
+            if (frame.Frame < last)
+                ok = false;
+            last = frame.Frame;
+            ++frames;
+            const real_t previous = frame.Previous.PositionY[0];
+            const real_t current = frame.Current.PositionY[0];
+            for (size_t i = 0; i < frame.size(); ++i) {
+                if (frame.Previous.PositionY[i] != previous || frame.Current.PositionY[i] != current)
+                    ok = false;
+            }
+            interpolateTransforms(frame, 0.5f, out);
+            if (out.PositionY[frame.size() - 1] > previous || out.PositionY[frame.size() - 1] < current)
+                ok = false;
+        }
+    });
+
+    for (int step = 0; step < 300; ++step)
+        world.update(kDt);
+    done.store(true, std::memory_order_release);
+    reader.join();
+    return ok && frames > 0;
+}
+
+int main() {
+    int failures = 0;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << (ok ? "PASS " : "FAIL ") << name << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    report("publish", checkPublish());
+    report("interpolate", checkInterpolate());
+    report("concurrent reader", checkConcurrentReader());
+
+    return failures == 0 ? 0 : 1;
+}